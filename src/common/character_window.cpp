@@ -39,10 +39,15 @@ CharacterWindow::CharacterWindow():
                                    vt_global::GLOBAL_INTENSITY_NEUTRAL);
     _sp_icon = media.GetStatusIcon(vt_global::GLOBAL_STATUS_SP,
                                    vt_global::GLOBAL_INTENSITY_NEUTRAL);
+
+    // The contents only change with the character.
+    EnableRetainedDrawing(true);
 }
 
 void CharacterWindow::SetCharacter(vt_global::GlobalCharacter* character)
 {
+    MarkDirty();
+
     if(!character || character->GetID() == vt_global::GLOBAL_CHARACTER_INVALID) {
         _character_name.Clear();
         _character_data.Clear();
@@ -83,11 +88,8 @@ void CharacterWindow::SetCharacter(vt_global::GlobalCharacter* character)
     _UpdateActiveStatusEffects(character);
 }
 
-void CharacterWindow::Draw()
+void CharacterWindow::_DrawContents()
 {
-    // Call parent Draw method, if failed pass on fail result
-    MenuWindow::Draw();
-
     VideoManager->SetDrawFlags(VIDEO_X_LEFT, VIDEO_Y_TOP, 0);
 
     // Get the window metrics
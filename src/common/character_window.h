@@ -37,11 +37,6 @@ public:
     **/
     void SetCharacter(vt_global::GlobalCharacter* character);
 
-    /** \brief render this window to the screen
-    *** \return success/failure
-    **/
-    void Draw();
-
 private:
     //! \brief The name of the character that this window corresponds) to
     uint32_t _char_id;
@@ -70,6 +65,9 @@ private:
     *** \param character the character to check status effects for.
     **/
     void _UpdateActiveStatusEffects(vt_global::GlobalCharacter* character);
+
+    //! \brief Draws the character portrait and data.
+    void _DrawContents() override;
 };
 
 } // namespace vt_common
@@ -22,6 +22,7 @@
 #include "common.h"
 #include "common/gui/gui.h"
 
+#include "engine/audio/audio.h"
 #include "engine/video/video.h"
 #include "engine/input.h"
 #include "engine/mode_manager.h"
@@ -323,6 +324,9 @@ DialogueSupervisor::DialogueSupervisor() :
 
 DialogueSupervisor::~DialogueSupervisor()
 {
+    if(_current_dialogue != nullptr)
+        vt_audio::AudioManager->UnduckMusic();
+
     // Delete all dialogues
     for(std::map<std::string, Dialogue *>::iterator it = _dialogues.begin(); it != _dialogues.end(); ++it) {
         delete it->second;
@@ -448,6 +452,9 @@ void DialogueSupervisor::StartDialogue(const std::string& dialogue_id)
         PRINT_WARNING << "beginning a new dialogue while another dialogue is still active" << std::endl;
     }
 
+    // Lower the music while the dialogue is read.
+    vt_audio::AudioManager->DuckMusic();
+
     _line_counter = 0;
     _current_dialogue = dialogue;
     _current_options = _current_dialogue->GetLineOptions(_line_counter);
@@ -465,6 +472,8 @@ void DialogueSupervisor::EndDialogue()
     _current_dialogue = nullptr;
     _current_options = nullptr;
     _line_timer.Finish();
+
+    vt_audio::AudioManager->UnduckMusic();
 }
 
 void DialogueSupervisor::ForceNextLine()
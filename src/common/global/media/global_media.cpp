@@ -242,6 +242,7 @@ void GlobalMedia::_LoadSoundFile(const std::string& sound_name, const std::strin
         return;
 
     _sounds[sound_name] = new vt_audio::SoundDescriptor();
+    _sounds[sound_name]->SetPriority(vt_audio::AUDIO_PRIORITY_UI);
     if(!_sounds[sound_name]->LoadAudio(filename))
         PRINT_WARNING << "Failed to load '" << filename << "' needed by shop mode" << std::endl;
 }
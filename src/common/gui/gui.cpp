@@ -169,6 +169,12 @@ void GUIControl::CalculateAlignedRect(float &left, float &right, float &bottom,
     }
 }
 
+void GUIControl::_MarkOwnerDirty()
+{
+    if(_owner)
+        _owner->MarkDirty();
+}
+
 void GUIControl::_DEBUG_DrawOutline()
 {
     float left = 0.0f;
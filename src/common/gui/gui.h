@@ -232,6 +232,9 @@ protected:
     **/
     MenuWindow *_owner;
 
+    //! \brief Tells the owner window the control appearance changed, for its retained drawing.
+    void _MarkOwnerDirty();
+
     /** \brief Draws an outline of the control boundaries
     *** \note This implementation uses the
     ***
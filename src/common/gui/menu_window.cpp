@@ -18,9 +18,12 @@
 #include "menu_window.h"
 
 #include "engine/video/video.h"
+#include "engine/video/gl/gl_render_target.h"
 
 #include "utils/utils_common.h"
 
+#include <algorithm>
+
 using namespace vt_utils;
 using namespace vt_video;
 using namespace vt_video::private_video;
@@ -30,11 +33,27 @@ namespace vt_gui
 {
 
 MenuWindow::MenuWindow() :
-    _window_state(VIDEO_MENU_STATE_HIDDEN)
+    _window_state(VIDEO_MENU_STATE_HIDDEN),
+    _retained_drawing(false),
+    _retained_target(nullptr),
+    _retained_dirty(true),
+    _retained_left(0.0f),
+    _retained_right(0.0f),
+    _retained_bottom(0.0f),
+    _retained_top(0.0f)
 {
     _skin = GUIManager->_GetDefaultMenuSkin();
 }
 
+MenuWindow::~MenuWindow()
+{
+    // Free the memory in case its needed.
+    if (_skin)
+        Destroy();
+
+    delete _retained_target;
+}
+
 
 
 bool MenuWindow::Create(const std::string &skin_name, float w, float h, int32_t visible_flags, int32_t shared_flags)
@@ -85,6 +104,10 @@ void MenuWindow::Destroy()
 {
     _skin = nullptr;
     GUIManager->_RemoveMenuWindow(this);
+
+    delete _retained_target;
+    _retained_target = nullptr;
+    _retained_dirty = true;
 }
 
 void MenuWindow::Draw(const Color& color)
@@ -92,20 +115,82 @@ void MenuWindow::Draw(const Color& color)
     if(_window_state == VIDEO_MENU_STATE_HIDDEN)
         return;
 
+    if(!_retained_drawing) {
+        _DrawWindow(color);
+        return;
+    }
+
+    // The target is resized to the window dimensions when rendered.
+    if(_retained_target == nullptr) {
+        _retained_target = new gl::RenderTarget(1, 1);
+        _retained_dirty = true;
+    }
+
     VideoManager->PushState();
     VideoManager->SetDrawFlags(_xalign, _yalign, VIDEO_BLEND, 0);
 
-    VideoManager->Move(_position.x, _position.y);
-    _menu_image.Draw(color);
+    // The rectangle covered by the window image, which may be larger than the requested dimensions.
+    float left = 0.0f;
+    float right = std::max(_width, _menu_image.GetWidth());
+    float bottom = 0.0f;
+    float top = std::max(_height, _menu_image.GetHeight());
+    VideoManager->Move(0.0f, 0.0f);
+    CalculateAlignedRect(left, right, bottom, top);
+
+    // Render the window again when it changed or moved.
+    if(_retained_dirty || left != _retained_left || right != _retained_right ||
+            bottom != _retained_bottom || top != _retained_top) {
+        VideoManager->BeginRenderTargetCapture(_retained_target, left, right, bottom, top);
+        _DrawWindow(Color::white);
+        VideoManager->EndRenderTargetCapture();
+
+        _retained_dirty = false;
+        _retained_left = left;
+        _retained_right = right;
+        _retained_bottom = bottom;
+        _retained_top = top;
+    }
+
+    VideoManager->DrawRenderTarget(_retained_target, left, right, bottom, top, color);
 
     if(GUIManager->DEBUG_DrawOutlines()) {
         _DEBUG_DrawOutline();
     }
 
     VideoManager->PopState();
-    return;
 } // void MenuWindow::Draw()
 
+void MenuWindow::EnableRetainedDrawing(bool enable)
+{
+    _retained_drawing = enable;
+    _retained_dirty = true;
+
+    if(!enable) {
+        delete _retained_target;
+        _retained_target = nullptr;
+    }
+}
+
+void MenuWindow::_DrawWindow(const Color& color)
+{
+    VideoManager->PushState();
+    VideoManager->SetDrawFlags(_xalign, _yalign, VIDEO_BLEND, 0);
+
+    VideoManager->Move(_position.x, _position.y);
+    _menu_image.Draw(color);
+
+    // The outline is drawn over the retained texture instead.
+    if(GUIManager->DEBUG_DrawOutlines() && !_retained_drawing) {
+        _DEBUG_DrawOutline();
+    }
+
+    VideoManager->PopState();
+
+    VideoManager->PushState();
+    _DrawContents();
+    VideoManager->PopState();
+}
+
 void MenuWindow::SetDimensions(float w, float h)
 {
     if(w <= 0.0f) {
@@ -145,6 +230,7 @@ bool MenuWindow::_RecreateImage()
     }
 
     _menu_image.Clear();
+    _retained_dirty = true;
 
     // Get information about the border sizes
     float left_border_size   = _skin->borders[1][0].GetWidth();
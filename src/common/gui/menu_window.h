@@ -22,6 +22,14 @@
 #include "engine/video/screen_rect.h"
 #include "engine/video/image.h"
 
+namespace vt_video
+{
+namespace gl
+{
+class RenderTarget;
+}
+}
+
 namespace vt_gui
 {
 
@@ -131,6 +139,10 @@ public:
 *** the display of dialogue text, inventory lists, etc. This class is designed
 *** with that practice in mind.
 ***
+*** Windows whose contents rarely change can draw them in _DrawContents() and
+*** enable the retained drawing: the window and its contents are then rendered
+*** once into a texture, drawn as a single quad until MarkDirty() is called.
+***
 *** \todo Determine function/behavior of copy constructor and copy assignment
 *** operator. Should these be set to private, or implemented? How should the
 *** texture be copied if it is implemented?
@@ -141,11 +153,7 @@ class MenuWindow : public private_gui::GUIElement
 public:
     MenuWindow();
 
-    ~MenuWindow() {
-        // Free the memory in case its needed.
-        if (_skin)
-            Destroy();
-    }
+    ~MenuWindow();
 
     /** \brief Sets the width and height of the menu.
     *** \param skin_name The name of the menu skin with which to construct this menu window.
@@ -181,9 +189,22 @@ public:
         Draw(vt_video::Color::white);
     }
 
-    //! \brief Draws the menu window to the screen with a specified color and opacity
+    /** \brief Draws the menu window to the screen with a specified color and opacity
+    *** \note When the retained drawing is enabled, the color applies to the contents as well.
+    **/
     void Draw(const vt_video::Color& color);
 
+    /** \brief Enables or disables drawing the window and its contents from a texture.
+    *** The controls owned by the window mark the texture dirty when they change,
+    *** other contents drawn in _DrawContents() must call MarkDirty() themselves.
+    **/
+    void EnableRetainedDrawing(bool enable);
+
+    //! \brief Tells the contents changed, and the retained texture must be rendered again.
+    void MarkDirty() {
+        _retained_dirty = true;
+    }
+
     //! \brief Makes the current window visible
     void Show() {
         _window_state = VIDEO_MENU_STATE_SHOWN;
@@ -231,6 +252,14 @@ public:
     void SetMenuSkin(const std::string &skin_name);
     //@}
 
+protected:
+    /** \brief Draws the window contents on top of its background.
+    *** Only called by Draw(), with the draw cursor state restored afterwards.
+    *** Contents drawn out of the window rectangle are cut when using the retained drawing.
+    **/
+    virtual void _DrawContents()
+    {}
+
 private:
     //! \brief The dimensions of the space inside the window borders.
     float _inner_width, _inner_height;
@@ -250,6 +279,21 @@ private:
     //! \brief The image that creates the window
     vt_video::CompositeImage _menu_image;
 
+    //! \brief Whether the window is drawn from the retained texture.
+    bool _retained_drawing;
+
+    //! \brief The texture holding the rendered window, created on first use.
+    vt_video::gl::RenderTarget* _retained_target;
+
+    //! \brief Whether the retained texture must be rendered again before being drawn.
+    bool _retained_dirty;
+
+    //! \brief The window rectangle the retained texture was rendered at.
+    float _retained_left, _retained_right, _retained_bottom, _retained_top;
+
+    //! \brief Draws the window background and its contents.
+    void _DrawWindow(const vt_video::Color& color);
+
     /** \brief Used to create the menu window's image when the visible properties of the window change.
     *** \return True if the menu image was successfully created, false otherwise.
     ***
@@ -23,6 +23,7 @@
 #include "utils/utils_common.h"
 #include "utils/utils_strings.h"
 
+#include <algorithm>
 #include <cassert>
 #include <limits>
 
@@ -34,6 +35,9 @@ using namespace vt_gui::private_gui;
 namespace vt_gui
 {
 
+//! \brief The number of rows above and below the visible ones whose text is rendered in advance.
+const uint32_t OPTION_PREFETCH_ROWS = 2;
+
 ////////////////////////////////////////////////////////////////////////////////
 // Option class methods
 ////////////////////////////////////////////////////////////////////////////////
@@ -55,6 +59,7 @@ Option::~Option()
 Option::Option(const Option &copy) :
     disabled(copy.disabled),
     elements(copy.elements),
+    text_strings(copy.text_strings),
     text(copy.text)
 {
     if(copy.image == nullptr) {
@@ -75,6 +80,7 @@ Option &Option::operator=(const Option &copy)
 
     disabled = copy.disabled;
     elements = copy.elements;
+    text_strings = copy.text_strings;
     text = copy.text;
     if(copy.image == nullptr) {
         image = nullptr;
@@ -91,6 +97,7 @@ void Option::Clear()
 {
     disabled = false;
     elements.clear();
+    text_strings.clear();
     text.clear();
     if(image != nullptr) {
         delete image;
@@ -117,6 +124,8 @@ OptionBox::OptionBox() :
     _enable_switching(false),
     _draw_left_column(0),
     _draw_top_row(0),
+    _rendered_begin(0),
+    _rendered_end(0),
     _cursor_offset(0.0f, 0.0f),
     _scroll_offset(0.0f),
     _option_xalign(VIDEO_X_LEFT),
@@ -152,6 +161,7 @@ void OptionBox::Update(uint32_t frame_time)
         return;
     }
 
+    _MarkOwnerDirty();
     _scroll_time += frame_time;
 
     // Clamp the scroll time to prevent over animation.
@@ -276,6 +286,8 @@ void OptionBox::Draw()
     bounds.y_center = bounds.y_top - (0.5f * _cell_height * cs.GetVerticalDirection());
     bounds.y_bottom = (bounds.y_center * 2.0f) - bounds.y_top;
 
+    _UpdateRenderedOptions();
+
     // ---------- (3) Iterate through all the visible option cells and draw them and the draw cursor
     for(uint32_t row = _draw_top_row; row < _draw_top_row + _number_cell_rows && finished == false; row++) {
 
@@ -369,6 +381,7 @@ void OptionBox::Draw()
 
 void OptionBox::SetDimensions(float width, float height, uint8_t num_cols, uint8_t num_rows, uint8_t cell_cols, uint8_t cell_rows)
 {
+    _MarkOwnerDirty();
     if(num_rows == 0 || num_cols == 0) {
         IF_PRINT_WARNING(VIDEO_DEBUG) << "num_rows/num_cols argument was zero" << std::endl;
         return;
@@ -396,6 +409,7 @@ void OptionBox::SetDimensions(float width, float height, uint8_t num_cols, uint8
 
 void OptionBox::SetOptions(const std::vector<ustring>& option_text)
 {
+    _MarkOwnerDirty();
     ClearOptions();
     for(std::vector<ustring>::const_iterator i = option_text.begin(); i != option_text.end(); ++i) {
         const ustring &str = *i;
@@ -414,17 +428,22 @@ void OptionBox::SetOptions(const std::vector<ustring>& option_text)
 
 void OptionBox::ClearOptions()
 {
+    _MarkOwnerDirty();
     _options.clear();
+    _rendered_begin = 0;
+    _rendered_end = 0;
 }
 
 void OptionBox::ResetViewableOption()
 {
+    _MarkOwnerDirty();
     _draw_top_row = 0;
     _draw_left_column = 0;
 }
 
 void OptionBox::AddOption()
 {
+    _MarkOwnerDirty();
     Option option;
     if(_ConstructOption(ustring(), option) == false) {
         IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to construct option using an empty string"  << std::endl;
@@ -438,6 +457,7 @@ void OptionBox::AddOption()
 
 void OptionBox::AddOption(const vt_utils::ustring &text)
 {
+    _MarkOwnerDirty();
     Option option;
     if(_ConstructOption(text, option) == false) {
         IF_PRINT_WARNING(VIDEO_DEBUG) << "argument contained an invalid formatted string: " << MakeStandardString(text) << std::endl;
@@ -451,6 +471,7 @@ void OptionBox::AddOption(const vt_utils::ustring &text)
 
 void OptionBox::AddOptionElementText(uint32_t option_index, const ustring &text)
 {
+    _MarkOwnerDirty();
     if(option_index >= GetNumberOptions()) {
         IF_PRINT_WARNING(VIDEO_DEBUG) << "out-of-range option_index argument: " << option_index << std::endl;
         return;
@@ -460,10 +481,12 @@ void OptionBox::AddOptionElementText(uint32_t option_index, const ustring &text)
     OptionElement new_element;
 
     new_element.type = VIDEO_OPTION_ELEMENT_TEXT;
-    new_element.value = static_cast<int32_t>(this_option.text.size());
+    new_element.value = static_cast<int32_t>(this_option.text_strings.size());
 
-    TextImage text_image(text, _text_style);
-    this_option.text.push_back(text_image);
+    // Rendered images are kept in sync with the strings.
+    if(this_option.IsTextRendered())
+        this_option.text.push_back(TextImage(text, _text_style));
+    this_option.text_strings.push_back(text);
     this_option.elements.push_back(new_element);
 }
 
@@ -471,6 +494,7 @@ void OptionBox::AddOptionElementText(uint32_t option_index, const ustring &text)
 
 void OptionBox::AddOptionElementImage(uint32_t option_index, const std::string &image_filename)
 {
+    _MarkOwnerDirty();
     if(option_index >= GetNumberOptions()) {
         IF_PRINT_WARNING(VIDEO_DEBUG) << "out-of-range option_index argument: " << option_index << std::endl;
         return;
@@ -497,6 +521,7 @@ void OptionBox::AddOptionElementImage(uint32_t option_index, const std::string &
 
 void OptionBox::AddOptionElementImage(uint32_t option_index, const StillImage* image)
 {
+    _MarkOwnerDirty();
     if(option_index >= GetNumberOptions()) {
         PRINT_WARNING << "out-of-range option_index argument: " << option_index << std::endl;
         return;
@@ -520,6 +545,7 @@ void OptionBox::AddOptionElementImage(uint32_t option_index, const StillImage* i
 
 void OptionBox::AddOptionElementAlignment(uint32_t option_index, OptionElementType position_type)
 {
+    _MarkOwnerDirty();
     if(option_index >= GetNumberOptions()) {
         IF_PRINT_WARNING(VIDEO_DEBUG) << "out-of-range option_index argument: " << option_index << std::endl;
         return;
@@ -542,6 +568,7 @@ void OptionBox::AddOptionElementAlignment(uint32_t option_index, OptionElementTy
 
 void OptionBox::AddOptionElementPosition(uint32_t option_index, uint32_t position_length)
 {
+    _MarkOwnerDirty();
     if(option_index >= GetNumberOptions()) {
         IF_PRINT_WARNING(VIDEO_DEBUG) << "out-of-range option_index argument: " << option_index << std::endl;
         return;
@@ -559,6 +586,7 @@ void OptionBox::AddOptionElementPosition(uint32_t option_index, uint32_t positio
 
 bool OptionBox::SetOptionText(uint32_t index, const vt_utils::ustring &text)
 {
+    _MarkOwnerDirty();
     if(index >= GetNumberOptions()) {
         IF_PRINT_WARNING(VIDEO_DEBUG) << "argument was invalid (out of bounds): " << index << std::endl;
         return false;
@@ -572,6 +600,7 @@ bool OptionBox::SetOptionText(uint32_t index, const vt_utils::ustring &text)
 
 void OptionBox::SetSelection(uint32_t index)
 {
+    _MarkOwnerDirty();
     if(index >= GetNumberOptions()) {
         IF_PRINT_WARNING(VIDEO_DEBUG) << "argument was invalid (out of bounds): " << index << std::endl;
         return;
@@ -598,6 +627,7 @@ void OptionBox::SetSelection(uint32_t index)
 
 void OptionBox::EnableOption(uint32_t index, bool enable)
 {
+    _MarkOwnerDirty();
     if(index >= GetNumberOptions()) {
         IF_PRINT_WARNING(VIDEO_DEBUG) << "argument index was invalid: " << index << std::endl;
         return;
@@ -635,6 +665,7 @@ StillImage *OptionBox::GetEmbeddedImage(uint32_t index) const
 
 void OptionBox::InputConfirm()
 {
+    _MarkOwnerDirty();
     // Abort if an invalid option is selected
     if(_selection < 0 || _selection >= static_cast<int32_t>(GetNumberOptions())) {
         IF_PRINT_WARNING(VIDEO_DEBUG) << "an invalid (out of bounds) option was selected: " << _selection << std::endl;
@@ -672,6 +703,7 @@ void OptionBox::InputConfirm()
 
 void OptionBox::InputCancel()
 {
+    _MarkOwnerDirty();
     // Ignore input while scrolling, or if an event has already been logged
     if(_scrolling || _event)
         return;
@@ -685,6 +717,7 @@ void OptionBox::InputCancel()
 
 void OptionBox::InputUp()
 {
+    _MarkOwnerDirty();
     // Ignore input while scrolling, or if an event has already been logged
     if (_scrolling || _event)
         return;
@@ -717,6 +750,7 @@ void OptionBox::InputUp()
 
 void OptionBox::InputDown()
 {
+    _MarkOwnerDirty();
     // Ignore input while scrolling, or if an event has already been logged
     if (_scrolling || _event)
         return;
@@ -749,6 +783,7 @@ void OptionBox::InputDown()
 
 void OptionBox::InputLeft()
 {
+    _MarkOwnerDirty();
     // Ignore input while scrolling, or if an event has already been logged
     if (_scrolling || _event)
         return;
@@ -781,6 +816,7 @@ void OptionBox::InputLeft()
 
 void OptionBox::InputRight()
 {
+    _MarkOwnerDirty();
     // Ignore input while scrolling, or if an event has already been logged
     if (_scrolling || _event)
         return;
@@ -817,6 +853,7 @@ void OptionBox::InputRight()
 
 void OptionBox::SetTextStyle(const TextStyle &style)
 {
+    _MarkOwnerDirty();
     if(style.GetFontProperties() == nullptr) {
         IF_PRINT_WARNING(VIDEO_DEBUG) << "text style references an invalid font name: " << style.GetFontName() << std::endl;
         return;
@@ -836,6 +873,7 @@ void OptionBox::SetTextStyle(const TextStyle &style)
 
 void OptionBox::SetCursorState(CursorState state)
 {
+    _MarkOwnerDirty();
     if(state <= VIDEO_CURSOR_STATE_INVALID || state >= VIDEO_CURSOR_STATE_TOTAL) {
         IF_PRINT_WARNING(VIDEO_DEBUG) << "invalid function argument : " << state << std::endl;
         return;
@@ -848,6 +886,7 @@ void OptionBox::SetCursorState(CursorState state)
 
 void OptionBox::SetHorizontalArrowsPosition(HORIZONTAL_ARROWS_POSITION position)
 {
+    _MarkOwnerDirty();
     _horizontal_arrows_position = position;
 }
 
@@ -855,6 +894,7 @@ void OptionBox::SetHorizontalArrowsPosition(HORIZONTAL_ARROWS_POSITION position)
 
 void OptionBox::SetVerticalArrowsPosition(VERTICAL_ARROWS_POSITION position)
 {
+    _MarkOwnerDirty();
     _vertical_arrows_position = position;
 }
 
@@ -939,18 +979,17 @@ bool OptionBox::_ConstructOption(const ustring &format_string, Option &op)
 
         else { // If this isn't a tag, then it is raw text that should be added to the option
             new_element.type = VIDEO_OPTION_ELEMENT_TEXT;
-            new_element.value = static_cast<int32_t>(op.text.size());
+            new_element.value = static_cast<int32_t>(op.text_strings.size());
 
+            // The text images are rendered later, only when the option becomes visible.
             // find the distance until the next tag
             size_t tag_begin = tmp.find(OPEN_TAG);
 
             if(tag_begin == ustring::npos) {  // There are no more tags remaining, so extract the entire string
-                TextImage text_image(tmp, _text_style);
-                op.text.push_back(text_image);
+                op.text_strings.push_back(tmp);
                 tmp.clear();
             } else { // Another tag remains to be processed, so extract the text substring
-                TextImage text_image(tmp.substr(0, tag_begin), _text_style);
-                op.text.push_back(text_image);
+                op.text_strings.push_back(tmp.substr(0, tag_begin));
                 tmp = tmp.substr(tag_begin, tmp.length() - tag_begin);
             }
         }
@@ -963,6 +1002,42 @@ bool OptionBox::_ConstructOption(const ustring &format_string, Option &op)
 
 
 
+void OptionBox::_UpdateRenderedOptions()
+{
+    const uint32_t number_options = GetNumberOptions();
+    const uint32_t columns = static_cast<uint32_t>(_number_cell_columns);
+
+    // The range of options drawn by Draw(), extended by a few rows on each side.
+    uint32_t first_row = (_draw_top_row > OPTION_PREFETCH_ROWS) ? _draw_top_row - OPTION_PREFETCH_ROWS : 0;
+    uint32_t last_row = _draw_top_row + _number_cell_rows + OPTION_PREFETCH_ROWS;
+    uint32_t begin = std::min(first_row * columns + _draw_left_column, number_options);
+    uint32_t end = std::min(last_row * columns + _draw_left_column, number_options);
+
+    // Free the text images of the options that scrolled out of range.
+    if(begin != _rendered_begin || end != _rendered_end) {
+        for(uint32_t i = 0; i < number_options; ++i) {
+            if(i < begin || i >= end)
+                _options[i].text.clear();
+        }
+        _rendered_begin = begin;
+        _rendered_end = end;
+    }
+
+    // Render the options entering the range, or whose text changed.
+    for(uint32_t i = begin; i < end; ++i) {
+        Option& option = _options[i];
+        if(option.IsTextRendered())
+            continue;
+
+        option.text.clear();
+        option.text.reserve(option.text_strings.size());
+        for(uint32_t j = 0; j < option.text_strings.size(); ++j)
+            option.text.push_back(TextImage(option.text_strings[j], _text_style));
+    }
+}
+
+
+
 bool OptionBox::_ChangeSelection(int32_t offset, bool horizontal)
 {
     // Do nothing if the movement is horizontal and there is only one column with no horizontal wrap shifting
@@ -1283,6 +1358,7 @@ void OptionBox::_DrawOption(const Option &op, const OptionCellBounds &bounds, fl
         case VIDEO_OPTION_ELEMENT_TEXT: {
             int32_t text_index = op.elements[element].value;
 
+            // Unrendered options can't be drawn. This happens when Draw() wasn't called on the box.
             if(text_index >= 0 && text_index < static_cast<int32_t>(op.text.size())) {
                 float width = op.text[text_index].GetWidth();
                 float edge = x - bounds.x_left; // edge value for VIDEO_X_LEFT
@@ -190,8 +190,8 @@ public:
 *** an icon of a knife, the text "Mythril Knife", a right alignment flag, and
 *** finally the text "500 drunes".
 ***
-*** \todo Text should contain rendered text images instead of text that needs
-*** to be rendered and drawn every frame
+*** The text pieces are only rendered while the option is visible, or about to
+*** be, so that boxes with a large number of options stay cheap to fill.
 *** ***************************************************************************/
 class Option
 {
@@ -213,9 +213,19 @@ public:
     //! \brief The elements that this option is composed of
     std::vector<OptionElement> elements;
 
-    //! \brief Contains all pieces of text for this option (as pre-rendered images)
+    //! \brief Contains all pieces of text for this option
+    std::vector<vt_utils::ustring> text_strings;
+
+    /** \brief The rendered images of the text pieces.
+    *** Empty while the option is not rendered, or filled with one image per text piece.
+    **/
     std::vector<vt_video::TextImage> text;
 
+    //! \brief Tells whether the text images are ready to be drawn.
+    bool IsTextRendered() const {
+        return text.size() == text_strings.size();
+    }
+
     //! \brief Contains all images used for this option
     vt_video::StillImage *image;
 }; // class Option
@@ -390,6 +400,7 @@ public:
     void SetOptionAlignment(int32_t xalign, int32_t yalign) {
         _option_xalign = xalign;
         _option_yalign = yalign;
+        _MarkOwnerDirty();
     }
 
     /** \brief Sets the option selection mode (single or double confirm)
@@ -435,6 +446,7 @@ public:
     void SetCursorOffset(float x, float y) {
         _cursor_offset.x = x;
         _cursor_offset.y = y;
+        _MarkOwnerDirty();
     }
 
     /** \brief Sets the text style to use for this option box.
@@ -540,6 +552,9 @@ private:
     //! \brief The column of row of data that is drawn in the top-left cell
     uint32_t _draw_left_column, _draw_top_row;
 
+    //! \brief The range of options whose text was last rendered, the end being excluded.
+    uint32_t _rendered_begin, _rendered_end;
+
     //! \brief Retains the x and y offsets for where the cursor should be drawn relative to the selected option
     vt_common::Position2D _cursor_offset;
 
@@ -609,6 +624,11 @@ private:
     **/
     bool _ConstructOption(const vt_utils::ustring &format_string, private_gui::Option &option);
 
+    /** \brief Renders the text of the visible options and a few rows around them,
+    *** and frees the text images of the options out of that range.
+    **/
+    void _UpdateRenderedOptions();
+
     /** \brief Changes the selected option by making a movement relative to the current selection
     *** \param offset The amount to move in specified direction (ie 1 row up, 1 column right, etc.)
     *** \param horizontal true if moving horizontally, false if moving vertically
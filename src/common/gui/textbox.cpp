@@ -73,6 +73,9 @@ TextBox::TextBox(float x, float y, float width, float height, const TEXT_DISPLAY
 
 void TextBox::ClearText()
 {
+    if(!_text_save.empty())
+        _MarkOwnerDirty();
+
     _finished = true;
     _text.clear();
     _num_chars = 0;
@@ -85,6 +88,8 @@ void TextBox::Update(uint32_t time)
     if (_finished)
         return;
 
+    // The text is being displayed gradually.
+    _MarkOwnerDirty();
     _current_time += time;
 
     if(_text.empty() == false && _current_time > _end_time)
@@ -167,6 +172,7 @@ void TextBox::SetDisplayMode(const TEXT_DISPLAY_MODE &mode)
     }
 
     _mode = mode;
+    _MarkOwnerDirty();
 }
 
 void TextBox::SetDisplaySpeed(float display_speed)
@@ -230,6 +236,7 @@ void TextBox::_ReformatText()
 {
     // Go through the text ustring and determine where the newline characters can be found,
     // examining one line at a time and adding it to the _text vector.
+    _MarkOwnerDirty();
     _text.clear();
     _num_chars = 0;
 
@@ -247,7 +254,7 @@ void TextBox::_ReformatText()
     }
     else {
         // Get the wrapped text lines
-        _text = TextManager->WrapText(_text_save, fp->ttf_font, _width);
+        _text = TextManager->WrapText(_text_save, fp, _width);
 
         // Compute the number of chars
         const size_t temp_length = _text_save.length();
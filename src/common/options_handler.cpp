@@ -131,7 +131,8 @@ void OptionMenu::InputRight()
     }
 }
 
-const uint16_t SKIN_MENU_INDEX = 4;
+const uint16_t RENDER_SCALE_MENU_INDEX = 4;
+const uint16_t SKIN_MENU_INDEX = 5;
 
 GameOptionsMenuHandler::GameOptionsMenuHandler(vt_mode_manager::GameMode* parent_mode):
     _first_run(false),
@@ -428,6 +429,9 @@ void GameOptionsMenuHandler::_SetupVideoOptionsMenu()
     _video_options_menu.AddOption(UTranslate("VSync: "), this, nullptr, nullptr, nullptr,
                                   &GameOptionsMenuHandler::_OnChangeVSyncLeft,
                                   &GameOptionsMenuHandler::_OnChangeVSyncRight);
+    _video_options_menu.AddOption(UTranslate("Render scale: "), this, nullptr, nullptr, nullptr,
+                                  &GameOptionsMenuHandler::_OnRenderScaleLeft,
+                                  &GameOptionsMenuHandler::_OnRenderScaleRight);
     _video_options_menu.AddOption(UTranslate("UI Theme: "), this, &GameOptionsMenuHandler::_OnUIThemeRight, nullptr, nullptr,
                                   &GameOptionsMenuHandler::_OnUIThemeLeft, &GameOptionsMenuHandler::_OnUIThemeRight);
 
@@ -712,6 +716,10 @@ void GameOptionsMenuHandler::_RefreshVideoOptions()
     }
     _video_options_menu.SetOptionText(3, UTranslate("VSync: ") + MakeUnicodeString(vsync_str));
 
+    // Update the render scale
+    uint32_t render_scale = static_cast<uint32_t>(VideoManager->GetRenderScale() * 100.0f + 0.5f);
+    _video_options_menu.SetOptionText(RENDER_SCALE_MENU_INDEX, UTranslate("Render scale: ") + MakeUnicodeString(NumberToString(render_scale) + " %"));
+
     // Update the UI theme.
     _video_options_menu.SetOptionText(SKIN_MENU_INDEX, UTranslate("UI Theme: ") + GUIManager->GetDefaultMenuSkinName());
 }
@@ -936,6 +944,28 @@ void GameOptionsMenuHandler::_OnChangeVSyncRight()
     _has_modified_settings = true;
 }
 
+void GameOptionsMenuHandler::_OnRenderScaleLeft()
+{
+    float render_scale = VideoManager->GetRenderScale() - VIDEO_RENDER_SCALE_STEP;
+    if (render_scale < VIDEO_MIN_RENDER_SCALE - 0.01f)
+        render_scale = VIDEO_MAX_RENDER_SCALE;
+    VideoManager->SetRenderScale(render_scale);
+    VideoManager->ApplySettings();
+    _RefreshVideoOptions();
+    _has_modified_settings = true;
+}
+
+void GameOptionsMenuHandler::_OnRenderScaleRight()
+{
+    float render_scale = VideoManager->GetRenderScale() + VIDEO_RENDER_SCALE_STEP;
+    if (render_scale > VIDEO_MAX_RENDER_SCALE + 0.01f)
+        render_scale = VIDEO_MIN_RENDER_SCALE;
+    VideoManager->SetRenderScale(render_scale);
+    VideoManager->ApplySettings();
+    _RefreshVideoOptions();
+    _has_modified_settings = true;
+}
+
 void GameOptionsMenuHandler::_OnUIThemeLeft()
 {
     GUIManager->SetPreviousDefaultMenuSkin();
@@ -1163,7 +1193,10 @@ void GameOptionsMenuHandler::_UpdateExplanationText()
         case 3:
             _explanation_window.SetText(UTranslate("Permits to change the Screen Vertical Synchronization mode. (Use the left and right arrow keys.)"));
             break;
-        case 4:
+        case RENDER_SCALE_MENU_INDEX:
+            _explanation_window.SetText(UTranslate("Renders the maps at a lower resolution to run faster on slow graphic cards. The menus keep the full resolution. Default: 100%"));
+            break;
+        case SKIN_MENU_INDEX:
             _explanation_window.SetText(UTranslate("Permits to change the in-game GUI theme."));
             break;
         default:
@@ -1308,6 +1341,12 @@ bool GameOptionsMenuHandler::_SaveSettingsFile(const std::string& filename)
     settings_lua.WriteBool("full_screen", VideoManager->IsFullscreen());
     settings_lua.WriteComment("Get the desired VSync mode. 0: No VSync, 1: VSync, 2: Swap Tearing");
     settings_lua.WriteUInt("vsync_mode", VideoManager->GetVSyncMode());
+    settings_lua.WriteComment("The resolution scale of the maps: [0.5 - 1.0]");
+    settings_lua.WriteFloat("render_scale", VideoManager->GetRenderScale());
+    settings_lua.WriteComment("The video memory the textures may use, in megabytes. 0: No limit");
+    settings_lua.WriteUInt("video_memory_budget", TextureManager->GetVideoMemoryBudget());
+    settings_lua.WriteComment("Keep the decoded images on disk to load them faster");
+    settings_lua.WriteBool("texture_cache", VideoManager->IsImageCacheEnabled());
     settings_lua.WriteComment("The UI Theme to load.");
     settings_lua.WriteString("ui_theme", GUIManager->GetDefaultMenuSkinId());
     settings_lua.EndTable(); // video_settings
@@ -246,6 +246,8 @@ private:
     void _OnBrightnessRight();
     void _OnChangeVSyncLeft();
     void _OnChangeVSyncRight();
+    void _OnRenderScaleLeft();
+    void _OnRenderScaleRight();
     void _OnUIThemeLeft();
     void _OnUIThemeRight();
     //@}
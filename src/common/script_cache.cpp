@@ -0,0 +1,200 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2017 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    script_cache.cpp
+*** \brief   Source file for the precompiled Lua scripts cache.
+*** ***************************************************************************/
+
+#include "common/script_cache.h"
+
+#include "common/app_settings.h"
+
+#include "utils/utils_common.h"
+#include "utils/utils_files.h"
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+#include <lualib.h>
+}
+
+#include <sys/stat.h>
+#include <dirent.h>
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <sstream>
+
+namespace vt_common
+{
+
+//! \brief The folder of the user data path where the compiled scripts are stored.
+const std::string SCRIPT_CACHE_DIRECTORY = "script_cache/";
+
+//! \brief The file telling which script version a compiled copy was made from.
+const std::string SCRIPT_CACHE_VERSION_FILE = ".version";
+
+//! \brief Appends the chunks given by lua_dump() to a string.
+static int WriteCompiledChunk(lua_State* /*state*/, const void* data, size_t size, void* buffer)
+{
+    static_cast<std::string*>(buffer)->append(static_cast<const char*>(data), size);
+    return 0;
+}
+
+//! \brief Returns the string identifying the current version of a script,
+//! or an empty string if the file can't be found.
+static std::string GetScriptVersion(const std::string& filename)
+{
+    struct stat file_info;
+    if(stat(filename.c_str(), &file_info) != 0)
+        return std::string();
+
+    // The compiled chunks also depend on the Lua version and the platform.
+    std::ostringstream version;
+    version << file_info.st_mtime << '|' << file_info.st_size
+            << '|' << LUA_VERSION_NUM << '|' << sizeof(void*);
+    return version.str();
+}
+
+//! \brief Returns the version a compiled copy was made from, or an empty string if unknown.
+static std::string ReadCompiledVersion(const std::string& version_filename)
+{
+    std::ifstream input(version_filename.c_str());
+    std::string version;
+    std::getline(input, version);
+    return version;
+}
+
+//! \brief Writes the version a compiled copy was made from.
+static bool WriteCompiledVersion(const std::string& version_filename, const std::string& version)
+{
+    std::ofstream output(version_filename.c_str(), std::ios::trunc);
+    output << version << std::endl;
+    output.close();
+    return static_cast<bool>(output);
+}
+
+//! \brief Compiles a script and writes the compiled chunk in the given file.
+static bool CompileScript(const std::string& filename, const std::string& compiled_filename)
+{
+    std::ifstream source(filename.c_str(), std::ios::binary);
+    if(!source)
+        return false;
+    std::string code((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+
+    lua_State* state = luaL_newstate();
+    if(state == nullptr)
+        return false;
+
+    // The '@' prefix makes Lua report the errors using the source file name.
+    std::string chunk_name = "@" + filename;
+    std::string compiled;
+    bool success = (luaL_loadbuffer(state, code.data(), code.size(), chunk_name.c_str()) == 0);
+    if(success) {
+#if LUA_VERSION_NUM >= 503
+        success = (lua_dump(state, WriteCompiledChunk, &compiled, 0) == 0);
+#else
+        success = (lua_dump(state, WriteCompiledChunk, &compiled) == 0);
+#endif
+    }
+    else {
+        PRINT_WARNING << "Couldn't compile script: " << lua_tostring(state, -1) << std::endl;
+    }
+    lua_close(state);
+
+    if(!success)
+        return false;
+
+    // Write in a temporary file first, so that an interrupted write
+    // never leaves a broken chunk behind.
+    std::string temp_filename = compiled_filename + ".tmp";
+    std::ofstream output(temp_filename.c_str(), std::ios::binary | std::ios::trunc);
+    output.write(compiled.data(), compiled.size());
+    output.close();
+    if(!output) {
+        std::remove(temp_filename.c_str());
+        return false;
+    }
+
+    std::remove(compiled_filename.c_str());
+    return (std::rename(temp_filename.c_str(), compiled_filename.c_str()) == 0);
+}
+
+std::string GetPrecompiledScript(const std::string& filename)
+{
+    std::string version = GetScriptVersion(filename);
+    if(version.empty())
+        return filename;
+
+    // Each script gets its own folder, so that the compiled copy can keep
+    // the script file name, from which its tablespace is computed.
+    // A new version of the script replaces the previous compiled copy.
+    std::ostringstream key;
+    key << std::hex << std::hash<std::string>()(filename);
+    std::string cache_directory = GetUserDataPath() + SCRIPT_CACHE_DIRECTORY;
+    std::string key_directory = cache_directory + key.str() + "/";
+    std::string compiled_filename = key_directory + filename.substr(filename.find_last_of('/') + 1);
+    std::string version_filename = key_directory + SCRIPT_CACHE_VERSION_FILE;
+
+    if(vt_utils::DoesFileExist(compiled_filename) && ReadCompiledVersion(version_filename) == version)
+        return compiled_filename;
+
+    if(!vt_utils::DoesFileExist(cache_directory))
+        vt_utils::MakeDirectory(cache_directory);
+    if(!vt_utils::DoesFileExist(key_directory))
+        vt_utils::MakeDirectory(key_directory);
+
+    // The version is written last, so that an interrupted update is redone.
+    std::remove(version_filename.c_str());
+    if(!CompileScript(filename, compiled_filename)) {
+        std::remove(compiled_filename.c_str());
+        return filename;
+    }
+    WriteCompiledVersion(version_filename, version);
+
+    return compiled_filename;
+}
+
+uint32_t PrecompileScripts(const std::string& directory)
+{
+    DIR* dir = opendir(directory.c_str());
+    if(dir == nullptr) {
+        PRINT_WARNING << "Couldn't open directory: " << directory << std::endl;
+        return 0;
+    }
+
+    uint32_t compiled = 0;
+    struct dirent* entry;
+    while((entry = readdir(dir)) != nullptr) {
+        std::string name = entry->d_name;
+        if(name == "." || name == "..")
+            continue;
+
+        std::string path = directory + "/" + name;
+        struct stat file_info;
+        if(stat(path.c_str(), &file_info) != 0)
+            continue;
+
+        if(S_ISDIR(file_info.st_mode)) {
+            compiled += PrecompileScripts(path);
+        }
+        else if(name.size() > 4 && name.compare(name.size() - 4, 4, ".lua") == 0) {
+            if(GetPrecompiledScript(path) != path)
+                ++compiled;
+        }
+    }
+    closedir(dir);
+
+    return compiled;
+}
+
+} // namespace vt_common
@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2017 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    script_cache.h
+*** \brief   Header file for the precompiled Lua scripts cache.
+***
+*** Lua compiles a script each time it is opened, which is a good part of the
+*** time spent loading maps. The cache stores the compiled chunks in the user
+*** data folder, one per script path, along with the modification time and
+*** size of the source they were compiled from. A compiled chunk is replaced
+*** when its source changes, and its path is given back so that it can be
+*** opened instead of the source.
+*** Lua recognizes precompiled chunks by itself, so nothing else changes.
+***
+*** The compiled copies keep the script file name, so that the tablespace
+*** computed from it stays the same, and their debug information points to
+*** the original sources.
+*** ***************************************************************************/
+
+#ifndef __SCRIPT_CACHE_HEADER__
+#define __SCRIPT_CACHE_HEADER__
+
+#include <cstdint>
+#include <string>
+
+namespace vt_common
+{
+
+/** \brief Gives the file to open for a script.
+*** \param filename The script source file.
+*** \return The path of an up-to-date precompiled copy, compiled if needed,
+*** or the source file itself when the script couldn't be compiled.
+**/
+std::string GetPrecompiledScript(const std::string& filename);
+
+/** \brief Compiles all the scripts found in a directory and its subdirectories.
+*** \return The number of scripts compiled or found up to date.
+**/
+uint32_t PrecompileScripts(const std::string& directory);
+
+} // namespace vt_common
+
+#endif // __SCRIPT_CACHE_HEADER__
@@ -43,10 +43,16 @@ bool AUDIO_ENABLE = true;
 AudioEngine::AudioEngine() :
     _sound_volume(1.0f),
     _music_volume(1.0f),
+    _music_ducking(1.0f),
     _device(0),
     _context(0),
     _max_sources(MAX_DEFAULT_AUDIO_SOURCES),
-    _active_music(nullptr)
+    _active_music(nullptr),
+    _audio_cache_size(0),
+    _audio_cache_budget(DEFAULT_AUDIO_CACHE_BUDGET),
+    _audio_cache_hits(0),
+    _audio_cache_misses(0),
+    _audio_cache_evictions(0)
 {}
 
 bool AudioEngine::SingletonInitialize()
@@ -137,6 +143,9 @@ bool AudioEngine::SingletonInitialize()
         _audio_sources.push_back(new private_audio::AudioSource(source));
     }
 
+    // Every source is available at startup.
+    _free_sources = _audio_sources;
+
     if(_max_sources == 0) {
         PRINT_ERROR << "failed to create at least one OpenAL audio source" << std::endl;
         return false;
@@ -155,12 +164,7 @@ AudioEngine::~AudioEngine()
         delete i->second.audio;
     }
     _audio_cache.clear();
-
-    // Delete all audio sources
-    for(std::vector<AudioSource *>::iterator i = _audio_sources.begin(); i != _audio_sources.end(); ++i) {
-        delete(*i);
-    }
-    _audio_sources.clear();
+    _audio_cache_size = 0;
 
     // We shouldn't have any descriptors registered left,
     // except when some scripts have created its own descriptors and didn't free them.
@@ -199,6 +203,20 @@ AudioEngine::~AudioEngine()
         }
     }
 
+    // Delete all audio sources, once the descriptors gave them back.
+    for(std::vector<AudioSource *>::iterator i = _audio_sources.begin(); i != _audio_sources.end(); ++i) {
+        delete(*i);
+    }
+    _audio_sources.clear();
+    _free_sources.clear();
+    _active_sources.clear();
+
+    // The buffers can only be deleted once no source uses them anymore.
+    for(std::map<std::string, SharedAudioBuffer *>::iterator i = _shared_buffers.begin(); i != _shared_buffers.end(); ++i) {
+        delete i->second;
+    }
+    _shared_buffers.clear();
+
     alcMakeContextCurrent(0);
     alcDestroyContext(_context);
     alcCloseDevice(_device);
@@ -209,10 +227,24 @@ void AudioEngine::Update()
     if(!AUDIO_ENABLE)
         return;
 
-    for(std::vector<AudioSource *>::iterator i = _audio_sources.begin(); i != _audio_sources.end(); ++i) {
-        if((*i)->owner) {
-            (*i)->owner->_Update();
+    // Update the fades first, so that the sources stopped by them are released below.
+    _effects.Update();
+
+    for(uint32_t i = 0; i < _active_sources.size();) {
+        AudioSource *source = _active_sources[i];
+        AudioDescriptor *owner = source->owner;
+        if(owner)
+            owner->_Update();
+
+        if(owner && owner->_IsActive()) {
+            ++i;
+            continue;
         }
+
+        // The voice has stopped or was released: remove it without keeping the order.
+        source->active = false;
+        _active_sources[i] = _active_sources.back();
+        _active_sources.pop_back();
     }
 }
 
@@ -248,12 +280,16 @@ void AudioEngine::SetMusicVolume(float volume)
     }
 
     for(std::vector<MusicDescriptor *>::iterator i = _registered_music.begin(); i != _registered_music.end(); ++i) {
-        if((*i)->_source != nullptr) {
-            alSourcef((*i)->_source->source, AL_GAIN, _music_volume * (*i)->GetVolume());
-        }
+        _ApplyMusicVolume(*i);
     }
 }
 
+void AudioEngine::SetAudioCacheBudget(uint32_t budget)
+{
+    _audio_cache_budget = budget;
+    _EnforceAudioCacheBudget(std::string());
+}
+
 void AudioEngine::PauseAllSounds()
 {
     for(std::vector<SoundDescriptor *>::iterator i = _registered_sounds.begin();
@@ -337,6 +373,23 @@ void AudioEngine::FadeOutAllSounds(float time)
     }
 }
 
+void AudioEngine::DuckMusic(float level, float time)
+{
+    if(!AUDIO_ENABLE)
+        return;
+
+    if(level < 0.0f)
+        level = 0.0f;
+    else if(level > 1.0f)
+        level = 1.0f;
+
+    if(time <= 10.0f || !_effects.AddEffect(AUDIO_EFFECT_MUSIC_DUCKING, nullptr, _music_ducking, level,
+                                            static_cast<uint32_t>(time))) {
+        _effects.RemoveEffect(nullptr);
+        _SetMusicDucking(level);
+    }
+}
+
 void AudioEngine::SetListenerPosition(const float position[3])
 {
     alListenerfv(AL_POSITION, position);
@@ -395,6 +448,8 @@ void AudioEngine::PlaySound(const std::string &filename)
         } else {
             element = _audio_cache.find(filename);
         }
+    } else {
+        ++_audio_cache_hits;
     }
 
     element->second.audio->Play();
@@ -417,6 +472,8 @@ void AudioEngine::PlayMusic(const std::string &filename)
         } else {
             element = _audio_cache.find(filename);
         }
+    } else {
+        ++_audio_cache_hits;
     }
 
     // Special case: the music descriptor object must be taken back:
@@ -466,7 +523,7 @@ void AudioEngine::ResumeSound(const std::string &filename)
     element->second.last_update_time = SDL_GetTicks();
 }
 
-SoundDescriptor *AudioEngine::RetrieveSound(const std::string &filename)
+SoundDescriptor *AudioEngine::RetrieveSound(const std::string &filename, vt_mode_manager::GameMode *gm)
 {
     std::map<std::string, AudioCacheElement>::iterator element = _audio_cache.find(filename);
 
@@ -476,11 +533,13 @@ SoundDescriptor *AudioEngine::RetrieveSound(const std::string &filename)
         IF_PRINT_WARNING(AUDIO_DEBUG) << "incorrectly requested to retrieve a sound for a music filename: " << filename << std::endl;
         return nullptr;
     } else {
+        if(gm)
+            element->second.audio->AddGameModeOwner(gm);
         return dynamic_cast<SoundDescriptor *>(element->second.audio);
     }
 }
 
-MusicDescriptor *AudioEngine::RetrieveMusic(const std::string &filename)
+MusicDescriptor *AudioEngine::RetrieveMusic(const std::string &filename, vt_mode_manager::GameMode *gm)
 {
     std::map<std::string, AudioCacheElement>::iterator element = _audio_cache.find(filename);
 
@@ -490,6 +549,8 @@ MusicDescriptor *AudioEngine::RetrieveMusic(const std::string &filename)
         IF_PRINT_WARNING(AUDIO_DEBUG) << "incorrectly requested to retrieve music for a sound filename: " << filename << std::endl;
         return nullptr;
     } else {
+        if(gm)
+            element->second.audio->AddGameModeOwner(gm);
         return dynamic_cast<MusicDescriptor *>(element->second.audio);
     }
 }
@@ -504,6 +565,7 @@ void AudioEngine::RemoveGameModeOwner(vt_mode_manager::GameMode* gm)
     for(; it != _audio_cache.end();) {
         // If the audio buffers are erased, we can remove the descriptor from the cache.
         if(it->second.audio->RemoveGameModeOwner(gm)) {
+            _audio_cache_size -= it->second.size;
             delete it->second.audio;
             // Make sure the iterator doesn't get flawed after erase.
             _audio_cache.erase(it++);
@@ -560,6 +622,16 @@ void AudioEngine::DEBUG_PrintInfo()
     PRINT_WARNING << "*** Audio Information ***" << std::endl;
 
     PRINT_WARNING << "Maximum number of sources:   " << _max_sources << std::endl;
+    PRINT_WARNING << "Free sources:                " << _free_sources.size() << std::endl;
+    PRINT_WARNING << "Active voices:               " << _active_sources.size() << std::endl;
+    PRINT_WARNING << "Audio cache entries:         " << _audio_cache.size() << std::endl;
+    PRINT_WARNING << "Audio cache size (bytes):    " << _audio_cache_size << " / " << _audio_cache_budget << std::endl;
+    PRINT_WARNING << "Audio cache hits:            " << _audio_cache_hits << std::endl;
+    PRINT_WARNING << "Audio cache misses:          " << _audio_cache_misses << std::endl;
+    PRINT_WARNING << "Audio cache evictions:       " << _audio_cache_evictions << std::endl;
+    PRINT_WARNING << "Shared static buffers:       " << _shared_buffers.size() << std::endl;
+    PRINT_WARNING << "Running audio effects:       " << _effects.GetEffectCount() << " / " << AUDIO_EFFECT_POOL_SIZE << std::endl;
+    PRINT_WARNING << "Music ducking:               " << _music_ducking << std::endl;
     PRINT_WARNING << "Default audio device:        " << alcGetString(_device, ALC_DEFAULT_DEVICE_SPECIFIER) << std::endl;
     PRINT_WARNING << "OpenAL Version:              " << alGetString(AL_VERSION) << std::endl;
     PRINT_WARNING << "OpenAL Renderer:             " << alGetString(AL_RENDERER) << std::endl;
@@ -587,22 +659,60 @@ void AudioEngine::DEBUG_PrintInfo()
     }
 }
 
-private_audio::AudioSource* AudioEngine::_AcquireAudioSource()
+private_audio::AudioSource* AudioEngine::_AcquireAudioSource(AUDIO_PRIORITY priority, bool steal_playing_voices)
 {
-    // Find and return the first source that does not have an owner
-    for(std::vector<AudioSource *>::iterator i = _audio_sources.begin(); i != _audio_sources.end(); ++i) {
-        AudioDescriptor* descriptor = (*i)->owner;
-        if(descriptor == nullptr) {
-            return *i;
+    if(_free_sources.empty()) {
+        // Find a voice to steal: a stopped one first, or else a playing one of lower priority.
+        AudioDescriptor* stopped_voice = nullptr;
+        AudioDescriptor* playing_voice = nullptr;
+        for(std::vector<AudioSource *>::iterator i = _audio_sources.begin(); i != _audio_sources.end(); ++i) {
+            AudioDescriptor* descriptor = (*i)->owner;
+            if(descriptor == nullptr)
+                continue;
+
+            AUDIO_STATE state = descriptor->GetState();
+            if(state == AUDIO_STATE_STOPPED || state == AUDIO_STATE_UNLOADED) {
+                if(stopped_voice == nullptr || descriptor->_priority < stopped_voice->_priority)
+                    stopped_voice = descriptor;
+            }
+            else if(steal_playing_voices && descriptor->_priority < priority) {
+                if(playing_voice == nullptr || descriptor->_priority < playing_voice->_priority)
+                    playing_voice = descriptor;
+            }
         }
-        else if (descriptor->GetState() == AUDIO_STATE_UNLOADED) {
-            // Test whether the sound is unloaded, meaning the source is available
-            return *i;
+
+        AudioDescriptor* victim = stopped_voice ? stopped_voice : playing_voice;
+        if(victim == nullptr) {
+            // All the sources are used by audio at least as important as the requested one.
+            return nullptr;
         }
+
+        IF_PRINT_DEBUG(AUDIO_DEBUG) << "Stealing the audio source of: " << victim->GetFilename() << std::endl;
+        victim->_ReleaseSource();
     }
 
-    // Return nullptr in the (extremely rare) case that all sources are owned and actively playing or paused
-    return nullptr;
+    AudioSource* source = _free_sources.back();
+    _free_sources.pop_back();
+    return source;
+}
+
+void AudioEngine::_ReleaseAudioSource(private_audio::AudioSource* source)
+{
+    // A source without owner is already free.
+    if(source == nullptr || source->owner == nullptr)
+        return;
+
+    source->Reset();
+    _free_sources.push_back(source);
+}
+
+void AudioEngine::_ActivateAudioSource(private_audio::AudioSource* source)
+{
+    if(source == nullptr || source->active)
+        return;
+
+    source->active = true;
+    _active_sources.push_back(source);
 }
 
 
@@ -614,6 +724,8 @@ bool AudioEngine::_LoadAudio(const std::string &filename, bool is_music, vt_mode
 
     std::map<std::string, private_audio::AudioCacheElement>::iterator it = _audio_cache.find(filename);
     if(it != _audio_cache.end()) {
+        ++_audio_cache_hits;
+        it->second.last_update_time = SDL_GetTicks();
 
         if (gm)
             it->second.audio->AddGameModeOwner(gm);
@@ -622,6 +734,8 @@ bool AudioEngine::_LoadAudio(const std::string &filename, bool is_music, vt_mode
         return true;
     }
 
+    ++_audio_cache_misses;
+
     // Creates the new audio object and adds its potential game mode owner.
     AudioDescriptor* audio = nullptr;
     if (is_music)
@@ -639,8 +753,94 @@ bool AudioEngine::_LoadAudio(const std::string &filename, bool is_music, vt_mode
         return false;
     }
 
-    _audio_cache.insert(std::make_pair(filename, AudioCacheElement(SDL_GetTicks(), audio)));
+    AudioCacheElement element(SDL_GetTicks(), audio);
+    _audio_cache_size += element.size;
+    _audio_cache.insert(std::make_pair(filename, element));
+
+    _EnforceAudioCacheBudget(filename);
     return true;
 }
 
+void AudioEngine::_EnforceAudioCacheBudget(const std::string &kept_filename)
+{
+    while(_audio_cache_size > _audio_cache_budget) {
+        // Find the least recently used entry that can be removed.
+        std::map<std::string, AudioCacheElement>::iterator oldest = _audio_cache.end();
+        for(std::map<std::string, AudioCacheElement>::iterator it = _audio_cache.begin(); it != _audio_cache.end(); ++it) {
+            AudioDescriptor* audio = it->second.audio;
+            if(it->first == kept_filename || audio == _active_music
+                    || !audio->GetGameModeOwners()->empty())
+                continue;
+
+            AUDIO_STATE state = audio->GetState();
+            if(state != AUDIO_STATE_STOPPED && state != AUDIO_STATE_UNLOADED)
+                continue;
+
+            if(oldest == _audio_cache.end() || it->second.last_update_time < oldest->second.last_update_time)
+                oldest = it;
+        }
+
+        // Everything left is in use.
+        if(oldest == _audio_cache.end())
+            return;
+
+        IF_PRINT_DEBUG(AUDIO_DEBUG) << "Evicting audio from the cache: " << oldest->first << std::endl;
+        _audio_cache_size -= oldest->second.size;
+        delete oldest->second.audio;
+        _audio_cache.erase(oldest);
+        ++_audio_cache_evictions;
+    }
+}
+
+SharedAudioBuffer *AudioEngine::_AcquireSharedBuffer(const std::string &filename)
+{
+    std::map<std::string, SharedAudioBuffer *>::iterator it = _shared_buffers.find(filename);
+    if(it != _shared_buffers.end()) {
+        ++it->second->reference_count;
+        return it->second;
+    }
+
+    SharedAudioBuffer *shared_buffer = new SharedAudioBuffer();
+    if(!shared_buffer->Load(filename)) {
+        delete shared_buffer;
+        return nullptr;
+    }
+
+    shared_buffer->reference_count = 1;
+    _shared_buffers.insert(std::make_pair(filename, shared_buffer));
+    return shared_buffer;
+}
+
+void AudioEngine::_ReleaseSharedBuffer(SharedAudioBuffer *shared_buffer)
+{
+    if(shared_buffer == nullptr)
+        return;
+
+    if(shared_buffer->reference_count > 1) {
+        --shared_buffer->reference_count;
+        return;
+    }
+
+    _shared_buffers.erase(shared_buffer->input->GetFilename());
+    delete shared_buffer;
+}
+
+void AudioEngine::_SetMusicDucking(float ducking)
+{
+    if(ducking == _music_ducking)
+        return;
+
+    _music_ducking = ducking;
+    for(std::vector<MusicDescriptor *>::iterator i = _registered_music.begin(); i != _registered_music.end(); ++i) {
+        _ApplyMusicVolume(*i);
+    }
+}
+
+void AudioEngine::_ApplyMusicVolume(MusicDescriptor *music)
+{
+    if(music->_source != nullptr) {
+        alSourcef(music->_source->source, AL_GAIN, _music_volume * _music_ducking * music->GetVolume());
+    }
+}
+
 } // namespace vt_audio
@@ -53,6 +53,14 @@ namespace private_audio
 //! \brief The maximum default number of audio sources that the engine tries to create
 const uint16_t MAX_DEFAULT_AUDIO_SOURCES = 64;
 
+//! \brief The default memory budget of the audio cache, in bytes of decoded audio data
+const uint32_t DEFAULT_AUDIO_CACHE_BUDGET = 32 * 1024 * 1024;
+
+//! \brief The default level the music volume is lowered to while ducked
+const float DEFAULT_MUSIC_DUCKING_LEVEL = 0.6f;
+
+//! \brief The default time the music takes to be ducked or restored, in milliseconds
+const float DEFAULT_MUSIC_DUCKING_TIME = 300.0f;
 
 
 //! \brief A container class for an element of the LRU audio cache managed by the AudioEngine class
@@ -60,13 +68,16 @@ class AudioCacheElement
 {
 public:
     AudioCacheElement(uint32_t time, AudioDescriptor *aud) :
-        last_update_time(time), audio(aud) {}
+        last_update_time(time), audio(aud), size(aud->GetMemorySize()) {}
 
     //! \brief Retains the time that the audio was last updated through any operation
     uint32_t last_update_time;
 
     //! \brief A pointer to the audio descriptor described by the cache element
     AudioDescriptor *audio;
+
+    //! \brief The number of bytes of decoded audio data held by the audio when cached
+    uint32_t size;
 };
 
 } // namespace private_audio
@@ -90,7 +101,7 @@ class AudioEngine : public vt_utils::Singleton<AudioEngine>
     friend class AudioDescriptor;
     friend class SoundDescriptor;
     friend class MusicDescriptor;
-    friend class Effects;
+    friend class private_audio::AudioEffectPool;
 
 public:
     ~AudioEngine();
@@ -100,7 +111,9 @@ public:
     **/
     bool SingletonInitialize();
 
-    //! \brief Updates various parts of the audio state, such as streaming buffers
+    /** \brief Updates various parts of the audio state, such as streaming buffers
+    *** Only the voices playing or fading are updated.
+    **/
     void Update();
 
     float GetSoundVolume() const {
@@ -111,6 +124,11 @@ public:
         return _music_volume;
     }
 
+    //! \brief Returns the factor applied to the music volume by the music ducking, 1.0f when not ducked
+    float GetMusicDucking() const {
+        return _music_ducking;
+    }
+
     /** \brief Sets the global volume level for all sounds
     *** \param volume The sound volume level to set. The valid range is: [0.0 (mute), 1.0 (max volume)]
     **/
@@ -199,6 +217,30 @@ public:
     void FadeOutActiveMusic(float time = 1000.0f);
     void FadeInActiveMusic(float time = 1000.0f);
     void FadeOutAllSounds(float time = 1000.0f);
+
+    /** \brief Lowers the volume of all the music, e.g. while a dialogue is displayed.
+    *** \param level The factor applied to the music volume, from 0.0f to 1.0f.
+    *** \param time The time in ms to reach that level.
+    *** \note Overloads are used rather than default arguments, so that the scripts get the defaults too.
+    **/
+    void DuckMusic(float level, float time);
+
+    void DuckMusic(float level) {
+        DuckMusic(level, private_audio::DEFAULT_MUSIC_DUCKING_TIME);
+    }
+
+    void DuckMusic() {
+        DuckMusic(private_audio::DEFAULT_MUSIC_DUCKING_LEVEL, private_audio::DEFAULT_MUSIC_DUCKING_TIME);
+    }
+
+    //! \brief Restores the volume of all the music lowered by DuckMusic().
+    void UnduckMusic(float time) {
+        DuckMusic(1.0f, time);
+    }
+
+    void UnduckMusic() {
+        UnduckMusic(private_audio::DEFAULT_MUSIC_DUCKING_TIME);
+    }
     //@}
 
     /** \brief Plays a sound once with no looping
@@ -270,15 +312,32 @@ public:
         ResumeSound(filename);
     }
 
-    //! \return A pointer to the SoundDescriptor contained within the cache, or nullptr if it could not be found
-    SoundDescriptor *RetrieveSound(const std::string &filename);
+    /** \return A pointer to the SoundDescriptor contained within the cache, or nullptr if it could not be found
+    *** \param gm The game mode keeping the pointer, which then owns the sound until it ends.
+    *** Without owner, the sound can be evicted by the next audio load and the pointer must be used right away.
+    **/
+    SoundDescriptor *RetrieveSound(const std::string &filename, vt_mode_manager::GameMode *gm = nullptr);
 
-    //! \return A pointer to the MusicDescriptor contained within the cache, or nullptr if it could not be found
-    MusicDescriptor *RetrieveMusic(const std::string &filename);
+    /** \return A pointer to the MusicDescriptor contained within the cache, or nullptr if it could not be found
+    *** \param gm The game mode keeping the pointer, which then owns the music until it ends.
+    *** Without owner, the music can be evicted by the next audio load and the pointer must be used right away.
+    **/
+    MusicDescriptor *RetrieveMusic(const std::string &filename, vt_mode_manager::GameMode *gm = nullptr);
 
     //! \returns A pointer of the active music descriptor (the one playing or ready to be played.)
     MusicDescriptor* GetActiveMusic()
     { return _active_music; }
+
+    uint32_t GetAudioCacheBudget() const {
+        return _audio_cache_budget;
+    }
+
+    /** \brief Sets the memory budget of the audio cache
+    *** \param budget The maximum number of bytes of decoded audio data the cache should hold.
+    *** When the budget is exceeded, the least recently used audio not owned by any game mode,
+    *** and neither playing nor paused, is removed from the cache.
+    **/
+    void SetAudioCacheBudget(uint32_t budget);
     //@}
 
     /**
@@ -340,6 +399,9 @@ private:
     //! \brief The global volume level of all music (0.0f is mute, 1.0f is max)
     float _music_volume;
 
+    //! \brief The factor applied to the music volume on top of the global one, lowered by DuckMusic()
+    float _music_ducking;
+
     //! \brief The OpenAL device currently being utilized by the audio engine
     ALCdevice *_device;
 
@@ -368,6 +430,14 @@ private:
     //! \brief Contains all available audio sources
     std::vector<private_audio::AudioSource *> _audio_sources;
 
+    //! \brief The audio sources without owner, used as a stack to acquire sources in constant time
+    std::vector<private_audio::AudioSource *> _free_sources;
+
+    /** \brief The audio sources whose owner is playing or fading, and thus needs updates every frame
+    *** The sources in this list have their active member set to true.
+    **/
+    std::vector<private_audio::AudioSource *> _active_sources;
+
     /** \brief Lists of pointers to all audio descriptor objects which have been created by the user
     *** These lists are kept so that when the global sound or music volume levels are changed, all
     *** sound and music objects will also have their volumes updated.
@@ -391,10 +461,43 @@ private:
     **/
     std::map<std::string, private_audio::AudioCacheElement> _audio_cache;
 
+    //! \brief The number of bytes of decoded audio data held by the audio cache entries
+    uint32_t _audio_cache_size;
+
+    //! \brief The maximum number of bytes the audio cache should hold before evicting entries
+    uint32_t _audio_cache_budget;
+
+    //! \brief The audio cache statistics, printed by DEBUG_PrintInfo()
+    //@{
+    uint32_t _audio_cache_hits;
+    uint32_t _audio_cache_misses;
+    uint32_t _audio_cache_evictions;
+    //@}
+
+    //! \brief The fades of the audio and the music ducking, updated together every frame
+    private_audio::AudioEffectPool _effects;
+
+    /** \brief The buffers of the audio loaded statically, indexed by filename
+    *** Each buffer is deleted when the last audio descriptor using it is freed.
+    **/
+    std::map<std::string, private_audio::SharedAudioBuffer *> _shared_buffers;
+
     /** \brief Acquires an available audio source that may be used
+    *** \param priority The priority of the audio requesting the source
+    *** \param steal_playing_voices Whether a playing audio of lower priority may lose its source.
     *** \return A pointer to the available source, or nullptr if no available source could be found
+    ***
+    *** When no source is free, the source of a stopped audio is taken back first,
+    *** the one with the lowest priority being chosen. Otherwise, and if permitted,
+    *** the playing audio with the lowest priority, lower than the requested one, is stopped.
     **/
-    private_audio::AudioSource *_AcquireAudioSource();
+    private_audio::AudioSource *_AcquireAudioSource(AUDIO_PRIORITY priority, bool steal_playing_voices);
+
+    //! \brief Resets the given source and puts it back in the free sources.
+    void _ReleaseAudioSource(private_audio::AudioSource *source);
+
+    //! \brief Adds the given source to the voices updated every frame, if not already there.
+    void _ActivateAudioSource(private_audio::AudioSource *source);
 
     /** \brief A helper function to LoadSound and LoadMusic that takes care of the messy details of cache managment
     *** \param filename The filename of the audio to load
@@ -405,6 +508,28 @@ private:
     **/
     bool _LoadAudio(const std::string &filename, bool is_music, vt_mode_manager::GameMode *gm = nullptr);
 
+    /** \brief Removes the least recently used entries from the audio cache until it fits its memory budget
+    *** \param kept_filename The filename of an entry that must not be removed, such as the one just loaded.
+    *** Only the audio not owned by any game mode, not being played, paused or fading, and not being
+    *** the active music can be removed.
+    **/
+    void _EnforceAudioCacheBudget(const std::string &kept_filename);
+
+    /** \brief Gives the shared buffer of an audio file, loading it when not used yet
+    *** \param filename The filename of the audio to load statically
+    *** \return The buffer, whose reference count was increased, or nullptr if the file could not be loaded
+    **/
+    private_audio::SharedAudioBuffer *_AcquireSharedBuffer(const std::string &filename);
+
+    //! \brief Decreases the reference count of a shared buffer, deleting it when not used anymore.
+    void _ReleaseSharedBuffer(private_audio::SharedAudioBuffer *shared_buffer);
+
+    //! \brief Sets the music ducking factor and applies it to all the music.
+    void _SetMusicDucking(float ducking);
+
+    //! \brief Applies the global volume and the ducking of the music to a music source.
+    void _ApplyMusicVolume(MusicDescriptor *music);
+
 }; // class AudioEngine : public vt_utils::Singleton<AudioEngine>
 
 } // namespace vt_audio
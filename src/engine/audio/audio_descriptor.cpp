@@ -40,6 +40,52 @@ namespace vt_audio
 namespace private_audio
 {
 
+//! \brief Creates and initializes the input corresponding to the audio file extension, or returns nullptr.
+static AudioInput *_CreateAudioInput(const std::string &filename)
+{
+    if(filename.size() <= 3) {  // Name of file is at least 3 letters (so the extension is in there)
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "file name argument is too short: " << filename << std::endl;
+        return nullptr;
+    }
+    // Convert the file extension to uppercase and use it to create the proper input type
+    std::string file_extension = filename.substr(filename.size() - 3, 3);
+    file_extension = vt_utils::Upcase(file_extension);
+
+    // Based on the extension of the file, load properly one
+    AudioInput *input = nullptr;
+    if(file_extension.compare("WAV") == 0) {
+        input = new WavFile(filename);
+    } else if(file_extension.compare("OGG") == 0) {
+        input = new OggFile(filename);
+    } else {
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "failed due to unsupported input file extension: " << file_extension << std::endl;
+        return nullptr;
+    }
+
+    if(input->Initialize() == false) {
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to load and initialize audio file: " << filename << std::endl;
+        delete input;
+        return nullptr;
+    }
+
+    return input;
+}
+
+//! \brief Returns the OpenAL format of the data read from the given input.
+static ALenum _GetAudioFormat(const AudioInput *input)
+{
+    if(input->GetBitsPerSample() == 8) {
+        if(input->GetNumberChannels() == 1)
+            return AL_FORMAT_MONO8;
+        return AL_FORMAT_STEREO8;
+    }
+
+    // 16 bits per sample
+    if(input->GetNumberChannels() == 1)
+        return AL_FORMAT_MONO16;
+    return AL_FORMAT_STEREO16;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // AudioBuffer class methods
 ////////////////////////////////////////////////////////////////////////////////
@@ -67,6 +113,30 @@ AudioBuffer::~AudioBuffer()
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// SharedAudioBuffer class methods
+////////////////////////////////////////////////////////////////////////////////
+
+bool SharedAudioBuffer::Load(const std::string &filename)
+{
+    input = _CreateAudioInput(filename);
+    if(input == nullptr)
+        return false;
+
+    format = _GetAudioFormat(input);
+
+    // Create space in memory for the audio data to be read and passed to the OpenAL buffer
+    std::vector<uint8_t> data(input->GetDataSize());
+    bool all_data_read = false;
+    if(data.empty() || input->Read(&data[0], input->GetTotalNumberSamples(), all_data_read) != input->GetTotalNumberSamples()) {
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to read entire audio data stream for file: " << filename << std::endl;
+        return false;
+    }
+
+    buffer.FillBuffer(&data[0], format, input->GetDataSize(), input->GetSamplesPerSecond());
+    return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // AudioSource class methods
 ////////////////////////////////////////////////////////////////////////////////
@@ -110,6 +180,7 @@ void AudioSource::Reset()
 AudioDescriptor::AudioDescriptor() :
     _state(AUDIO_STATE_UNLOADED),
     _buffer(nullptr),
+    _shared_buffer(nullptr),
     _source(nullptr),
     _input(nullptr),
     _stream(nullptr),
@@ -117,9 +188,8 @@ AudioDescriptor::AudioDescriptor() :
     _looping(false),
     _offset(0),
     _volume(1.0f),
-    _fade_effect_time(0.0f),
-    _original_volume(0.0f),
-    _stream_buffer_size(0)
+    _stream_buffer_size(0),
+    _priority(AUDIO_PRIORITY_SFX)
 {
     _position[0] = 0.0f;
     _position[1] = 0.0f;
@@ -135,6 +205,7 @@ AudioDescriptor::AudioDescriptor() :
 AudioDescriptor::AudioDescriptor(const AudioDescriptor &copy) :
     _state(AUDIO_STATE_UNLOADED),
     _buffer(nullptr),
+    _shared_buffer(nullptr),
     _source(nullptr),
     _input(nullptr),
     _stream(nullptr),
@@ -142,9 +213,8 @@ AudioDescriptor::AudioDescriptor(const AudioDescriptor &copy) :
     _looping(copy._looping),
     _offset(0),
     _volume(copy._volume),
-    _fade_effect_time(copy._fade_effect_time),
-    _original_volume(copy._original_volume),
-    _stream_buffer_size(0)
+    _stream_buffer_size(0),
+    _priority(copy._priority)
 {
     _position[0] = 0.0f;
     _position[1] = 0.0f;
@@ -170,66 +240,28 @@ bool AudioDescriptor::LoadAudio(const std::string &filename, AUDIO_LOAD load_typ
     // Clean out any audio resources being used before trying to set new ones
     FreeAudio();
 
-    // Load the input file for the audio
-    if(filename.size() <= 3) {  // Name of file is at least 3 letters (so the extension is in there)
-        IF_PRINT_WARNING(AUDIO_DEBUG) << "file name argument is too short: " << filename << std::endl;
-        return false;
-    }
-    // Convert the file extension to uppercase and use it to create the proper input type
-    std::string file_extension = filename.substr(filename.size() - 3, 3);
-    file_extension = vt_utils::Upcase(file_extension);
-
-    // Based on the extension of the file, load properly one
-    if(file_extension.compare("WAV") == 0) {
-        _input = new WavFile(filename);
-    } else if(file_extension.compare("OGG") == 0) {
-        _input = new OggFile(filename);
-    } else {
-        IF_PRINT_WARNING(AUDIO_DEBUG) << "failed due to unsupported input file extension: " << file_extension << std::endl;
-        return false;
-    }
-
-    if(_input->Initialize() == false) {
-        IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to load and initialize audio file: " << filename << std::endl;
-        return false;
-    }
+    // Streamed audio reads its own input, while static audio uses the one of its shared buffer
+    if(load_type != AUDIO_LOAD_STATIC) {
+        _input = _CreateAudioInput(filename);
+        if(_input == nullptr)
+            return false;
 
-    // Retreive audio data properties from the newly initialized input
-    if(_input->GetBitsPerSample() == 8) {
-        if(_input->GetNumberChannels() == 1) {
-            _format = AL_FORMAT_MONO8;
-        } else {
-            _format = AL_FORMAT_STEREO8;
-        }
-    } else { // 16 bits per sample
-        if(_input->GetNumberChannels() == 1) {
-            _format = AL_FORMAT_MONO16;
-        } else {
-            _format = AL_FORMAT_STEREO16;
-        }
+        _format = _GetAudioFormat(_input);
     }
 
     // Load the audio data depending upon the load type requested
     if(load_type == AUDIO_LOAD_STATIC) {
-        // For static sounds just 1 buffer is needed. We create it as an array here, so that
-        // later we can delete it with a call of delete[], similar to the streaming cases
-        _buffer = new AudioBuffer[1];
-
-        // Create space in memory for the audio data to be read and passed to the OpenAL buffer
-        _data = new uint8_t[_input->GetDataSize()];
-        bool all_data_read = false;
-        if(_input->Read(_data, _input->GetTotalNumberSamples(), all_data_read) != _input->GetTotalNumberSamples()) {
-            IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to read entire audio data stream for file: " << filename << std::endl;
+        // Static audio only needs 1 buffer, shared with the other audio loaded from the same file
+        _shared_buffer = AudioManager->_AcquireSharedBuffer(filename);
+        if(_shared_buffer == nullptr)
             return false;
-        }
 
-        // Pass the buffer data to the OpenAL buffer
-        _buffer->FillBuffer(_data, _format, _input->GetDataSize(), _input->GetSamplesPerSecond());
-        delete[] _data;
-        _data = nullptr;
+        _buffer = &_shared_buffer->buffer;
+        _input = _shared_buffer->input;
+        _format = _shared_buffer->format;
 
         // Attempt to acquire a source for the new audio to use
-        _AcquireSource();
+        _AcquireSource(false);
         if(_source == nullptr) {
             IF_PRINT_WARNING(AUDIO_DEBUG) << "could not acquire audio source for new audio file: " << filename << std::endl;
         }
@@ -244,7 +276,7 @@ bool AudioDescriptor::LoadAudio(const std::string &filename, AUDIO_LOAD load_typ
         _data = new uint8_t[_stream_buffer_size * _input->GetSampleSize()];
 
         // Attempt to acquire a source for the new audio to use
-        _AcquireSource();
+        _AcquireSource(false);
         if(_source == nullptr) {
             IF_PRINT_WARNING(AUDIO_DEBUG) << "could not acquire audio source for new audio file: " << filename << std::endl;
         }
@@ -252,19 +284,19 @@ bool AudioDescriptor::LoadAudio(const std::string &filename, AUDIO_LOAD load_typ
 
     // Allocate memory for the audio data to remain in and stream it from that location
     else if(load_type == AUDIO_LOAD_STREAM_MEMORY) {
+        // We need to replace the _input member with a AudioMemory class object
+        AudioInput *temp_input = _input;
+        _input = new AudioMemory(temp_input);
+        delete temp_input;
+
         _buffer = new AudioBuffer[NUMBER_STREAMING_BUFFERS]; // For streaming we need to use multiple buffers
         _stream = new AudioStream(_input, _looping);
         _stream_buffer_size = stream_buffer_size;
 
         _data = new uint8_t[_stream_buffer_size * _input->GetSampleSize()];
 
-        // We need to replace the _input member with a AudioMemory class object
-        AudioInput *temp_input = _input;
-        _input = new AudioMemory(temp_input);
-        delete temp_input;
-
         // Attempt to acquire a source for the new audio to use
-        _AcquireSource();
+        _AcquireSource(false);
         if(_source == nullptr) {
             IF_PRINT_WARNING(AUDIO_DEBUG) << "could not acquire audio source for new audio file: " << filename << std::endl;
         }
@@ -282,6 +314,20 @@ bool AudioDescriptor::LoadAudio(const std::string &filename, AUDIO_LOAD load_typ
     return true;
 } // bool AudioDescriptor::LoadAudio(const string& file_name, AUDIO_LOAD load_type, uint32_t stream_buffer_size)
 
+uint32_t AudioDescriptor::GetMemorySize() const
+{
+    if(_input == nullptr)
+        return 0;
+
+    if(_stream == nullptr)
+        return _input->GetDataSize();
+
+    uint32_t size = NUMBER_STREAMING_BUFFERS * _stream_buffer_size * _input->GetSampleSize();
+    if(dynamic_cast<const AudioMemory *>(_input) != nullptr)
+        size += _input->GetDataSize();
+    return size;
+}
+
 void AudioDescriptor::FreeAudio()
 {
     // First, remove any effects.
@@ -293,10 +339,15 @@ void AudioDescriptor::FreeAudio()
     _state = AUDIO_STATE_UNLOADED;
     _offset = 0;
 
-    // If the source is still attached to a sound, reset to the default parameters the source
-    if(_source != nullptr) {
-        _source->Reset();
-        _source = nullptr;
+    // If the source is still attached to a sound, give it back to the audio engine
+    _ReleaseSource();
+
+    // The buffer and input of static audio belong to its shared buffer.
+    if(_shared_buffer != nullptr) {
+        _buffer = nullptr;
+        _input = nullptr;
+        AudioManager->_ReleaseSharedBuffer(_shared_buffer);
+        _shared_buffer = nullptr;
     }
 
     if(_buffer != nullptr) {
@@ -329,12 +380,16 @@ bool AudioDescriptor::Play()
         return true;
 
     if(!_source) {
-        _AcquireSource();
+        _AcquireSource(true);
         if(!_source) {
             IF_PRINT_WARNING(AUDIO_DEBUG) << "did not have access to valid AudioSource" << std::endl;
             return false;
         }
         _SetSourceProperties();
+
+        // The audio lost its source while paused: resume where it was.
+        if(_state == AUDIO_STATE_PAUSED && _stream == nullptr)
+            alSourcei(_source->source, AL_SAMPLE_OFFSET, _offset);
     }
 
     if(_stream && _stream->GetEndOfStream()) {
@@ -352,6 +407,7 @@ bool AudioDescriptor::Play()
         IF_PRINT_WARNING(AUDIO_DEBUG) << "playing the source failed: " << AudioManager->CreateALErrorString() << std::endl;
     }
     _state = AUDIO_STATE_PLAYING;
+    AudioManager->_ActivateAudioSource(_source);
     return true;
 }
 
@@ -627,32 +683,41 @@ void AudioDescriptor::FadeIn(float time)
     if (GetVolume() >= 1.0f)
         return;
 
+    // Stop right away when the effect is less than a usual cpu cycle
+    if(time <= 10.0f || !AudioManager->_effects.AddEffect(AUDIO_EFFECT_FADE_IN, this, GetVolume(), 1.0f,
+                                                          static_cast<uint32_t>(time))) {
+        RemoveEffects();
+        SetVolume(1.0f);
+        _state = AUDIO_STATE_PLAYING;
+        return;
+    }
+
     _state = AUDIO_STATE_FADE_IN;
-    _fade_effect_time = time;
 }
 
 void AudioDescriptor::FadeOut(float time)
 {
-    _original_volume = GetVolume();
+    float volume = GetVolume();
 
-    if (_original_volume <= 0.0f) {
+    if (volume <= 0.0f || time <= 10.0f
+            || !AudioManager->_effects.AddEffect(AUDIO_EFFECT_FADE_OUT, this, volume, 0.0f,
+                                                 static_cast<uint32_t>(time))) {
+        RemoveEffects();
         Stop();
+        SetVolume(0.0f);
         return;
     }
 
-    _fade_effect_time = time;
     _state = AUDIO_STATE_FADE_OUT;
+
+    // Makes sure the end of the audio is still detected while fading.
+    if(_source)
+        AudioManager->_ActivateAudioSource(_source);
 }
 
 void AudioDescriptor::RemoveEffects()
 {
-    // Delete any active audio effects for the given audio descriptor
-    for(std::vector<AudioEffect *>::iterator it = _audio_effects.begin();
-            it != _audio_effects.end(); ++it) {
-        if(*it)
-            delete(*it);
-    }
-    _audio_effects.clear();
+    AudioManager->_effects.RemoveEffect(this);
 }
 
 void AudioDescriptor::DEBUG_PrintInfo()
@@ -742,22 +807,6 @@ void AudioDescriptor::_Update()
         }
     }
 
-    // Handle the fade in/out states
-    _HandleFadeStates();
-
-    // Update all registered audio effects
-    for(std::vector<AudioEffect *>::iterator it = _audio_effects.begin(); it != _audio_effects.end();) {
-        (*it)->Update();
-
-        // If the effect is finished, delete it
-        if(!(*it)->active) {
-            delete(*it);
-            it = _audio_effects.erase(it);
-        } else {
-            ++it;
-        }
-    }
-
     // Only streaming audio that is being played requires periodic updates
     if(!_stream)
         return;
@@ -814,57 +863,7 @@ void AudioDescriptor::_Update()
 } // void AudioDescriptor::_Update()
 
 
-void AudioDescriptor::_HandleFadeStates()
-{
-    if (_state == AUDIO_STATE_FADE_OUT) {
-        // Hande when the effect time is very quick
-        if( _fade_effect_time <= 10.0f) {
-            Stop();
-            SetVolume(0.0f);
-            return;
-        }
-
-        float time_elapsed = (float)vt_system::SystemManager->GetUpdateTime();
-        float new_volume = GetVolume() - (_original_volume - (_original_volume - (time_elapsed / _fade_effect_time)));
-
-        // Stop the audio, and terminate the effect if the volume drops to 0.0f or below
-        if(new_volume <= 0.0f) {
-            Stop();
-            SetVolume(0.0f);
-            return;
-        }
-        // Otherwise, update the volume for the audio
-        else {
-            SetVolume(new_volume);
-            return;
-        }
-    }
-    else if (_state == AUDIO_STATE_FADE_IN) {
-        // Stop right away when the effect is less than a usual cpu cycle
-        if(_fade_effect_time <= 10.0f) {
-            SetVolume(1.0f);
-            _state = AUDIO_STATE_PLAYING;
-            return;
-        }
-
-        float time_elapsed = (float)vt_system::SystemManager->GetUpdateTime();
-        float new_volume = GetVolume() + (time_elapsed / _fade_effect_time);
-
-
-        // If the volume has reached the maximum, mark the effect as over
-        if(new_volume >= 1.0f) {
-            SetVolume(1.0f);
-            _state = AUDIO_STATE_PLAYING;
-            return;
-        }
-        // Otherwise, update the volume for the audio
-        else {
-            SetVolume(new_volume);
-        }
-    }
-}
-
-void AudioDescriptor::_AcquireSource()
+void AudioDescriptor::_AcquireSource(bool steal_playing_voices)
 {
     if(_source != nullptr) {
         IF_PRINT_WARNING(AUDIO_DEBUG) << "function was invoked when object already had a source acquired" << std::endl;
@@ -876,7 +875,7 @@ void AudioDescriptor::_AcquireSource()
         return;
     }
 
-    _source = AudioManager->_AcquireAudioSource();
+    _source = AudioManager->_AcquireAudioSource(_priority, steal_playing_voices);
     if(_source == nullptr) {
         IF_PRINT_WARNING(AUDIO_DEBUG) << "could not acquire audio source for new audio file: " << _input->GetFilename() << std::endl;
         return;
@@ -890,6 +889,26 @@ void AudioDescriptor::_AcquireSource()
         _PrepareStreamingBuffers();
 }
 
+void AudioDescriptor::_ReleaseSource()
+{
+    if(_source == nullptr)
+        return;
+
+    if(_state == AUDIO_STATE_PAUSED) {
+        // Keep the audio paused, and remember where to resume it once it gets a source again.
+        // Streamed audio simply goes on from its decoding position.
+        if(_stream == nullptr)
+            _offset = GetCurrentSampleNumber();
+        alSourceStop(_source->source);
+    }
+    else {
+        Stop();
+    }
+
+    AudioManager->_ReleaseAudioSource(_source);
+    _source = nullptr;
+}
+
 
 
 void AudioDescriptor::_SetSourceProperties()
@@ -904,7 +923,7 @@ void AudioDescriptor::_SetSourceProperties()
     if(IsSound())
         volume_multiplier = AudioManager->GetSoundVolume();
     else
-        volume_multiplier = AudioManager->GetMusicVolume();
+        volume_multiplier = AudioManager->GetMusicVolume() * AudioManager->GetMusicDucking();
 
     alSourcef(_source->source, AL_GAIN, _volume * volume_multiplier);
     if(AudioManager->CheckALError()) {
@@ -1030,6 +1049,7 @@ MusicDescriptor::MusicDescriptor() :
     AudioDescriptor()
 {
     _looping = true;
+    _priority = AUDIO_PRIORITY_MUSIC;
     AudioManager->_registered_music.push_back(this);
 }
 
@@ -1087,11 +1107,7 @@ void MusicDescriptor::SetVolume(float volume)
 {
     AudioDescriptor::_SetVolumeControl(volume);
 
-    float music_volume = _volume * AudioManager->GetMusicVolume();
-
-    if(_source) {
-        alSourcef(_source->source, AL_GAIN, (ALfloat)music_volume);
-    }
+    AudioManager->_ApplyMusicVolume(this);
 }
 
 } // namespace vt_audio
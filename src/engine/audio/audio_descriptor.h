@@ -74,6 +74,21 @@ enum AUDIO_LOAD {
     AUDIO_LOAD_STREAM_MEMORY  = 2
 };
 
+/** \brief The playback priority categories of audio descriptors
+*** When all the audio sources are in use, a voice of lower priority may be stolen
+*** to play an audio of higher priority. The higher the value, the higher the priority.
+**/
+enum AUDIO_PRIORITY {
+    //! \brief Environment sounds, such as the map sound objects
+    AUDIO_PRIORITY_AMBIENT    = 0,
+    //! \brief Gameplay sound effects, such as the battle ones. This is the default for sounds.
+    AUDIO_PRIORITY_SFX        = 1,
+    //! \brief Interface feedback sounds, such as the menu confirm and cancel ones
+    AUDIO_PRIORITY_UI         = 2,
+    //! \brief Music pieces. This is the default for music.
+    AUDIO_PRIORITY_MUSIC      = 3
+};
+
 //! \brief ALfloat per 3D OpenAL sound vectors (position, direction, velocity)
 const uint32_t ALFLOAT3D = 3;
 typedef ALfloat ALfloatArray[ALFLOAT3D];
@@ -81,7 +96,7 @@ typedef ALfloat ALfloatArray[ALFLOAT3D];
 namespace private_audio
 {
 
-class AudioEffect;
+class AudioEffectPool;
 
 //! \brief The default buffer size (in bytes) for streaming buffers
 const uint32_t DEFAULT_BUFFER_SIZE = 8192;
@@ -125,6 +140,53 @@ public:
 }; // class AudioBuffer
 
 
+/** ****************************************************************************
+*** \brief The OpenAL buffer of an audio file loaded statically
+***
+*** Every audio descriptor loading the same file statically uses the same
+*** shared buffer, so that the file is decoded and its data uploaded only once.
+*** Shared buffers are kept by the audio engine as long as they are referenced.
+***
+*** \note The buffer data is never modified once filled. An audio descriptor
+*** needing different data must load its own buffer instead.
+*** ***************************************************************************/
+class SharedAudioBuffer
+{
+public:
+    SharedAudioBuffer() :
+        input(nullptr),
+        format(AL_FORMAT_MONO16),
+        reference_count(0)
+    {}
+
+    ~SharedAudioBuffer() {
+        delete input;
+    }
+
+    /** \brief Decodes an audio file and fills the buffer with its data
+    *** \param filename The name of the audio file
+    *** \return False if the file could not be decoded
+    **/
+    bool Load(const std::string &filename);
+
+    //! \brief The input the data was read from, kept for the audio properties
+    AudioInput *input;
+
+    //! \brief The OpenAL buffer holding the whole audio data
+    AudioBuffer buffer;
+
+    //! \brief The format of the audio data (mono/stereo, 8/16 bits per sample)
+    ALenum format;
+
+    //! \brief The number of audio descriptors using this buffer
+    uint32_t reference_count;
+
+private:
+    SharedAudioBuffer(const SharedAudioBuffer &);
+    SharedAudioBuffer &operator=(const SharedAudioBuffer &);
+}; // class SharedAudioBuffer
+
+
 /** ****************************************************************************
 *** \brief Represents an OpenAL source
 ***
@@ -166,7 +228,7 @@ class AudioSource
 public:
     //! \param al_source A valid OpenAL source that has been generated
     explicit AudioSource(ALuint al_source) :
-        source(al_source), owner(nullptr) {}
+        source(al_source), owner(nullptr), active(false) {}
 
     ~AudioSource();
 
@@ -183,6 +245,9 @@ public:
 
     //! \brief Pointer to the descriptor associated to this source.
     AudioDescriptor *owner;
+
+    //! \brief Tells whether the source is in the audio engine list of voices updated every frame.
+    bool active;
 }; // class AudioSource
 
 } // namespace private_audio
@@ -206,6 +271,7 @@ public:
 class AudioDescriptor
 {
     friend class AudioEngine;
+    friend class private_audio::AudioEffectPool;
 
 public:
     AudioDescriptor();
@@ -230,6 +296,7 @@ public:
     /** \brief Frees all data resources and resets class parameters
     ***
     *** It resets the _state and _offset class members, as well as deleting _data, _stream, _input, _buffer, and resets _source.
+    *** A statically loaded audio gives its shared buffer back to the audio engine instead.
     **/
     void FreeAudio();
 
@@ -241,6 +308,12 @@ public:
     //! \brief Returns true if this audio represents a sound, false if the audio represents a music piece
     virtual bool IsSound() const = 0;
 
+    /** \brief Returns the number of bytes of decoded audio data held by this audio
+    *** Static audio holds all its samples, while streamed audio only holds its streaming buffers,
+    *** plus the whole data when streamed from memory.
+    **/
+    uint32_t GetMemorySize() const;
+
     //! \brief Returns the state of the audio.
     AUDIO_STATE GetState() {
         return _state;
@@ -310,6 +383,18 @@ public:
     **/
     virtual void SetVolume(float volume) = 0;
 
+    AUDIO_PRIORITY GetPriority() const {
+        return _priority;
+    }
+
+    /** \brief Sets the priority used when audio sources are lacking
+    *** \param priority The priority category of this audio
+    *** A playing audio may have its source stolen by an audio of higher priority.
+    **/
+    void SetPriority(AUDIO_PRIORITY priority) {
+        _priority = priority;
+    }
+
     /** \name Functions for 3D Spatial Audio
     *** These functions manipulate and retrieve the 3d properties of the audio. Note that only audio which
     *** are mono channel will be affected by these methods. Stereo channel audio will see no difference.
@@ -360,21 +445,22 @@ public:
     }
 
     /** \brief Fades a music or sound in as it plays
-    *** \param audio A reference to the music or sound to fade in
-    *** \param time The amount of time that the fade should last for, in seconds
+    *** \param time The amount of time that the fade should last for, in milliseconds
+    *** The volume is raised from its current level up to 1.0f by the audio engine effects.
     **/
     void FadeIn(float time);
 
-    /** \brief Fades a music or sound out as it finisheds
-    *** \param audio A referenece to the music or sound to fade out
-    *** \param time The amount of time that the fade should last for, in seconds
+    /** \brief Fades a music or sound out, and stops it
+    *** \param time The amount of time that the fade should last for, in milliseconds
     **/
     void FadeOut(float time);
 
     //! Tells whether the audio descriptor is fading out.
-    bool IsFadingOut();
+    bool IsFadingOut() const {
+        return _state == AUDIO_STATE_FADE_OUT;
+    }
 
-    //! \brief Remove effects.
+    //! \brief Stops the fade of the audio, if any, leaving its volume as it is.
     void RemoveEffects();
 
     //! \brief Prints various properties about the audio data managed by this class
@@ -387,6 +473,11 @@ protected:
     //! \brief A pointer to the buffer(s) being used by the audio (1 buffer for static sounds, 2 for streamed ones)
     private_audio::AudioBuffer *_buffer;
 
+    /** \brief The shared buffer of the audio when loaded statically, nullptr otherwise
+    *** The _buffer and _input members then point to the shared buffer members, and aren't owned by the audio.
+    **/
+    private_audio::SharedAudioBuffer *_shared_buffer;
+
     //! \brief A pointer to the source object being used by the audio
     private_audio::AudioSource *_source;
 
@@ -417,15 +508,12 @@ protected:
     **/
     float _volume;
 
-    //! \brief Keeps in memory the fade out or in time.
-    float _fade_effect_time;
-
-    //! \brief The volume of the audio when the fade effect was registered
-    float _original_volume;
-
     //! \brief Size of the streaming buffer, if the audio was loaded for streaming
     uint32_t _stream_buffer_size;
 
+    //! \brief The priority of the audio when sources are lacking
+    AUDIO_PRIORITY _priority;
+
     //! \brief The 3D orientation properties of the audio
     //@{
     ALfloat _position[ALFLOAT3D];
@@ -442,9 +530,6 @@ protected:
     **/
     std::vector<vt_mode_manager::GameMode *> _game_mode_owners;
 
-    //! \brief Holds all active audio effects for this descriptor
-    std::vector<private_audio::AudioEffect *> _audio_effects;
-
     /** \brief Sets the local volume control for this particular audio piece
     *** \param volume The volume level to set, ranging from [0.0f, 1.0f]
     *** This should be thought of as a helper function to the SetVolume methods
@@ -460,15 +545,24 @@ private:
     **/
     void _Update();
 
-    //! \brief Handles the fading states volumes update.
-    void _HandleFadeStates();
-
     /** \brief Acquires an audio source for playback
+    *** \param steal_playing_voices Whether a playing audio of lower priority may lose its source to this one.
     *** This function is called whenever an audio piece is loaded and whenever the Play operation is specified on
     *** the audio, but the audio currently does not have a source. It is not guaranteed that the source acquisition
-    *** will be successful, as all other sources may be occupied by other audio.
+    *** will be successful, as all other sources may be occupied by other audio of higher priority.
     **/
-    void _AcquireSource();
+    void _AcquireSource(bool steal_playing_voices);
+
+    /** \brief Stops the audio and gives its source back to the audio engine
+    *** The source will be acquired again the next time the audio is played.
+    *** Paused audio stays paused, and keeps its playback position in _offset.
+    **/
+    void _ReleaseSource();
+
+    //! \brief Tells whether the audio is playing or fading, and thus must be updated every frame.
+    bool _IsActive() const {
+        return (_state == AUDIO_STATE_PLAYING || _state == AUDIO_STATE_FADE_IN || _state == AUDIO_STATE_FADE_OUT);
+    }
 
     /** \brief Sets all of the relevant properties for the OpenAL source
     *** This function should be called whenever a new source is allocated for the audio to use.
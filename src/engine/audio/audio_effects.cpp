@@ -17,7 +17,11 @@
 
 #include "audio_effects.h"
 
-#include "engine/system.h"
+#include "audio.h"
+
+#include "utils/utils_common.h"
+
+#include <SDL2/SDL_timer.h>
 
 namespace vt_audio
 {
@@ -25,7 +29,99 @@ namespace vt_audio
 namespace private_audio
 {
 
-// NOTE: No audio effects have been created so far.
+float AudioEffect::GetVolume(uint32_t time) const
+{
+    if(IsFinished(time))
+        return end_volume;
+
+    float progress = static_cast<float>(time - start_time) / static_cast<float>(duration);
+    return start_volume + (end_volume - start_volume) * progress;
+}
+
+bool AudioEffectPool::AddEffect(AUDIO_EFFECT effect_type, AudioDescriptor *audio,
+                                float start_volume, float end_volume, uint32_t duration)
+{
+    uint32_t index = _FindEffect(audio);
+    if(index == _effect_count) {
+        if(_effect_count == AUDIO_EFFECT_POOL_SIZE) {
+            IF_PRINT_WARNING(AUDIO_DEBUG) << "no audio effect left, the effect is skipped" << std::endl;
+            return false;
+        }
+        ++_effect_count;
+    }
+
+    AudioEffect &effect = _effects[index];
+    effect.effect_type = effect_type;
+    effect.audio = audio;
+    effect.start_volume = start_volume;
+    effect.end_volume = end_volume;
+    effect.start_time = SDL_GetTicks();
+    effect.duration = duration;
+    return true;
+}
+
+void AudioEffectPool::RemoveEffect(const AudioDescriptor *audio)
+{
+    uint32_t index = _FindEffect(audio);
+    if(index < _effect_count)
+        _RemoveEffect(index);
+}
+
+void AudioEffectPool::Update()
+{
+    uint32_t time = SDL_GetTicks();
+
+    for(uint32_t i = 0; i < _effect_count;) {
+        const AudioEffect &effect = _effects[i];
+        bool finished = effect.IsFinished(time);
+        float volume = effect.GetVolume(time);
+        AudioDescriptor *audio = effect.audio;
+
+        switch(effect.effect_type) {
+        case AUDIO_EFFECT_FADE_IN:
+            // The fade ends as well when the audio was stopped, paused or played again meanwhile.
+            if(audio->_state != AUDIO_STATE_FADE_IN) {
+                finished = true;
+                break;
+            }
+
+            audio->SetVolume(volume);
+            if(finished)
+                audio->_state = AUDIO_STATE_PLAYING;
+            break;
+        case AUDIO_EFFECT_FADE_OUT:
+            if(audio->_state != AUDIO_STATE_FADE_OUT) {
+                finished = true;
+                break;
+            }
+
+            audio->SetVolume(volume);
+            if(finished)
+                audio->Stop();
+            break;
+        case AUDIO_EFFECT_MUSIC_DUCKING:
+            AudioManager->_SetMusicDucking(volume);
+            break;
+        default:
+            finished = true;
+            break;
+        }
+
+        if(finished)
+            _RemoveEffect(i);
+        else
+            ++i;
+    }
+}
+
+uint32_t AudioEffectPool::_FindEffect(const AudioDescriptor *audio) const
+{
+    for(uint32_t i = 0; i < _effect_count; ++i) {
+        if(_effects[i].audio == audio)
+            return i;
+    }
+    return _effect_count;
+}
 
 } // namespace private_audio
 
@@ -29,45 +29,122 @@ namespace vt_audio
 class AudioDescriptor;
 
 enum AUDIO_EFFECT {
-    AUDIO_EFFECT_NONE = 0
+    AUDIO_EFFECT_NONE = 0,
+    //! \brief Ramps the volume of an audio up, then sets it back to the playing state.
+    AUDIO_EFFECT_FADE_IN = 1,
+    //! \brief Ramps the volume of an audio down, then stops it.
+    AUDIO_EFFECT_FADE_OUT = 2,
+    //! \brief Ramps the volume of all the music, e.g. to lower it under dialogues.
+    AUDIO_EFFECT_MUSIC_DUCKING = 3
 };
 
 namespace private_audio
 {
 
+//! \brief The maximum number of audio effects running at the same time
+const uint32_t AUDIO_EFFECT_POOL_SIZE = 64;
+
 /** ****************************************************************************
-*** \brief An abstract base class for all audio effects to be derived from
+*** \brief A volume ramp applied by the audio effect pool
 ***
-*** The purpose of this class is nothing more than to provide a simple common
-*** interface for all audio effects, primarily so that they may be stored in
-*** the same container. Most effects will only operate upon a single piece of
-*** audio, but some effects may operate across multiple audio descriptors.
+*** The volume is computed from the time elapsed since the start of the effect,
+*** and not accumulated frame after frame, so that the ramp lasts exactly its
+*** duration whatever the frame rate, and ends exactly at its target volume.
 *** ***************************************************************************/
 class AudioEffect
 {
 public:
     AudioEffect() :
-        active(true),
-        effect_type(AUDIO_EFFECT_NONE)
-        {}
-
-    virtual ~AudioEffect()
+        effect_type(AUDIO_EFFECT_NONE),
+        audio(nullptr),
+        start_volume(0.0f),
+        end_volume(0.0f),
+        start_time(0),
+        duration(0)
     {}
 
-    //! \brief Set to true while an effect is active, and set to false when the effect is finished
-    bool active;
+    //! \brief Returns the volume of the ramp at the given time, in milliseconds.
+    float GetVolume(uint32_t time) const;
 
-    //! \brief Updates the effect and sets the active member to false when the effect is finished
-    virtual void Update() = 0;
-
-    //! \brief Get the audio descriptor concerned by the effect.
-    virtual AudioDescriptor &GetAudioDescriptor() const = 0;
+    //! \brief Tells whether the ramp is over at the given time, in milliseconds.
+    bool IsFinished(uint32_t time) const {
+        return time - start_time >= duration;
+    }
 
     //! The audio effect type
     AUDIO_EFFECT effect_type;
+
+    //! \brief The audio concerned by the effect, or nullptr for the music ducking.
+    AudioDescriptor *audio;
+
+    //! \brief The volume at the start and at the end of the ramp
+    //@{
+    float start_volume;
+    float end_volume;
+    //@}
+
+    //! \brief The time the ramp started at, and its duration, in milliseconds
+    //@{
+    uint32_t start_time;
+    uint32_t duration;
+    //@}
 }; // class AudioEffect
 
-// NOTE: No actual effect is existing for now.
+/** ****************************************************************************
+*** \brief Holds and updates all the audio effects
+***
+*** The effects are stored contiguously in a fixed size array, and all of them
+*** are updated in a single pass by the audio engine, every frame. An audio has
+*** at most one effect, a new one replacing the previous one.
+*** ***************************************************************************/
+class AudioEffectPool
+{
+public:
+    AudioEffectPool() :
+        _effect_count(0)
+    {}
+
+    /** \brief Starts a volume ramp
+    *** \param effect_type The type of effect
+    *** \param audio The audio concerned, or nullptr for the music ducking
+    *** \param start_volume The volume at the start of the ramp
+    *** \param end_volume The volume at the end of the ramp
+    *** \param duration The duration of the ramp, in milliseconds
+    *** \return False if the pool is full, in which case the effect is not started.
+    **/
+    bool AddEffect(AUDIO_EFFECT effect_type, AudioDescriptor *audio,
+                   float start_volume, float end_volume, uint32_t duration);
+
+    //! \brief Stops the effect of the given audio, if any, leaving its volume as it is.
+    void RemoveEffect(const AudioDescriptor *audio);
+
+    //! \brief Stops all the effects.
+    void Clear() {
+        _effect_count = 0;
+    }
+
+    //! \brief Applies the volume of every effect, and removes the finished and interrupted ones.
+    void Update();
+
+    uint32_t GetEffectCount() const {
+        return _effect_count;
+    }
+
+private:
+    //! \brief The running effects, from 0 to _effect_count - 1.
+    AudioEffect _effects[AUDIO_EFFECT_POOL_SIZE];
+
+    //! \brief The number of running effects
+    uint32_t _effect_count;
+
+    //! \brief Returns the index of the effect of the given audio, or _effect_count if it has none.
+    uint32_t _FindEffect(const AudioDescriptor *audio) const;
+
+    //! \brief Removes an effect by moving the last one in its place.
+    void _RemoveEffect(uint32_t index) {
+        _effects[index] = _effects[--_effect_count];
+    }
+}; // class AudioEffectPool
 
 } // namespace private_audio
 
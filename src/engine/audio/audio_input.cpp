@@ -381,7 +381,6 @@ int OggFile::_FileSeekWrapper(FILE *file, ogg_int64_t off, int whence)
 
 AudioMemory::AudioMemory(AudioInput *input) :
     AudioInput(),
-    _audio_data(nullptr),
     _data_position(0)
 {
     _filename = input->GetFilename();
@@ -393,9 +392,11 @@ AudioMemory::AudioMemory(AudioInput *input) :
     _play_time = input->GetPlayTime();
     _data_size = input->GetDataSize();
 
-    _audio_data = new uint8_t[input->GetDataSize()];
+    std::vector<uint8_t>* audio_data = new std::vector<uint8_t>(input->GetDataSize());
     bool all_data_read = false;
-    input->Read(_audio_data, input->GetTotalNumberSamples(), all_data_read);
+    if(!audio_data->empty())
+        input->Read(&(*audio_data)[0], input->GetTotalNumberSamples(), all_data_read);
+    _audio_data.reset(audio_data);
     if(all_data_read == false) {
         IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to read entire audio data stream for file: " << _filename << std::endl;
     }
@@ -403,7 +404,7 @@ AudioMemory::AudioMemory(AudioInput *input) :
 
 AudioMemory::AudioMemory(const AudioMemory &audio_memory) :
     AudioInput(),
-    _audio_data(nullptr),
+    _audio_data(audio_memory._audio_data),
     _data_position(0)
 {
     _filename = audio_memory._filename;
@@ -414,9 +415,6 @@ AudioMemory::AudioMemory(const AudioMemory &audio_memory) :
     _sample_size = audio_memory.GetSampleSize();
     _play_time = audio_memory.GetPlayTime();
     _data_size = audio_memory.GetDataSize();
-
-    _audio_data = new uint8_t[_data_size];
-    memcpy(_audio_data, audio_memory._audio_data, _data_size);
 }
 
 AudioMemory &AudioMemory::operator=(const AudioMemory &audio_memory)
@@ -424,10 +422,6 @@ AudioMemory &AudioMemory::operator=(const AudioMemory &audio_memory)
     if(this == &audio_memory)  // Handle self-assignment case
         return *this;
 
-    if(_audio_data != nullptr) {
-        delete[] _audio_data;
-        _audio_data = nullptr;
-    }
     _filename = audio_memory._filename;
     _samples_per_second = audio_memory.GetSamplesPerSecond();
     _bits_per_sample = audio_memory.GetBitsPerSample();
@@ -438,22 +432,12 @@ AudioMemory &AudioMemory::operator=(const AudioMemory &audio_memory)
     _data_size = audio_memory.GetDataSize();
 
     _data_position = audio_memory._data_position;
-    _audio_data = new uint8_t[_data_size];
-    memcpy(_audio_data, audio_memory._audio_data, _data_size);
+    _audio_data = audio_memory._audio_data;
 
     return *this;
 }
 
 
-AudioMemory::~AudioMemory()
-{
-    if(_audio_data != nullptr) {
-        delete[] _audio_data;
-        _audio_data = nullptr;
-    }
-}
-
-
 
 void AudioMemory::Seek(uint32_t sample_position)
 {
@@ -474,7 +458,8 @@ uint32_t AudioMemory::Read(uint8_t *buffer, uint32_t size, bool &end)
     uint32_t read = (_total_number_samples - _data_position >= size) ? size : (_total_number_samples - _data_position);
 
     // Copy the data in the buffer and move the read cursor
-    memcpy(buffer, buffer + _data_position * _sample_size, read * _sample_size);
+    if(read > 0)
+        memcpy(buffer, &(*_audio_data)[_data_position * _sample_size], read * _sample_size);
     _data_position += read;
     end = (_data_position == _total_number_samples);
 
@@ -29,6 +29,8 @@
 #include <vorbis/vorbisfile.h>
 
 #include <fstream>
+#include <memory>
+#include <vector>
 
 namespace vt_audio
 {
@@ -244,6 +246,10 @@ private:
 *** stored, and then operates off of that data. This is useful for efficient
 *** streaming operations so that I/O files containing the data do not need to
 *** be continually accessed.
+***
+*** Copies of an audio memory share the same samples, each having its own read
+*** position. The samples are never modified once read: a copy that needs to
+*** change them must take its own samples first.
 *** ***************************************************************************/
 class AudioMemory : public AudioInput
 {
@@ -258,8 +264,6 @@ public:
     explicit AudioMemory(const AudioMemory& audio_memory);
     AudioMemory &operator=(const AudioMemory &other_audio_memory);
 
-    ~AudioMemory();
-
     //! \brief Inherited functions from AudioInput class
     //@{
     //! \note Audio memory does not need to be initialized, as that is done in the class constructor
@@ -273,8 +277,8 @@ public:
     //@}
 
 private:
-    //! \brief The memory location where all the audio is stored
-    uint8_t *_audio_data;
+    //! \brief The memory location where all the audio is stored, shared by the copies
+    std::shared_ptr<const std::vector<uint8_t> > _audio_data;
 
     //! \brief Position in the data where the next read operation will be performed
     uint32_t _data_position;
@@ -56,6 +56,11 @@ void BindEngineCode()
             .def("FadeOutActiveMusic", &AudioEngine::FadeOutActiveMusic)
             .def("FadeInActiveMusic", &AudioEngine::FadeInActiveMusic)
             .def("FadeOutAllSounds", &AudioEngine::FadeOutAllSounds)
+            .def("DuckMusic", (void(AudioEngine::*)(float, float)) &AudioEngine::DuckMusic)
+            .def("DuckMusic", (void(AudioEngine::*)(float)) &AudioEngine::DuckMusic)
+            .def("DuckMusic", (void(AudioEngine::*)(void)) &AudioEngine::DuckMusic)
+            .def("UnduckMusic", (void(AudioEngine::*)(float)) &AudioEngine::UnduckMusic)
+            .def("UnduckMusic", (void(AudioEngine::*)(void)) &AudioEngine::UnduckMusic)
         ];
 
     } // End using audio namespaces
@@ -99,6 +104,7 @@ void BindEngineCode()
             .def("CreateText", (vt_video::TextImage*(ScriptSupervisor:: *)(const std::string&, const vt_video::TextStyle&))&ScriptSupervisor::CreateText)
             .def("CreateText", (vt_video::TextImage*(ScriptSupervisor:: *)(const vt_utils::ustring&, const vt_video::TextStyle&))&ScriptSupervisor::CreateText)
             .def("SetDrawFlag", &ScriptSupervisor::SetDrawFlag)
+            .def("SetUpdateBudget", &ScriptSupervisor::SetUpdateBudget)
         ];
 
         luabind::module(vt_script::ScriptManager->GetGlobalState(), "vt_mode_manager")
@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2012-2016 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    frame_allocator.cpp
+*** \author  Yohann Ferreira, yohann ferreira orange fr
+*** \brief   Source file for the per-frame memory allocator.
+*** ***************************************************************************/
+
+#include "engine/frame_allocator.h"
+
+#include "engine/system.h"
+
+#include <cassert>
+
+namespace vt_system
+{
+
+FrameAllocator::FrameAllocator():
+    _current_block(0),
+    _offset(0),
+    _allocations(0),
+    _bytes(0),
+    _last_frame_allocations(0),
+    _last_frame_bytes(0)
+{
+}
+
+FrameAllocator::~FrameAllocator()
+{
+    for(uint32_t i = 0; i < _blocks.size(); ++i)
+        delete[] _blocks[i].data;
+    _blocks.clear();
+}
+
+void* FrameAllocator::Allocate(size_t size, size_t alignment)
+{
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    ++_allocations;
+    _bytes += size;
+
+    // Look for room in the current block, then in the next ones.
+    while(_current_block < _blocks.size()) {
+        Block& block = _blocks[_current_block];
+        uintptr_t address = reinterpret_cast<uintptr_t>(block.data) + _offset;
+        uintptr_t aligned = (address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        size_t aligned_offset = _offset + (aligned - address);
+
+        if(aligned_offset + size <= block.size) {
+            _offset = aligned_offset + size;
+            return block.data + aligned_offset;
+        }
+
+        ++_current_block;
+        _offset = 0;
+    }
+
+    // No block is big enough: add one, which will be reused in the next frames.
+    Block block;
+    block.size = size + alignment > FRAME_ALLOCATOR_BLOCK_SIZE ? size + alignment : FRAME_ALLOCATOR_BLOCK_SIZE;
+    block.data = new uint8_t[block.size];
+    _blocks.push_back(block);
+    _current_block = _blocks.size() - 1;
+
+    uintptr_t address = reinterpret_cast<uintptr_t>(block.data);
+    uintptr_t aligned = (address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    _offset = (aligned - address) + size;
+    return block.data + (aligned - address);
+}
+
+void FrameAllocator::Reset()
+{
+    _last_frame_allocations = _allocations;
+    _last_frame_bytes = _bytes;
+    _allocations = 0;
+    _bytes = 0;
+
+    _current_block = 0;
+    _offset = 0;
+}
+
+void* AllocateFrameMemory(size_t size, size_t alignment)
+{
+    return SystemManager->GetFrameAllocator().Allocate(size, alignment);
+}
+
+} // namespace vt_system
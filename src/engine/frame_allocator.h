@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2012-2016 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    frame_allocator.h
+*** \author  Yohann Ferreira, yohann ferreira orange fr
+*** \brief   Header file for the per-frame memory allocator.
+***
+*** Many update functions need short lived containers, which used to hit the
+*** heap every frame. The frame allocator hands out memory from big blocks by
+*** simply moving an offset forward, and forgets everything at once when a new
+*** frame begins.
+***
+*** \note The memory is only valid until the end of the current frame: never
+*** keep a frame container beyond the function that created it. It must also
+*** only be used from the main thread.
+*** ***************************************************************************/
+
+#ifndef __FRAME_ALLOCATOR_HEADER__
+#define __FRAME_ALLOCATOR_HEADER__
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace vt_system
+{
+
+//! \brief The default size of the frame allocator memory blocks, in bytes.
+const size_t FRAME_ALLOCATOR_BLOCK_SIZE = 64 * 1024;
+
+/** ****************************************************************************
+*** \brief A linear allocator whose memory is released all at once every frame.
+***
+*** The blocks are kept between frames, so that once the game has reached its
+*** usual memory need, no heap allocation is done anymore.
+*** ***************************************************************************/
+class FrameAllocator
+{
+public:
+    FrameAllocator();
+
+    ~FrameAllocator();
+
+    /** \brief Returns memory valid until the next call to Reset().
+    *** \param size The number of bytes needed.
+    *** \param alignment The alignment needed, which must be a power of two.
+    **/
+    void* Allocate(size_t size, size_t alignment);
+
+    //! \brief Forgets all the allocations and stores the statistics of the frame that ended.
+    void Reset();
+
+    //! \brief Returns the number of allocations done during the last frame.
+    uint32_t GetLastFrameAllocations() const {
+        return _last_frame_allocations;
+    }
+
+    //! \brief Returns the number of bytes allocated during the last frame.
+    size_t GetLastFrameBytes() const {
+        return _last_frame_bytes;
+    }
+
+private:
+    //! \brief A chunk of heap memory the allocations are taken from.
+    struct Block {
+        uint8_t* data;
+        size_t size;
+    };
+
+    //! \brief The blocks, kept from one frame to the next.
+    std::vector<Block> _blocks;
+
+    //! \brief The block currently allocated from, and the offset of its first free byte.
+    size_t _current_block;
+    size_t _offset;
+
+    //! \brief The statistics of the current frame.
+    uint32_t _allocations;
+    size_t _bytes;
+
+    //! \brief The statistics of the last frame, shown in the debug display.
+    uint32_t _last_frame_allocations;
+    size_t _last_frame_bytes;
+
+    FrameAllocator(const FrameAllocator&) = delete;
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+};
+
+//! \brief Allocates memory from the system engine frame allocator.
+void* AllocateFrameMemory(size_t size, size_t alignment);
+
+/** ****************************************************************************
+*** \brief A standard library allocator taking its memory from the frame allocator.
+***
+*** Deallocation does nothing: the memory is given back when the frame ends.
+*** ***************************************************************************/
+template <typename T>
+class FrameStlAllocator
+{
+public:
+    typedef T value_type;
+
+    FrameStlAllocator() {}
+
+    template <typename U>
+    FrameStlAllocator(const FrameStlAllocator<U>&) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(AllocateFrameMemory(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) {}
+};
+
+template <typename T, typename U>
+bool operator==(const FrameStlAllocator<T>&, const FrameStlAllocator<U>&)
+{
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const FrameStlAllocator<T>&, const FrameStlAllocator<U>&)
+{
+    return false;
+}
+
+//! \brief The containers to use for temporary data in update functions.
+template <typename T>
+using FrameVector = std::vector<T, FrameStlAllocator<T> >;
+
+template <typename T>
+using FrameDeque = std::deque<T, FrameStlAllocator<T> >;
+
+} // namespace vt_system
+
+#endif // __FRAME_ALLOCATOR_HEADER__
@@ -26,6 +26,8 @@
 #include "utils/utils_random.h"
 #include "utils/utils_strings.h"
 
+#include <algorithm>
+
 using namespace vt_video;
 
 namespace vt_mode_manager
@@ -70,6 +72,20 @@ void IndicatorElement::Start()
     _force.y = INITIAL_FORCE;
 }
 
+void IndicatorElement::Reset(float x_position, float y_position, INDICATOR_TYPE indicator_type)
+{
+    _timer.Initialize(INDICATOR_TIME);
+    _alpha_color.SetAlpha(0.0f);
+    _force.x = 0.0f;
+    _force.y = INITIAL_FORCE;
+    _origin_position.x = x_position;
+    _origin_position.y = y_position;
+    _relative_position.x = 0.0f;
+    _relative_position.y = 0.0f;
+    _use_parallax = false;
+    _indicator_type = indicator_type;
+}
+
 void IndicatorElement::Update()
 {
     _timer.Update();
@@ -179,6 +195,74 @@ void IndicatorText::Draw()
     _text_image.Draw(_alpha_color);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// IndicatorDigitAtlas class
+////////////////////////////////////////////////////////////////////////////////
+
+IndicatorDigitAtlas::IndicatorDigitAtlas(const vt_video::TextStyle& style) :
+    _style(style)
+{
+    for (uint32_t i = 0; i < 10; ++i)
+        _digits[i].SetText(std::string(1, static_cast<char>('0' + i)), style);
+}
+
+bool IndicatorDigitAtlas::HasStyle(const vt_video::TextStyle& style) const
+{
+    return _style.GetFontName() == style.GetFontName() &&
+           _style.GetColor() == style.GetColor() &&
+           _style.GetShadowStyle() == style.GetShadowStyle() &&
+           _style.GetShadowOffsetX() == style.GetShadowOffsetX() &&
+           _style.GetShadowOffsetY() == style.GetShadowOffsetY();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// IndicatorNumber class
+////////////////////////////////////////////////////////////////////////////////
+
+IndicatorNumber::IndicatorNumber() :
+    IndicatorElement(0.0f, 0.0f, DAMAGE_INDICATOR),
+    _atlas(nullptr),
+    _digit_count(0),
+    _width(0.0f)
+{
+}
+
+void IndicatorNumber::SetNumber(uint32_t amount, const IndicatorDigitAtlas* atlas)
+{
+    _atlas = atlas;
+    _width = 0.0f;
+
+    // Store the digits from the least significant one, then reverse them.
+    _digit_count = 0;
+    do {
+        _digits[_digit_count++] = static_cast<uint8_t>(amount % 10);
+        amount /= 10;
+    } while (amount > 0);
+    std::reverse(_digits, _digits + _digit_count);
+
+    if (!_atlas)
+        return;
+    for (uint32_t i = 0; i < _digit_count; ++i)
+        _width += _atlas->GetDigit(_digits[i]).GetWidth();
+}
+
+void IndicatorNumber::Draw()
+{
+    if (!_atlas)
+        return;
+
+    VideoManager->SetDrawFlags(VIDEO_X_LEFT, VIDEO_Y_BOTTOM, VIDEO_BLEND, 0);
+    VideoManager->Move(
+        _origin_position.x + _relative_position.x - _width / 2,
+        _origin_position.y - _relative_position.y);
+
+    for (uint32_t i = 0; i < _digit_count; ++i) {
+        const TextImage& digit = _atlas->GetDigit(_digits[i]);
+        digit.Draw(_alpha_color);
+        VideoManager->MoveRelative(digit.GetWidth(), 0.0f);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // IndicatorImage class
 ////////////////////////////////////////////////////////////////////////////////
@@ -293,6 +377,15 @@ IndicatorSupervisor::~IndicatorSupervisor()
     for(uint32_t i = 0; i < _active_queue.size(); ++i)
         delete _active_queue[i];
     _active_queue.clear();
+    _occupied_origins.clear();
+
+    for(uint32_t i = 0; i < _number_pool.size(); ++i)
+        delete _number_pool[i];
+    _number_pool.clear();
+
+    for(uint32_t i = 0; i < _digit_atlases.size(); ++i)
+        delete _digit_atlases[i];
+    _digit_atlases.clear();
 
     for(uint32_t i = 0; i < _short_notices.size(); ++i)
         delete _short_notices[i];
@@ -313,8 +406,15 @@ void IndicatorSupervisor::Update()
     // Remove all expired elements from the active queue
     while(_active_queue.empty() == false) {
         if(_active_queue.front()->IsExpired()) {
-            delete _active_queue.front();
+            IndicatorElement* element = _active_queue.front();
             _active_queue.pop_front();
+
+            std::map<std::pair<float, float>, uint32_t>::iterator it =
+                _occupied_origins.find(std::make_pair(element->GetXOrigin(), element->GetYOrigin()));
+            if (it != _occupied_origins.end() && --it->second == 0)
+                _occupied_origins.erase(it);
+
+            _ReleaseElement(element);
         } else {
             // If the front element is not expired, no other elements should be expired either
             break;
@@ -329,7 +429,9 @@ void IndicatorSupervisor::Update()
         while(_FixPotentialIndicatorOverlapping(_wait_queue.front()))
             {}
 
-        _active_queue.push_back(_wait_queue.front());
+        IndicatorElement* element = _wait_queue.front();
+        ++_occupied_origins[std::make_pair(element->GetXOrigin(), element->GetYOrigin())];
+        _active_queue.push_back(element);
         _wait_queue.pop_front();
         must_sort = true;
     }
@@ -361,20 +463,9 @@ bool IndicatorSupervisor::_FixPotentialIndicatorOverlapping(IndicatorElement* el
     if(!element)
         return false; // No overlapping
 
-    IndicatorElement *overlapped_element = 0;
-
-    // Get potential overlapped indicators
-    for(std::deque<IndicatorElement *>::iterator it = _active_queue.begin(),
-            it_end = _active_queue.end(); it != it_end; ++it) {
-        if((*it)->GetXOrigin() == element->GetXOrigin() &&
-                (*it)->GetYOrigin() == element->GetYOrigin() &&
-                (*it) != element) {
-            overlapped_element = *it;
-            break;
-        }
-    }
-
-    if(!overlapped_element)
+    // The element isn't active yet, so any active element at its origin overlaps it.
+    if(_occupied_origins.find(std::make_pair(element->GetXOrigin(), element->GetYOrigin()))
+            == _occupied_origins.end())
         return false; // No overlapping
 
     // Move the next indicator a bit depending on its type
@@ -391,6 +482,54 @@ bool IndicatorSupervisor::_FixPotentialIndicatorOverlapping(IndicatorElement* el
     return true;
 }
 
+const IndicatorDigitAtlas* IndicatorSupervisor::_GetDigitAtlas(const TextStyle& style)
+{
+    for(uint32_t i = 0; i < _digit_atlases.size(); ++i) {
+        if(_digit_atlases[i]->HasStyle(style))
+            return _digit_atlases[i];
+    }
+
+    IndicatorDigitAtlas* atlas = new IndicatorDigitAtlas(style);
+    _digit_atlases.push_back(atlas);
+    return atlas;
+}
+
+IndicatorNumber* IndicatorSupervisor::_AcquireNumberIndicator(float x_position, float y_position,
+                                                              uint32_t amount, const TextStyle& style,
+                                                              INDICATOR_TYPE indicator_type)
+{
+    IndicatorNumber* indicator = nullptr;
+    if(_number_pool.empty()) {
+        indicator = new IndicatorNumber();
+    }
+    else {
+        indicator = _number_pool.back();
+        _number_pool.pop_back();
+    }
+
+    indicator->Reset(x_position, y_position, indicator_type);
+    indicator->SetNumber(amount, _GetDigitAtlas(style));
+    return indicator;
+}
+
+void IndicatorSupervisor::_ReleaseElement(IndicatorElement* element)
+{
+    IndicatorNumber* number = dynamic_cast<IndicatorNumber*>(element);
+    if(number)
+        _number_pool.push_back(number);
+    else
+        delete element;
+}
+
+void IndicatorSupervisor::_RebuildOccupiedOrigins()
+{
+    _occupied_origins.clear();
+    for(uint32_t i = 0; i < _active_queue.size(); ++i) {
+        IndicatorElement* element = _active_queue[i];
+        ++_occupied_origins[std::make_pair(element->GetXOrigin(), element->GetYOrigin())];
+    }
+}
+
 void IndicatorSupervisor::Draw()
 {
     for(uint32_t i = 0; i < _active_queue.size(); i++)
@@ -407,9 +546,7 @@ void IndicatorSupervisor::AddDamageIndicator(float x_position, float y_position,
     if (amount == 0)
         return;
 
-    std::string text = vt_utils::NumberToString(amount);
-
-    IndicatorText* indicator = new IndicatorText(x_position, y_position, text, style, DAMAGE_INDICATOR);
+    IndicatorNumber* indicator = _AcquireNumberIndicator(x_position, y_position, amount, style, DAMAGE_INDICATOR);
     indicator->SetUseParallax(use_parallax);
 
     _wait_queue.push_back(indicator);
@@ -423,9 +560,7 @@ void IndicatorSupervisor::AddHealingIndicator(float x_position, float y_position
     if(amount == 0)
         return;
 
-    std::string text = vt_utils::NumberToString(amount);
-
-    IndicatorText* indicator = new IndicatorText(x_position, y_position, text, style, HEALING_INDICATOR);
+    IndicatorNumber* indicator = _AcquireNumberIndicator(x_position, y_position, amount, style, HEALING_INDICATOR);
     indicator->SetUseParallax(use_parallax);
 
     _wait_queue.push_back(indicator);
@@ -466,6 +601,7 @@ void IndicatorSupervisor::AddItemIndicator(float x_position, float y_position, c
 
 void IndicatorSupervisor::AddParallax(float x_parallax, float y_parallax)
 {
+    bool moved = false;
     for(std::deque<IndicatorElement *>::iterator it = _active_queue.begin(),
             it_end = _active_queue.end(); it != it_end; ++it) {
         IndicatorElement* element = *it;
@@ -473,7 +609,11 @@ void IndicatorSupervisor::AddParallax(float x_parallax, float y_parallax)
             continue;
         element->SetXOrigin(element->GetXOrigin() + x_parallax);
         element->SetYOrigin(element->GetYOrigin() + y_parallax);
+        moved = true;
     }
+
+    if (moved)
+        _RebuildOccupiedOrigins();
 }
 
 void IndicatorSupervisor::AddShortNotice(const vt_utils::ustring& message,
@@ -29,6 +29,7 @@
 #include "modes/battle/battle_damage.h"
 
 #include <deque>
+#include <map>
 
 namespace vt_common
 {
@@ -75,6 +76,12 @@ public:
     //! \brief Begins the display of the indicator element
     void Start();
 
+    /** \brief Puts the element back in its initial state, so that it can be reused.
+    *** \param x_position, y_position The indicator base position on screen.
+    *** \param indicator_type tells the indicator use in game.
+    **/
+    void Reset(float x_position, float y_position, INDICATOR_TYPE indicator_type);
+
     //! \brief Updates the timer and the draw coordinates
     virtual void Update();
 
@@ -208,6 +215,85 @@ protected:
 
 
 
+/** ****************************************************************************
+*** \brief The digits of a text style, rendered once and shared by the number indicators
+***
+*** Rendering a text image goes through the font library and allocates texture
+*** sheet space, which is too costly for the many damage and healing numbers
+*** shown during battles. Numbers are instead drawn digit by digit from these
+*** pre-rendered images.
+*** ***************************************************************************/
+class IndicatorDigitAtlas
+{
+public:
+    explicit IndicatorDigitAtlas(const vt_video::TextStyle& style);
+
+    //! \brief Tells whether the atlas was rendered with the given style.
+    bool HasStyle(const vt_video::TextStyle& style) const;
+
+    //! \brief Returns the image of a digit, from 0 to 9.
+    const vt_video::TextImage& GetDigit(uint32_t digit) const {
+        return _digits[digit];
+    }
+
+    //! \brief Returns the height of the digits images.
+    float GetHeight() const {
+        return _digits[0].GetHeight();
+    }
+
+private:
+    //! \brief The style the digits were rendered with.
+    vt_video::TextStyle _style;
+
+    //! \brief The rendered digits images.
+    vt_video::TextImage _digits[10];
+}; // class IndicatorDigitAtlas
+
+
+/** ****************************************************************************
+*** \brief Displays a number composed from the digits of an atlas
+***
+*** Used for the damage and healing amounts. Those indicators are kept in a
+*** pool by the indicator supervisor, and reused once expired.
+*** ***************************************************************************/
+class IndicatorNumber : public IndicatorElement
+{
+public:
+    IndicatorNumber();
+
+    ~IndicatorNumber()
+    {}
+
+    /** \brief Sets the number to display.
+    *** \param amount The number to display.
+    *** \param atlas The digits to draw the number with. Must outlive the indicator.
+    **/
+    void SetNumber(uint32_t amount, const IndicatorDigitAtlas* atlas);
+
+    //! \brief Returns the height of the digits
+    float ElementHeight() const {
+        return _atlas ? _atlas->GetHeight() : 0.0f;
+    }
+
+    //! \brief Draws the number digits
+    void Draw();
+
+protected:
+    //! \brief The digits images used to draw the number.
+    const IndicatorDigitAtlas* _atlas;
+
+    //! \brief The digits of the number, from the most significant one.
+    uint8_t _digits[10];
+
+    //! \brief The number of digits to draw.
+    uint32_t _digit_count;
+
+    //! \brief The total width of the digits.
+    float _width;
+}; // class IndicatorNumber : public IndicatorElement
+
+
+
 /** ****************************************************************************
 *** \brief Displays an image indicator
 ***
@@ -421,10 +507,34 @@ private:
     //! \brief A FIFO container used to display a short message with optional icons.
     std::deque<vt_common::ShortNoticeWindow *> _short_notices;
 
-    //! Check the waiting queue and fix potential overlaps depending on the element position and type.
+    //! \brief The digits rendered for each text style used by the number indicators.
+    std::vector<IndicatorDigitAtlas *> _digit_atlases;
+
+    //! \brief The expired number indicators, ready to be reused.
+    std::vector<IndicatorNumber *> _number_pool;
+
+    //! \brief The number of active elements at each origin position.
+    //! Used to find overlapping indicators without going through the active queue.
+    std::map<std::pair<float, float>, uint32_t> _occupied_origins;
+
+    //! Check the active elements and fix potential overlaps depending on the element position and type.
     //! \param element the Indicator Element which is about to be added.
     //! \return whether there were overlapping elements whose positions were fixed.
     bool _FixPotentialIndicatorOverlapping(IndicatorElement* element);
+
+    //! \brief Returns the digits atlas of the given style, creating it when needed.
+    const IndicatorDigitAtlas* _GetDigitAtlas(const vt_video::TextStyle& style);
+
+    //! \brief Returns a number indicator from the pool, or a new one when it is empty.
+    IndicatorNumber* _AcquireNumberIndicator(float x_position, float y_position,
+                                             uint32_t amount, const vt_video::TextStyle& style,
+                                             INDICATOR_TYPE indicator_type);
+
+    //! \brief Deletes an expired element, or puts it back in the pool when it is a number indicator.
+    void _ReleaseElement(IndicatorElement* element);
+
+    //! \brief Rebuilds the occupied origins from the active elements, after they were moved.
+    void _RebuildOccupiedOrigins();
 }; // class IndicatorSupervisor
 
 } // namespace vt_mode_manager
@@ -322,6 +322,9 @@ void InputEngine::_KeyEventHandler(SDL_KeyboardEvent &key_event)
                     i++;
                 }
                 VideoManager->MakeScreenshot(path);
+                // The file is written asynchronously: don't pick the same name
+                // again for a screenshot taken before it exists.
+                ++i;
                 return;
             }
 #ifdef DEBUG_FEATURES
@@ -337,6 +340,12 @@ void InputEngine::_KeyEventHandler(SDL_KeyboardEvent &key_event)
                 // Display and cycle through the texture sheets
                 TextureManager->DEBUG_NextTexSheet();
                 return;
+            } else if(key_event.keysym.sym == SDLK_p) {
+                // Write the cost of the current game mode scripts
+                vt_mode_manager::GameMode* mode = ModeManager->GetTop();
+                if(mode)
+                    mode->GetScriptSupervisor().DumpProfilingInfo(GetUserDataPath() + "script_profile.txt");
+                return;
             }
 #endif
 
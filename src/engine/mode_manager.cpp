@@ -300,6 +300,13 @@ void ModeEngine::Update()
             _push_stack.pop_back();
         }
 
+        // The scripts of the popped modes are gone: it's the right moment
+        // to collect everything, as the screen is faded out.
+        SystemManager->GetScriptCollector().FullCollect();
+
+        // The new modes are loaded: drop the images preloaded for nothing.
+        VideoManager->ClearPreloadedImages();
+
         // Make sure there is a game mode on the stack,
         // otherwise we'll get a segmentation fault.
         if(_game_stack.empty()) {
@@ -357,6 +364,9 @@ void ModeEngine::DrawPostEffects()
 
     _game_stack.back()->DrawPostEffects();
 
+    if(VideoManager->DebugInfoOn())
+        _game_stack.back()->GetScriptSupervisor().DrawProfilingInfo();
+
     if(_help_window && _help_window->IsActive())
         _help_window->Draw();
 }
@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2012-2016 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    script_collector.cpp
+*** \author  Yohann Ferreira, yohann ferreira orange fr
+*** \brief   Source file for the Lua garbage collection scheduler.
+*** ***************************************************************************/
+
+#include "engine/script_collector.h"
+
+extern "C" {
+#include <lua.h>
+}
+
+#include <SDL2/SDL_timer.h>
+
+namespace vt_system
+{
+
+ScriptCollector::ScriptCollector():
+    _state(nullptr),
+    _step_size(SCRIPT_COLLECTOR_STEP_SIZE),
+    _frame_time(0),
+    _cycle_finished(false),
+    _heap_after_cycle(0)
+{
+}
+
+void ScriptCollector::Initialize(lua_State* state)
+{
+    _state = state;
+    if(_state == nullptr)
+        return;
+
+    // Lua 5.2 and 5.4 may use a generational collector, whose major
+    // collections stop the world.
+#if LUA_VERSION_NUM >= 504
+    lua_gc(_state, LUA_GCINC, 0, 0, 0);
+#elif defined(LUA_GCINC)
+    lua_gc(_state, LUA_GCINC, 0);
+#endif
+}
+
+void ScriptCollector::Step()
+{
+    _frame_time = 0;
+
+    if(_state == nullptr)
+        return;
+
+    // Once a cycle is finished, the next one is only begun when there is garbage again.
+    if(_cycle_finished && !_HasAllocationDebt())
+        return;
+
+    _cycle_finished = _RunStep(_step_size);
+}
+
+void ScriptCollector::UseIdleTime(uint32_t end_tick)
+{
+    if(_state == nullptr)
+        return;
+
+    while((!_cycle_finished || _HasAllocationDebt()) && SDL_GetTicks() < end_tick)
+        _cycle_finished = _RunStep(_step_size);
+}
+
+void ScriptCollector::FullCollect()
+{
+    if(_state == nullptr)
+        return;
+
+    uint64_t counter_before = SDL_GetPerformanceCounter();
+    lua_gc(_state, LUA_GCCOLLECT, 0);
+    uint64_t elapsed = SDL_GetPerformanceCounter() - counter_before;
+    _frame_time += static_cast<uint32_t>(elapsed * 1000000 / SDL_GetPerformanceFrequency());
+
+    _cycle_finished = true;
+    _heap_after_cycle = GetHeapSize();
+}
+
+uint32_t ScriptCollector::GetHeapSize() const
+{
+    if(_state == nullptr)
+        return 0;
+
+    return static_cast<uint32_t>(lua_gc(_state, LUA_GCCOUNT, 0));
+}
+
+bool ScriptCollector::_HasAllocationDebt() const
+{
+    return static_cast<int64_t>(GetHeapSize()) > static_cast<int64_t>(_heap_after_cycle) + _step_size;
+}
+
+bool ScriptCollector::_RunStep(int32_t step_size)
+{
+    uint64_t counter_before = SDL_GetPerformanceCounter();
+    bool cycle_finished = (lua_gc(_state, LUA_GCSTEP, step_size) != 0);
+    uint64_t elapsed = SDL_GetPerformanceCounter() - counter_before;
+    _frame_time += static_cast<uint32_t>(elapsed * 1000000 / SDL_GetPerformanceFrequency());
+
+    if(cycle_finished)
+        _heap_after_cycle = GetHeapSize();
+
+    return cycle_finished;
+}
+
+} // namespace vt_system
@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2012-2016 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    script_collector.h
+*** \author  Yohann Ferreira, yohann ferreira orange fr
+*** \brief   Header file for the Lua garbage collection scheduler.
+***
+*** Left alone, the Lua collector runs whenever the scripts allocate enough
+*** memory, which happens in the middle of the per-frame script callbacks and
+*** causes hitches. The scheduler keeps the collector in incremental mode and
+*** pays its work in small steps every frame, plus extra steps while waiting
+*** for the next frame. Full collections are only done when the game mode
+*** changes, where a hitch isn't noticeable.
+*** ***************************************************************************/
+
+#ifndef __SCRIPT_COLLECTOR_HEADER__
+#define __SCRIPT_COLLECTOR_HEADER__
+
+#include <cstdint>
+
+struct lua_State;
+
+namespace vt_system
+{
+
+//! \brief The default size of the collection steps done each frame, in Lua units (about kilobytes).
+const int32_t SCRIPT_COLLECTOR_STEP_SIZE = 16;
+
+/** ****************************************************************************
+*** \brief Schedules the garbage collection of the global Lua state.
+***
+*** \note The automatic collector isn't stopped, as stepping a stopped collector
+*** doesn't behave the same depending on the Lua version. Paying the collection
+*** debt every frame keeps it from having work to do during the callbacks.
+*** ***************************************************************************/
+class ScriptCollector
+{
+public:
+    ScriptCollector();
+
+    //! \brief Takes over the collection of the given Lua state.
+    void Initialize(lua_State* state);
+
+    //! \brief Does the collection step of the frame. Must be called once per frame.
+    void Step();
+
+    /** \brief Does extra collection steps until the given time.
+    *** \param end_tick The SDL tick at which to stop.
+    *** It stops earlier when the current collection cycle is finished
+    *** and the scripts didn't allocate enough since to need another one.
+    **/
+    void UseIdleTime(uint32_t end_tick);
+
+    //! \brief Does a full collection. Used when changing game modes.
+    void FullCollect();
+
+    //! \brief Sets the size of the collection step done each frame.
+    void SetStepSize(int32_t step_size) {
+        _step_size = step_size;
+    }
+
+    //! \brief Returns the memory used by Lua, in kilobytes.
+    uint32_t GetHeapSize() const;
+
+    //! \brief Returns the time spent collecting during the last frame, in microseconds.
+    uint32_t GetFrameTime() const {
+        return _frame_time;
+    }
+
+private:
+    //! \brief The Lua state collected.
+    lua_State* _state;
+
+    //! \brief The size of the collection step done each frame.
+    int32_t _step_size;
+
+    //! \brief The time spent collecting since the last frame step, in microseconds.
+    uint32_t _frame_time;
+
+    //! \brief Tells whether the last collection cycle finished, and no new one was begun since.
+    bool _cycle_finished;
+
+    //! \brief The memory used by Lua when the last collection cycle finished, in kilobytes.
+    uint32_t _heap_after_cycle;
+
+    //! \brief Tells whether the scripts allocated more than a step since the last cycle finished.
+    bool _HasAllocationDebt() const;
+
+    //! \brief Runs a collection step and counts its time.
+    //! \return true if the step finished a collection cycle.
+    bool _RunStep(int32_t step_size);
+};
+
+} // namespace vt_system
+
+#endif // __SCRIPT_COLLECTOR_HEADER__
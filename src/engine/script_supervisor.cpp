@@ -16,9 +16,40 @@
 #include "engine/script_supervisor.h"
 
 #include "engine/mode_manager.h"
+#include "engine/system.h"
+
+#include "common/script_cache.h"
+
+#include "utils/utils_strings.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 
 using namespace vt_video;
 using namespace vt_script;
+using namespace vt_utils;
+
+//! \brief The weight of a new sample in the rolling profiling averages.
+const float SCRIPT_PROFILING_SMOOTHING = 0.05f;
+
+//! \brief The time between two refreshes of the profiling text, in milliseconds.
+const uint32_t SCRIPT_PROFILING_TEXT_UPDATE_TIME = 500;
+
+//! \brief The callback names, as displayed in the profiling statistics.
+static const char* const SCRIPT_CALLBACK_NAMES[SCRIPT_CALLBACK_TOTAL] = {
+    "Update", "DrawBackground", "DrawForeground", "DrawPostEffects"
+};
+
+//! \brief Returns the amount of memory used by Lua, in bytes.
+static int64_t GetLuaMemoryUsage()
+{
+    lua_State* state = ScriptManager->GetGlobalState();
+    if(state == nullptr)
+        return 0;
+    return static_cast<int64_t>(lua_gc(state, LUA_GCCOUNT, 0)) * 1024
+           + lua_gc(state, LUA_GCCOUNTB, 0);
+}
 
 ScriptSupervisor::~ScriptSupervisor()
 {
@@ -29,6 +60,7 @@ ScriptSupervisor::~ScriptSupervisor()
         delete _still_images[i];
     for(uint32_t i = 0; i < _animated_images.size(); ++i)
         delete _animated_images[i];
+    delete _profiling_text;
 
     // Free every luabind object pointers before freeing the scripts,
     // so that no object may trigger a segmentation fault
@@ -55,7 +87,7 @@ void ScriptSupervisor::Initialize(vt_mode_manager::GameMode *gm)
         ScriptManager->DropGlobalTable(tablespace);
 
         ReadScriptDescriptor* scene_script = new ReadScriptDescriptor();
-        if(!scene_script->OpenFile(_script_filenames[i])) {
+        if(!scene_script->OpenFile(vt_common::GetPrecompiledScript(_script_filenames[i]))) {
             delete scene_script;
             continue;
         }
@@ -74,6 +106,9 @@ void ScriptSupervisor::Initialize(vt_mode_manager::GameMode *gm)
         _draw_background_functions.push_back(scene_script->ReadFunctionPointer("DrawBackground"));
         _draw_foreground_functions.push_back(scene_script->ReadFunctionPointer("DrawForeground"));
         _draw_post_effects_functions.push_back(scene_script->ReadFunctionPointer("DrawPostEffects"));
+        _low_priority_updates.push_back(scene_script->DoesBoolExist("low_priority_update")
+                                        && scene_script->ReadBool("low_priority_update"));
+        _callback_stats.resize(_callback_stats.size() + SCRIPT_CALLBACK_TOTAL);
 
         // Add the script to the list now it is valid.
         _scene_scripts.push_back(scene_script);
@@ -108,28 +143,160 @@ void ScriptSupervisor::Restart()
 
 void ScriptSupervisor::Update()
 {
-    // Updates custom scripts
-    for(uint32_t i = 0; i < _update_functions.size(); ++i)
-        ReadScriptDescriptor::RunScriptObject(_update_functions[i]);
+    uint32_t spent_time = 0;
+    uint32_t num_updates = _update_functions.size();
+
+    // Updates custom scripts, the ones which can't be deferred first.
+    for(uint32_t i = 0; i < num_updates; ++i) {
+        if(!_low_priority_updates[i])
+            spent_time += _RunProfiledFunction(_update_functions[i], i, SCRIPT_CALLBACK_UPDATE);
+    }
+
+    // Then the low priority ones, in turn, as long as the budget permits it.
+    bool budget_exceeded = false;
+    bool low_priority_run = false;
+    uint32_t first_deferred = _next_low_priority_update;
+    for(uint32_t j = 0; j < num_updates; ++j) {
+        uint32_t i = (_next_low_priority_update + j) % num_updates;
+        if(!_low_priority_updates[i])
+            continue;
+
+        if(!budget_exceeded && _update_budget > 0 && low_priority_run && spent_time >= _update_budget) {
+            budget_exceeded = true;
+            first_deferred = i;
+        }
+
+        if(budget_exceeded) {
+            ++_callback_stats[i * SCRIPT_CALLBACK_TOTAL + SCRIPT_CALLBACK_UPDATE].deferred_calls;
+            continue;
+        }
+
+        spent_time += _RunProfiledFunction(_update_functions[i], i, SCRIPT_CALLBACK_UPDATE);
+        low_priority_run = true;
+    }
+    _next_low_priority_update = first_deferred;
+
+    if(VideoManager->DebugInfoOn()) {
+        _profiling_text_time += vt_system::SystemManager->GetUpdateTime();
+        if(_profiling_text_time >= SCRIPT_PROFILING_TEXT_UPDATE_TIME) {
+            _profiling_text_time = 0;
+            _UpdateProfilingText();
+        }
+    }
 }
 
 void ScriptSupervisor::DrawBackground()
 {
     // Handles custom scripted draw before sprites
     for(uint32_t i = 0; i < _draw_background_functions.size(); ++i)
-        ReadScriptDescriptor::RunScriptObject(_draw_background_functions[i]);
+        _RunProfiledFunction(_draw_background_functions[i], i, SCRIPT_CALLBACK_DRAW_BACKGROUND);
 }
 
 void ScriptSupervisor::DrawForeground()
 {
     for(uint32_t i = 0; i < _draw_foreground_functions.size(); ++i)
-        ReadScriptDescriptor::RunScriptObject(_draw_foreground_functions[i]);
+        _RunProfiledFunction(_draw_foreground_functions[i], i, SCRIPT_CALLBACK_DRAW_FOREGROUND);
 }
 
 void ScriptSupervisor::DrawPostEffects()
 {
     for(uint32_t i = 0; i < _draw_post_effects_functions.size(); ++i)
-        ReadScriptDescriptor::RunScriptObject(_draw_post_effects_functions[i]);
+        _RunProfiledFunction(_draw_post_effects_functions[i], i, SCRIPT_CALLBACK_DRAW_POST_EFFECTS);
+}
+
+uint32_t ScriptSupervisor::_RunProfiledFunction(luabind::object& function, uint32_t script_index,
+                                                SCRIPT_CALLBACK_TYPE type)
+{
+    // Scripts don't have to define every function.
+    if(!function.is_valid())
+        return 0;
+
+    int64_t memory_before = GetLuaMemoryUsage();
+    uint64_t counter_before = SDL_GetPerformanceCounter();
+
+    ReadScriptDescriptor::RunScriptObject(function);
+
+    uint64_t elapsed = SDL_GetPerformanceCounter() - counter_before;
+    int64_t memory_delta = GetLuaMemoryUsage() - memory_before;
+    uint32_t time = static_cast<uint32_t>(elapsed * 1000000 / SDL_GetPerformanceFrequency());
+
+    ScriptCallbackStats& stats = _callback_stats[script_index * SCRIPT_CALLBACK_TOTAL + type];
+    if(stats.calls == 0) {
+        stats.average_time = static_cast<float>(time);
+        stats.average_memory = static_cast<float>(memory_delta);
+    }
+    else {
+        stats.average_time += (static_cast<float>(time) - stats.average_time) * SCRIPT_PROFILING_SMOOTHING;
+        stats.average_memory += (static_cast<float>(memory_delta) - stats.average_memory) * SCRIPT_PROFILING_SMOOTHING;
+    }
+    if(time > stats.max_time)
+        stats.max_time = time;
+    ++stats.calls;
+
+    return time;
+}
+
+void ScriptSupervisor::_UpdateProfilingText()
+{
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(2);
+    for(uint32_t i = 0; i < _scene_scripts.size(); ++i) {
+        text << _scene_scripts[i]->GetFilename() << ":";
+        for(uint32_t type = 0; type < SCRIPT_CALLBACK_TOTAL; ++type) {
+            const ScriptCallbackStats& stats = _callback_stats[i * SCRIPT_CALLBACK_TOTAL + type];
+            if(stats.calls == 0)
+                continue;
+            text << " " << SCRIPT_CALLBACK_NAMES[type] << " " << stats.average_time / 1000.0f << "ms";
+        }
+        text << std::endl;
+    }
+
+    if(!_profiling_text)
+        _profiling_text = new TextImage(text.str(), TextStyle("text20", Color::white));
+    else
+        _profiling_text->SetText(text.str());
+}
+
+void ScriptSupervisor::DrawProfilingInfo()
+{
+    if(!_profiling_text)
+        return;
+
+    VideoManager->PushState();
+    VideoManager->SetStandardCoordSys();
+    VideoManager->SetDrawFlags(VIDEO_X_LEFT, VIDEO_Y_TOP, VIDEO_BLEND, 0);
+    VideoManager->Move(10.0f, 90.0f);
+    _profiling_text->Draw();
+    VideoManager->PopState();
+}
+
+bool ScriptSupervisor::DumpProfilingInfo(const std::string& filename)
+{
+    std::ofstream file(filename.c_str());
+    if(!file) {
+        PRINT_WARNING << "Couldn't write the script profiling file: " << filename << std::endl;
+        return false;
+    }
+
+    file << "# Script functions cost: average and maximum time in microseconds," << std::endl
+         << "# average Lua memory variation in bytes, calls and deferred calls." << std::endl;
+    file << "# Update budget: " << _update_budget << " microseconds" << std::endl;
+    for(uint32_t i = 0; i < _scene_scripts.size(); ++i) {
+        file << _scene_scripts[i]->GetFilename()
+             << (_low_priority_updates[i] ? " (low priority update)" : "") << std::endl;
+        for(uint32_t type = 0; type < SCRIPT_CALLBACK_TOTAL; ++type) {
+            const ScriptCallbackStats& stats = _callback_stats[i * SCRIPT_CALLBACK_TOTAL + type];
+            if(stats.calls == 0)
+                continue;
+            file << "    " << SCRIPT_CALLBACK_NAMES[type]
+                 << ": avg " << static_cast<uint32_t>(stats.average_time)
+                 << ", max " << stats.max_time
+                 << ", memory " << static_cast<int32_t>(stats.average_memory)
+                 << ", calls " << stats.calls
+                 << ", deferred " << stats.deferred_calls << std::endl;
+        }
+    }
+    return true;
 }
 
 // Images loading
@@ -27,10 +27,45 @@ namespace vt_mode_manager {
 class GameMode;
 }
 
+//! \brief The script functions called every frame, as sorted in the profiling statistics.
+enum SCRIPT_CALLBACK_TYPE {
+    SCRIPT_CALLBACK_UPDATE = 0,
+    SCRIPT_CALLBACK_DRAW_BACKGROUND = 1,
+    SCRIPT_CALLBACK_DRAW_FOREGROUND = 2,
+    SCRIPT_CALLBACK_DRAW_POST_EFFECTS = 3,
+    SCRIPT_CALLBACK_TOTAL = 4
+};
+
+//! \brief The cost of a script function, as measured over the last frames.
+struct ScriptCallbackStats {
+    ScriptCallbackStats():
+        average_time(0.0f),
+        max_time(0),
+        average_memory(0.0f),
+        calls(0),
+        deferred_calls(0)
+    {}
+
+    //! \brief The rolling average and the maximum run time, in microseconds.
+    float average_time;
+    uint32_t max_time;
+
+    //! \brief The rolling average of the Lua memory variation during a call, in bytes.
+    float average_memory;
+
+    //! \brief The number of calls, and the number of update calls deferred because of the frame budget.
+    uint32_t calls;
+    uint32_t deferred_calls;
+};
+
 class ScriptSupervisor
 {
 public:
-    ScriptSupervisor()
+    ScriptSupervisor():
+        _update_budget(0),
+        _next_low_priority_update(0),
+        _profiling_text(nullptr),
+        _profiling_text_time(0)
     {}
 
     ~ScriptSupervisor();
@@ -107,6 +142,24 @@ public:
     //! \brief Used to permit changing a draw flag at boot time. Use with caution.
     void SetDrawFlag(vt_video::VIDEO_DRAW_FLAGS draw_flag);
 
+    /** \brief Sets the time the update functions may take each frame.
+    *** \param budget The budget in microseconds, or 0 to disable it.
+    *** Once the budget is spent, the update functions of the scripts declaring
+    *** 'low_priority_update = true' in their namespace are deferred to the next frames.
+    *** At least one of them is run each frame, so that none is deferred forever.
+    **/
+    void SetUpdateBudget(uint32_t budget) {
+        _update_budget = budget;
+    }
+
+    //! \brief Draws the cost of each script functions. Used when the debug info is shown.
+    void DrawProfilingInfo();
+
+    /** \brief Writes the cost of each script functions in a text file.
+    *** \return false if the file couldn't be written.
+    **/
+    bool DumpProfilingInfo(const std::string& filename);
+
 private:
     //! \brief Contains a collection of custom created images
     std::vector<vt_video::TextImage*> _text_images;
@@ -161,6 +214,34 @@ private:
     /** \brief Scripts objects keeping the corresponding lua coroutines alive.
     **/
     std::vector<vt_script::ReadScriptDescriptor*> _scene_scripts;
+
+    //! \brief Tells for each script whether its update function may be deferred.
+    std::vector<bool> _low_priority_updates;
+    //@}
+
+    //! \name Profiling data
+    //@{
+    //! \brief The cost of the script functions, stored as [script index * SCRIPT_CALLBACK_TOTAL + type].
+    std::vector<ScriptCallbackStats> _callback_stats;
+
+    //! \brief The time the update functions may take each frame, in microseconds. 0 means unlimited.
+    uint32_t _update_budget;
+
+    //! \brief The script whose low priority update function will be tried first next frame.
+    uint32_t _next_low_priority_update;
+
+    //! \brief The profiling statistics displayed with the debug info, and the time since their last refresh.
+    vt_video::TextImage* _profiling_text;
+    uint32_t _profiling_text_time;
+    //@}
+
+    /** \brief Runs a script function and records its cost.
+    *** \return The time spent in the function, in microseconds.
+    **/
+    uint32_t _RunProfiledFunction(luabind::object& function, uint32_t script_index, SCRIPT_CALLBACK_TYPE type);
+
+    //! \brief Refreshes the profiling statistics text.
+    void _UpdateProfilingText();
 };
 
 #endif
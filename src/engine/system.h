@@ -25,6 +25,9 @@
 #ifndef __SYSTEM_HEADER__
 #define __SYSTEM_HEADER__
 
+#include "engine/frame_allocator.h"
+#include "engine/script_collector.h"
+
 #include "utils/ustring.h"
 #include "utils/singleton.h"
 
@@ -484,6 +487,14 @@ public:
         return _update_time;
     }
 
+    /** \brief Overrides the value returned by GetUpdateTime() until the next call to UpdateTimers().
+    *** Used to update objects at a reduced rate with the whole time passed since their last update.
+    *** The caller is expected to restore the previous value right after.
+    **/
+    void SetUpdateTime(uint32_t update_time) {
+        _update_time = update_time;
+    }
+
     /** \brief Sets the play time of a game instance
     *** \param h The amount of hours to set.
     *** \param m The amount of minutes to set.
@@ -607,6 +618,17 @@ public:
             _game_save_slots = 10;
     }
 
+    //! \brief Returns the allocator for the temporary data of the current frame.
+    //! It is reset at the beginning of each main loop update.
+    FrameAllocator& GetFrameAllocator() {
+        return _frame_allocator;
+    }
+
+    //! \brief Returns the scheduler of the Lua garbage collection.
+    ScriptCollector& GetScriptCollector() {
+        return _script_collector;
+    }
+
 private:
     SystemEngine();
 
@@ -658,6 +680,12 @@ private:
     *** The timers in this container are updated on each call to UpdateTimers().
     **/
     std::set<SystemTimer *> _auto_system_timers;
+
+    //! \brief The allocator used by the frame containers.
+    FrameAllocator _frame_allocator;
+
+    //! \brief The Lua garbage collection scheduler.
+    ScriptCollector _script_collector;
 }; // class SystemEngine : public vt_utils::Singleton<SystemEngine>
 
 } // namepsace vt_system
@@ -65,6 +65,9 @@ public:
 
     //! \brief Used to enable or disable the scissoring rectangle.
     bool scissoring_enabled;
+
+    //! \brief Set while drawing into a retained render target, whose colors are kept premultiplied.
+    bool render_target_capture;
 }; // class Context
 
 } // namespace private_video
@@ -20,7 +20,6 @@
 #include "utils/utils_common.h"
 
 #include <cassert>
-#include <vector>
 
 namespace vt_video
 {
@@ -34,6 +33,12 @@ const unsigned POSITIONS_PER_VERTEX = 3;
 const unsigned TEXTURE_COORDINATES_PER_VERTEX = 2;
 const unsigned COLORS_PER_VERTEX = 4;
 
+//! \brief The size of the whole vertex buffer, in vertices.
+const unsigned PARTICLE_BUFFER_VERTICES = PARTICLE_BUFFER_SEGMENTS * PARTICLE_BUFFER_SEGMENT_VERTICES;
+
+//! \brief The maximum time to wait for the GPU to release a segment, in nanoseconds.
+const GLuint64 PARTICLE_FENCE_TIMEOUT = 1000000000;
+
 #ifdef __APPLE__
 #define glBindVertexArray glBindVertexArrayAPPLE
 #define glGenVertexArrays glGenVertexArraysAPPLE
@@ -41,14 +46,54 @@ const unsigned COLORS_PER_VERTEX = 4;
 #define glDeleteVertexArrays glDeleteVertexArraysAPPLE
 #endif
 
+//! \brief Tells whether buffers can be stored and mapped persistently on the current GL context.
+static bool IsPersistentMappingSupported()
+{
+#ifdef __APPLE__
+    return false;
+#else
+    return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+#endif
+}
+
+//! \brief Tells whether buffer ranges can be mapped on the current GL context.
+static bool IsMapBufferRangeSupported()
+{
+#ifdef __APPLE__
+    return false;
+#else
+    return GLEW_VERSION_3_0 || GLEW_ARB_map_buffer_range;
+#endif
+}
+
+//! \brief Tells whether fences can be used on the current GL context.
+static bool IsSyncSupported()
+{
+#ifdef __APPLE__
+    return false;
+#else
+    return GLEW_VERSION_3_2 || GLEW_ARB_sync;
+#endif
+}
+
 ParticleSystem::ParticleSystem() :
-    _number_of_indices(0),
+    _streaming_mode(STREAMING_BUFFER_SUB_DATA),
     _vao(0),
-    _vertex_position_buffer(0),
-    _vertex_texture_coordinate_buffer(0),
-    _vertex_color_buffer(0),
-    _index_buffer(0)
+    _vertex_buffer(0),
+    _index_buffer(0),
+    _persistent_vertices(nullptr),
+    _fences_supported(IsSyncSupported()),
+    _invalidate_buffer(false),
+    _segment(0),
+    _segment_vertices(0),
+    _first_vertex(0),
+    _number_of_vertices(0)
 {
+#ifndef __APPLE__
+    for (unsigned i = 0; i < PARTICLE_BUFFER_SEGMENTS; ++i)
+        _segment_fences[i] = nullptr;
+#endif
+
     bool errors = false;
 
     // Create the vertex array object.
@@ -74,154 +119,124 @@ ParticleSystem::ParticleSystem() :
 
     // Create the vertex buffer objects.
     if (!errors) {
-        GLuint buffers[4] = { 0 };
-        glGenBuffers(4, buffers);
+        GLuint buffers[2] = { 0 };
+        glGenBuffers(2, buffers);
 
         GLenum error = glGetError();
         if (error != GL_NO_ERROR) {
             errors = true;
-            PRINT_ERROR << "Failed to create the vertex array object's position, texture coordinate, color, and index buffers. VAO ID: " <<
+            PRINT_ERROR << "Failed to create the vertex array object's vertex and index buffers. VAO ID: " <<
                            vt_utils::NumberToString(_vao) <<
                            std::endl;
             assert(error == GL_NO_ERROR);
         } else {
             // Store the results.
-            _vertex_position_buffer = buffers[0];
-            _vertex_texture_coordinate_buffer = buffers[1];
-            _vertex_color_buffer = buffers[2];
-            _index_buffer = buffers[3];
+            _vertex_buffer = buffers[0];
+            _index_buffer = buffers[1];
         }
     }
 
-    // Bind the vertex position buffer.
+    // Bind the vertex buffer.
     if (!errors) {
-        glBindBuffer(GL_ARRAY_BUFFER, _vertex_position_buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffer);
     }
 
-    // Set up the vertex position data.
+    // Allocate the vertex buffer, mapped for good when possible.
     if (!errors) {
-        glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
-
-        GLenum error = glGetError();
-        if (error != GL_NO_ERROR) {
-            errors = true;
-            PRINT_ERROR << "Failed to store the vertex position data. VAO ID: " <<
-                           vt_utils::NumberToString(_vao) << " Buffer ID: " <<
-                           vt_utils::NumberToString(_vertex_position_buffer) <<
-                           std::endl;
-            assert(error == GL_NO_ERROR);
+        const GLsizeiptr buffer_size = PARTICLE_BUFFER_VERTICES * sizeof(ParticleBufferVertex);
+
+#ifndef __APPLE__
+        // The persistent mapping relies on the fences to not overwrite vertices being drawn.
+        if (IsPersistentMappingSupported() && _fences_supported) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_ARRAY_BUFFER, buffer_size, nullptr, flags);
+            _persistent_vertices = static_cast<ParticleBufferVertex*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, buffer_size, flags));
+
+            if (glGetError() == GL_NO_ERROR && _persistent_vertices != nullptr) {
+                _streaming_mode = STREAMING_PERSISTENT_MAPPING;
+            } else {
+                // Buffer storages are immutable: start over with a new buffer.
+                _persistent_vertices = nullptr;
+                glDeleteBuffers(1, &_vertex_buffer);
+                glGenBuffers(1, &_vertex_buffer);
+                glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffer);
+            }
         }
-    }
+#endif
 
-    // Store the vertex position data into slot 0.
-    if (!errors) {
-        glVertexAttribPointer(0, 3, GL_FLOAT, false, 0, nullptr);
+        if (_streaming_mode != STREAMING_PERSISTENT_MAPPING) {
+            glBufferData(GL_ARRAY_BUFFER, buffer_size, nullptr, GL_STREAM_DRAW);
 
-        GLenum error = glGetError();
-        if (error != GL_NO_ERROR) {
-            errors = true;
-            PRINT_ERROR << "Failed to set the vertex position data attribute pointer. VAO ID: " <<
-                           vt_utils::NumberToString(_vao) << " Buffer ID: " <<
-                           vt_utils::NumberToString(_vertex_position_buffer) <<
-                           std::endl;
-            assert(error == GL_NO_ERROR);
+            if (IsMapBufferRangeSupported())
+                _streaming_mode = STREAMING_UNSYNCHRONIZED_MAPPING;
+            else
+                _staging_vertices.resize(PARTICLE_BUFFER_SEGMENT_VERTICES);
         }
-    }
-
-    // Enable the attribute index.
-    if (!errors) {
-        glEnableVertexAttribArray(0);
-    }
-
-    // Bind the vertex texture coordinate buffer.
-    if (!errors) {
-        glBindBuffer(GL_ARRAY_BUFFER, _vertex_texture_coordinate_buffer);
-    }
-
-    // Set up the vertex texture coordinate data.
-    if (!errors) {
-        glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
 
         GLenum error = glGetError();
         if (error != GL_NO_ERROR) {
             errors = true;
-            PRINT_ERROR << "Failed to store the vertex texture coordinate data. VAO ID: " <<
+            PRINT_ERROR << "Failed to allocate the vertex data. VAO ID: " <<
                            vt_utils::NumberToString(_vao) << " Buffer ID: " <<
-                           vt_utils::NumberToString(_vertex_texture_coordinate_buffer) <<
+                           vt_utils::NumberToString(_vertex_buffer) <<
                            std::endl;
             assert(error == GL_NO_ERROR);
         }
     }
 
-    // Store the vertex texture coordinate data into slot 1.
+    // Store the vertex positions into slot 0, the texture coordinates into slot 1, and the colors into slot 2.
     if (!errors) {
-        glVertexAttribPointer(1, 2, GL_FLOAT, false, 0, nullptr);
+        _SetVertexAttributes(0);
 
         GLenum error = glGetError();
         if (error != GL_NO_ERROR) {
             errors = true;
-            PRINT_ERROR << "Failed to set the vertex texture coordinate data attribute pointer. VAO ID: " <<
+            PRINT_ERROR << "Failed to set the vertex data attribute pointers. VAO ID: " <<
                            vt_utils::NumberToString(_vao) << " Buffer ID: " <<
-                           vt_utils::NumberToString(_vertex_texture_coordinate_buffer) <<
+                           vt_utils::NumberToString(_vertex_buffer) <<
                            std::endl;
             assert(error == GL_NO_ERROR);
         }
     }
 
-    // Enable the attribute index.
+    // Enable the attribute indices.
     if (!errors) {
+        glEnableVertexAttribArray(0);
         glEnableVertexAttribArray(1);
+        glEnableVertexAttribArray(2);
     }
 
-    // Bind the vertex color buffer.
+    // Bind the index buffer.
     if (!errors) {
-        glBindBuffer(GL_ARRAY_BUFFER, _vertex_color_buffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _index_buffer);
     }
 
-    // Set up the vertex color data.
+    // Set up the index data. Every draw starts at the beginning of the indices,
+    // the vertex attributes pointing to its first vertex.
     if (!errors) {
-        glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+        const unsigned number_of_particles = PARTICLE_BUFFER_SEGMENT_VERTICES / VERTICES_PER_PARTICLE;
 
-        GLenum error = glGetError();
-        if (error != GL_NO_ERROR) {
-            errors = true;
-            PRINT_ERROR << "Failed to store the vertex color data. VAO ID: " <<
-                           vt_utils::NumberToString(_vao) << " Buffer ID: " <<
-                           vt_utils::NumberToString(_vertex_color_buffer) <<
-                           std::endl;
-            assert(error == GL_NO_ERROR);
-        }
-    }
+        std::vector<unsigned> indices;
+        indices.reserve(number_of_particles * INDICES_PER_PARTICLE);
+        for (unsigned i = 0; i < number_of_particles; ++i) {
+            // Compute the starting index of the particle.
+            unsigned index = i * VERTICES_PER_PARTICLE;
 
-    // Store the vertex color data into slot 2.
-    if (!errors) {
-        glVertexAttribPointer(2, 4, GL_FLOAT, false, 0, nullptr);
+            // Triangle one.
+            indices.push_back(index + 0);
+            indices.push_back(index + 1);
+            indices.push_back(index + 2);
 
-        GLenum error = glGetError();
-        if (error != GL_NO_ERROR) {
-            errors = true;
-            PRINT_ERROR << "Failed to set the vertex color data attribute pointer. VAO ID: " <<
-                           vt_utils::NumberToString(_vao) << " Buffer ID: " <<
-                           vt_utils::NumberToString(_vertex_color_buffer) <<
-                           std::endl;
-            assert(error == GL_NO_ERROR);
+            // Triangle two.
+            indices.push_back(index + 0);
+            indices.push_back(index + 2);
+            indices.push_back(index + 3);
         }
-    }
-
-    // Enable the attribute index.
-    if (!errors) {
-        glEnableVertexAttribArray(2);
-    }
 
-    // Bind the index buffer.
-    if (!errors) {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _index_buffer);
-    }
-
-    // Set up the index data.
-    if (!errors) {
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, 0, nullptr, GL_STATIC_DRAW);
-        _number_of_indices = 0;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                     indices.size() * sizeof(unsigned),
+                     &indices.front(),
+                     GL_STATIC_DRAW);
 
         GLenum error = glGetError();
         if (error != GL_NO_ERROR) {
@@ -243,28 +258,27 @@ ParticleSystem::ParticleSystem() :
 
 ParticleSystem::~ParticleSystem()
 {
+#ifndef __APPLE__
+    for (unsigned i = 0; i < PARTICLE_BUFFER_SEGMENTS; ++i) {
+        if (_segment_fences[i] != nullptr) {
+            glDeleteSync(_segment_fences[i]);
+            _segment_fences[i] = nullptr;
+        }
+    }
+#endif
+
     if (_vao != 0) {
         const GLuint arrays[] = { _vao };
         glDeleteVertexArrays(1, arrays);
         _vao = 0;
     }
 
-    if (_vertex_position_buffer != 0) {
-        const GLuint buffers[] = { _vertex_position_buffer };
-        glDeleteBuffers(1, buffers);
-        _vertex_position_buffer = 0;
-    }
-
-    if (_vertex_texture_coordinate_buffer != 0) {
-        const GLuint buffers[] = { _vertex_texture_coordinate_buffer };
-        glDeleteBuffers(1, buffers);
-        _vertex_texture_coordinate_buffer = 0;
-    }
-
-    if (_vertex_color_buffer != 0) {
-        const GLuint buffers[] = { _vertex_color_buffer };
+    // Deleting the buffer unmaps it as well.
+    if (_vertex_buffer != 0) {
+        const GLuint buffers[] = { _vertex_buffer };
         glDeleteBuffers(1, buffers);
-        _vertex_color_buffer = 0;
+        _vertex_buffer = 0;
+        _persistent_vertices = nullptr;
     }
 
     if (_index_buffer != 0) {
@@ -274,16 +288,79 @@ ParticleSystem::~ParticleSystem()
     }
 }
 
+ParticleBufferVertex* ParticleSystem::MapVertices(unsigned number_of_vertices)
+{
+    assert(number_of_vertices % VERTICES_PER_PARTICLE == 0);
+    assert(number_of_vertices <= PARTICLE_BUFFER_SEGMENT_VERTICES);
+
+    if (_segment_vertices + number_of_vertices > PARTICLE_BUFFER_SEGMENT_VERTICES)
+        _NextSegment();
+
+    _first_vertex = _segment * PARTICLE_BUFFER_SEGMENT_VERTICES + _segment_vertices;
+    _number_of_vertices = number_of_vertices;
+    _segment_vertices += number_of_vertices;
+
+    if (_streaming_mode == STREAMING_PERSISTENT_MAPPING)
+        return _persistent_vertices + _first_vertex;
+
+#ifndef __APPLE__
+    if (_streaming_mode == STREAMING_UNSYNCHRONIZED_MAPPING) {
+        // The fences, or the buffer orphaning when the ring wraps, make sure
+        // the GPU is done with this range.
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        flags |= _invalidate_buffer ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_INVALIDATE_RANGE_BIT;
+        _invalidate_buffer = false;
+
+        glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffer);
+        void* vertices = glMapBufferRange(GL_ARRAY_BUFFER,
+                                          _first_vertex * sizeof(ParticleBufferVertex),
+                                          number_of_vertices * sizeof(ParticleBufferVertex),
+                                          flags);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        if (vertices != nullptr)
+            return static_cast<ParticleBufferVertex*>(vertices);
+
+        PRINT_WARNING << "Failed to map the particle vertex buffer, copying the vertices from now on." << std::endl;
+        _streaming_mode = STREAMING_BUFFER_SUB_DATA;
+        _staging_vertices.resize(PARTICLE_BUFFER_SEGMENT_VERTICES);
+    }
+#endif
+
+    return &_staging_vertices.front();
+}
+
 void ParticleSystem::Draw()
 {
+    if (_number_of_vertices == 0)
+        return;
+
     // Bind the vertex array object.
     glBindVertexArray(_vao);
 
+    // Bind the vertex buffer, and finish sending the vertices.
+    glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffer);
+
+    if (_streaming_mode == STREAMING_UNSYNCHRONIZED_MAPPING) {
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    } else if (_streaming_mode == STREAMING_BUFFER_SUB_DATA) {
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        _first_vertex * sizeof(ParticleBufferVertex),
+                        _number_of_vertices * sizeof(ParticleBufferVertex),
+                        &_staging_vertices.front());
+    }
+
+    _SetVertexAttributes(_first_vertex);
+
     // Bind the index buffer.
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _index_buffer);
 
     // Draw the particle system.
-    glDrawElements(GL_TRIANGLES, _number_of_indices, GL_UNSIGNED_INT, nullptr);
+    glDrawElements(GL_TRIANGLES,
+                   _number_of_vertices / VERTICES_PER_PARTICLE * INDICES_PER_PARTICLE,
+                   GL_UNSIGNED_INT,
+                   nullptr);
+    _number_of_vertices = 0;
 
     // Unbind the vertex array object from the pipeline.
     glBindVertexArray(0);
@@ -293,144 +370,47 @@ void ParticleSystem::Draw()
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
-void ParticleSystem::Draw(float* vertex_positions,
-                          float* vertex_texture_coordinates,
-                          float* vertex_colors,
-                          unsigned number_of_vertices)
+void ParticleSystem::_NextSegment()
 {
-    bool errors = false;
-
-    assert(vertex_positions != nullptr);
-    assert(vertex_texture_coordinates != nullptr);
-    assert(vertex_colors != nullptr);
-    assert(number_of_vertices % VERTICES_PER_PARTICLE == 0);
-
-    // Bind the vertex position buffer.
-    glBindBuffer(GL_ARRAY_BUFFER, _vertex_position_buffer);
-
-    // Update the vertex position data.
-    if (!errors) {
-        glBufferData(GL_ARRAY_BUFFER,
-                     number_of_vertices * POSITIONS_PER_VERTEX * sizeof(float),
-                     vertex_positions,
-                     GL_DYNAMIC_DRAW);
-
-        GLenum error = glGetError();
-        if (error != GL_NO_ERROR) {
-            errors = true;
-            PRINT_ERROR << "Failed to update the vertex position data. VAO ID: " <<
-                           vt_utils::NumberToString(_vao) << " Buffer ID: " <<
-                           vt_utils::NumberToString(_vertex_position_buffer) <<
-                           std::endl;
-            assert(error == GL_NO_ERROR);
-        }
-    }
-
-    // Bind the vertex texture coordinate buffer.
-    if (!errors) {
-        glBindBuffer(GL_ARRAY_BUFFER, _vertex_texture_coordinate_buffer);
-    }
-
-    // Update the vertex texture coordinate data.
-    if (!errors) {
-        glBufferData(GL_ARRAY_BUFFER,
-                     number_of_vertices * TEXTURE_COORDINATES_PER_VERTEX * sizeof(float),
-                     vertex_texture_coordinates,
-                     GL_DYNAMIC_DRAW);
-
-        GLenum error = glGetError();
-        if (error != GL_NO_ERROR) {
-            errors = true;
-            PRINT_ERROR << "Failed to update the vertex texture coordinate data. VAO ID: " <<
-                           vt_utils::NumberToString(_vao) << " Buffer ID: " <<
-                           vt_utils::NumberToString(_vertex_texture_coordinate_buffer) <<
-                           std::endl;
-            assert(error == GL_NO_ERROR);
-        }
-    }
-
-    // Bind the vertex color buffer.
-    if (!errors) {
-        glBindBuffer(GL_ARRAY_BUFFER, _vertex_color_buffer);
-    }
-
-    // Update the vertex color data.
-    if (!errors) {
-        glBufferData(GL_ARRAY_BUFFER,
-                     number_of_vertices * COLORS_PER_VERTEX * sizeof(float),
-                     vertex_colors,
-                     GL_DYNAMIC_DRAW);
-
-        GLenum error = glGetError();
-        if (error != GL_NO_ERROR) {
-            errors = true;
-            PRINT_ERROR << "Failed to update the vertex color data. VAO ID: " <<
-                           vt_utils::NumberToString(_vao) << " Buffer ID: " <<
-                           vt_utils::NumberToString(_vertex_color_buffer) <<
-                           std::endl;
-            assert(error == GL_NO_ERROR);
-        }
-    }
-
-    // Create the index buffer's data.
-    std::vector<unsigned> indices;
-    indices.reserve(number_of_vertices / VERTICES_PER_PARTICLE * INDICES_PER_PARTICLE);
-    if (!errors) {
-        // For each particle...
-        unsigned number_of_particles = number_of_vertices / VERTICES_PER_PARTICLE;
-        for (unsigned i = 0; i < number_of_particles; ++i)
-        {
-            // Compute the starting index of the particle.
-            unsigned index = i * VERTICES_PER_PARTICLE;
-
-            //
-            // Store the particle's indices.
-            //
-
-            // Triangle one.
-            indices.push_back(index + 0);
-            indices.push_back(index + 1);
-            indices.push_back(index + 2);
-
-            // Triangle two.
-            indices.push_back(index + 0);
-            indices.push_back(index + 2);
-            indices.push_back(index + 3);
-        }
-    }
-
-    // Bind the index buffer.
-    if (!errors) {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _index_buffer);
+#ifndef __APPLE__
+    if (_fences_supported) {
+        // Fence the draws of the segment being left.
+        if (_segment_fences[_segment] != nullptr)
+            glDeleteSync(_segment_fences[_segment]);
+        _segment_fences[_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
     }
+#endif
 
-    // Update the index data.
-    if (!errors) {
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                     indices.size() * sizeof(unsigned),
-                     &indices.front(),
-                     GL_DYNAMIC_DRAW);
-        _number_of_indices = indices.size();
+    _segment = (_segment + 1) % PARTICLE_BUFFER_SEGMENTS;
+    _segment_vertices = 0;
 
-        GLenum error = glGetError();
-        if (error != GL_NO_ERROR) {
-            errors = true;
-            PRINT_ERROR << "Failed to update the index data. VAO ID: " <<
-                           vt_utils::NumberToString(_vao) << " Buffer ID: " <<
-                           vt_utils::NumberToString(_index_buffer) <<
-                           std::endl;
-            assert(error == GL_NO_ERROR);
+#ifndef __APPLE__
+    if (_fences_supported) {
+        // Wait for the GPU to be done with the draws of the segment to write.
+        if (_segment_fences[_segment] != nullptr) {
+            glClientWaitSync(_segment_fences[_segment], GL_SYNC_FLUSH_COMMANDS_BIT, PARTICLE_FENCE_TIMEOUT);
+            glDeleteSync(_segment_fences[_segment]);
+            _segment_fences[_segment] = nullptr;
         }
+        return;
     }
+#endif
 
-    // Unbind the buffers from the pipeline.
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    // Without fences, orphan the whole buffer each time the ring wraps.
+    if (_segment == 0)
+        _invalidate_buffer = true;
+}
 
-    // Draw the particle system.
-    if (!errors) {
-        Draw();
-    }
+void ParticleSystem::_SetVertexAttributes(unsigned first_vertex)
+{
+    const size_t offset = first_vertex * sizeof(ParticleBufferVertex);
+
+    glVertexAttribPointer(0, POSITIONS_PER_VERTEX, GL_FLOAT, false, sizeof(ParticleBufferVertex),
+                          reinterpret_cast<const GLvoid*>(offset + offsetof(ParticleBufferVertex, x)));
+    glVertexAttribPointer(1, TEXTURE_COORDINATES_PER_VERTEX, GL_FLOAT, false, sizeof(ParticleBufferVertex),
+                          reinterpret_cast<const GLvoid*>(offset + offsetof(ParticleBufferVertex, u)));
+    glVertexAttribPointer(2, COLORS_PER_VERTEX, GL_FLOAT, false, sizeof(ParticleBufferVertex),
+                          reinterpret_cast<const GLvoid*>(offset + offsetof(ParticleBufferVertex, r)));
 }
 
 ParticleSystem::ParticleSystem(const ParticleSystem&)
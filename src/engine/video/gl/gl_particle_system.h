@@ -11,6 +11,12 @@
 *** \file    gl_particle_system.h
 *** \author  Authenticate, James Lammlein
 *** \brief   Header file for buffers for a particle system.
+***
+*** All the particle systems stream their vertices in a single vertex buffer,
+*** used as a ring of segments. The vertices are written directly in the
+*** buffer memory, mapped once for good when the context supports persistent
+*** mappings, or mapped per draw without synchronization otherwise. A fence is
+*** placed when leaving a segment, and waited for before writing it again.
 *** ***************************************************************************/
 
 #ifndef __GL_PARTICLE_SYSTEM_HEADER__
@@ -19,12 +25,38 @@
 #include "utils/gl_include.h"
 
 #include <cstddef>
+#include <vector>
 
 namespace vt_video
 {
 namespace gl
 {
 
+//! \brief The number of segments of the particle vertex ring buffer.
+const unsigned PARTICLE_BUFFER_SEGMENTS = 3;
+
+//! \brief The number of vertices in a segment, and thus the maximum number of vertices drawn at once.
+const unsigned PARTICLE_BUFFER_SEGMENT_VERTICES = 4 * 16384;
+
+//! \brief A particle vertex, as stored in the vertex buffer.
+//! vt_mode_manager::ParticleVertex only holds the positions of the quad corners.
+struct ParticleBufferVertex {
+    //! \brief The position of the vertex.
+    float x;
+    float y;
+    float z;
+
+    //! \brief The texture coordinates of the vertex.
+    float u;
+    float v;
+
+    //! \brief The color of the vertex.
+    float r;
+    float g;
+    float b;
+    float a;
+};
+
 //! \brief A class for drawing a particle system.
 class ParticleSystem
 {
@@ -32,14 +64,15 @@ public:
     ParticleSystem();
     ~ParticleSystem();
 
-    //! \brief Draws all sprites in a particle system.
-    void Draw();
+    /** \brief Reserves room in the vertex buffer for the next draw.
+    *** \param number_of_vertices The number of vertices to draw, a multiple of 4
+    *** up to PARTICLE_BUFFER_SEGMENT_VERTICES.
+    *** \return Where to write the vertices, valid until Draw() is called.
+    **/
+    ParticleBufferVertex* MapVertices(unsigned number_of_vertices);
 
-    //! \brief Draws all sprites in a particle system.
-    void Draw(float* vertex_positions,
-              float* vertex_texture_coordinates,
-              float* vertex_colors,
-              unsigned number_of_vertices);
+    //! \brief Draws the vertices written since the last call to MapVertices().
+    void Draw();
 
 private:
     //! \brief The copy constructor and assignment operator are hidden by design
@@ -47,13 +80,52 @@ private:
     ParticleSystem(const ParticleSystem& particle_system);
     ParticleSystem& operator=(const ParticleSystem& particle_system);
 
-    size_t _number_of_indices;
+    //! \brief How the vertices are sent to the vertex buffer.
+    enum StreamingMode {
+        //! \brief The vertices are written in a persistently mapped buffer.
+        STREAMING_PERSISTENT_MAPPING,
+        //! \brief The buffer range of each draw is mapped without synchronization.
+        STREAMING_UNSYNCHRONIZED_MAPPING,
+        //! \brief The vertices are written in memory, and copied with glBufferSubData().
+        STREAMING_BUFFER_SUB_DATA
+    };
+
+    StreamingMode _streaming_mode;
 
     GLuint _vao;
-    GLuint _vertex_position_buffer;
-    GLuint _vertex_texture_coordinate_buffer;
-    GLuint _vertex_color_buffer;
+    GLuint _vertex_buffer;
     GLuint _index_buffer;
+
+    //! \brief The whole vertex buffer, when it is persistently mapped.
+    ParticleBufferVertex* _persistent_vertices;
+
+    //! \brief The vertices of the next draw, when the buffer can't be mapped.
+    std::vector<ParticleBufferVertex> _staging_vertices;
+
+#ifndef __APPLE__
+    //! \brief The fences placed when leaving the segments, or nullptr.
+    GLsync _segment_fences[PARTICLE_BUFFER_SEGMENTS];
+#endif
+
+    //! \brief Tells whether the fences can be used.
+    bool _fences_supported;
+
+    //! \brief Set when the ring wrapped without fences: the next mapping orphans the buffer.
+    bool _invalidate_buffer;
+
+    //! \brief The segment being written, and the number of vertices already written in it.
+    unsigned _segment;
+    unsigned _segment_vertices;
+
+    //! \brief The first vertex and the number of vertices of the next draw.
+    unsigned _first_vertex;
+    unsigned _number_of_vertices;
+
+    //! \brief Fences the current segment and moves to the next one, waiting for the GPU to be done with it.
+    void _NextSegment();
+
+    //! \brief Points the vertex attributes to the vertices starting at the given vertex.
+    void _SetVertexAttributes(unsigned first_vertex);
 };
 
 } // namespace gl
@@ -221,6 +221,19 @@ void RenderTarget::Resize(unsigned width,
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+void RenderTarget::SetSmoothFiltering(bool smooth)
+{
+    assert(_texture != 0);
+
+    BindTexture();
+
+    GLint filter = smooth ? GL_LINEAR : GL_NEAREST;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 unsigned RenderTarget::GetWidth() const
 {
     return _width;
@@ -41,6 +41,10 @@ public:
     void Resize(unsigned width,
                 unsigned height);
 
+    //! \brief Sets whether the texture is linearly filtered, or sampled
+    //! with the nearest texel when drawn at another size.
+    void SetSmoothFiltering(bool smooth);
+
     //! \brief Gets the width of the render target.
     unsigned GetWidth() const;
 
@@ -367,11 +367,11 @@ bool ImageDescriptor::SaveMultiImage(const std::vector<StillImage *>& images,
         return false;
     }
 
-    // Initially, we need to grab the Image pointer of the first StillImage, the texture ID of its TextureSheet owner,
+    // Initially, we need to grab the Image pointer of the first StillImage, its TextureSheet owner,
     // and malloc enough memory for the entire sheet so that we can copy over the texture sheet from video memory to
     // system memory.
     ImageTexture *img = images[0]->_image_texture;
-    GLuint tex_id = img->texture_sheet->tex_id;
+    TexSheet *sheet = img->texture_sheet;
 
     ImageMemory texture;
     ImageMemory save;
@@ -388,7 +388,7 @@ bool ImageDescriptor::SaveMultiImage(const std::vector<StillImage *>& images,
         return false;
     }
 
-    TextureManager->_BindTexture(tex_id);
+    TextureManager->_BindTexSheet(sheet);
     texture.GlGetTexImage();
 
     uint32_t i = 0; // i is used to count through the images vector to get the image to save
@@ -396,13 +396,13 @@ bool ImageDescriptor::SaveMultiImage(const std::vector<StillImage *>& images,
         for(uint32_t y = 0; y < grid_columns; y++) {
             img = images[i]->_image_texture;
 
-            // Check if this image has a different texture ID than the last. If it does, we need to re-grab the texture
+            // Check if this image has a different texture sheet than the last. If it does, we need to re-grab the texture
             // memory for the texture sheet that the new image is contained within and store it in the texture.pixels
             // buffer, which is CPU system memory.
-            if(tex_id != img->texture_sheet->tex_id) {
-                // Get new texture ID
-                TextureManager->_BindTexture(img->texture_sheet->tex_id);
-                tex_id = img->texture_sheet->tex_id;
+            if(sheet != img->texture_sheet) {
+                // Get new texture sheet
+                sheet = img->texture_sheet;
+                TextureManager->_BindTexSheet(sheet);
 
                 // If the new texture is bigger, reallocate memory
                 if(texture.GetSize2D() < img->texture_sheet->height * img->texture_sheet->width) {
@@ -462,8 +462,10 @@ void ImageDescriptor::_RemoveTextureReference()
         _texture->texture_sheet->RemoveTexture(_texture);
 
         // If the image exceeds 512 in either width or height, it has an un-shared texture sheet, which we
-        // should now delete that the image is being removed
-        if(_texture->width > 512 || _texture->height > 512) {
+        // should now delete that the image is being removed.
+        // Screen capture sheets are kept resident for the next capture.
+        if(_texture->texture_sheet->type != VIDEO_TEXSHEET_CAPTURE
+                && (_texture->width > 512 || _texture->height > 512)) {
             TextureManager->_RemoveSheet(_texture->texture_sheet);
         }
 //      else {
@@ -563,13 +565,13 @@ void ImageDescriptor::_DrawTexture(const Color* draw_color) const
     if (VideoManager->_current_context.blend) {
         VideoManager->EnableBlending();
         if (VideoManager->_current_context.blend == 1) {
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Normal blending
+            VideoManager->SetNormalBlendFunction();
         } else {
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive blending
+            VideoManager->SetAdditiveBlendFunction();
         }
     } else if (_blend) {
         VideoManager->EnableBlending();
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Normal blending
+        VideoManager->SetNormalBlendFunction();
     } else {
         VideoManager->DisableBlending();
     }
@@ -619,7 +621,7 @@ void ImageDescriptor::_DrawTexture(const Color* draw_color) const
 
         // Enable texturing and bind the texture.
         VideoManager->EnableTexture2D();
-        TextureManager->_BindTexture(_texture->texture_sheet->tex_id);
+        TextureManager->_BindTexSheet(_texture->texture_sheet);
         _texture->texture_sheet->Smooth(_smooth);
 
         // Load the sprite shader program.
@@ -27,6 +27,12 @@
 #include <SDL2/SDL_endian.h>
 #include <png.h>
 
+#if defined(__SSE2__)
+#   include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   include <arm_neon.h>
+#endif
+
 using namespace vt_utils;
 
 namespace vt_video
@@ -66,6 +72,63 @@ void ImageMemory::Resize(size_t width, size_t height, bool is_rgb)
     _pixels.resize(_width * _height * GetBytesPerPixel());
 }
 
+//! \brief Converts a row of ARGB8888 pixels, in little endian, to RGBA
+//! and zeroes the color of the fully transparent pixels.
+static void ConvertARGBRow(const uint8_t* src, uint8_t* dst, uint32_t width)
+{
+    uint32_t x = 0;
+
+#if defined(__SSE2__)
+    const __m128i green_alpha_mask = _mm_set1_epi32(0xFF00FF00);
+    const __m128i low_byte_mask = _mm_set1_epi32(0x000000FF);
+    const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+    const __m128i zero = _mm_setzero_si128();
+
+    // Swap the red and blue bytes of 4 pixels at once.
+    for (; x + 4 <= width; x += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+        __m128i red = _mm_and_si128(_mm_srli_epi32(pixels, 16), low_byte_mask);
+        __m128i blue = _mm_slli_epi32(_mm_and_si128(pixels, low_byte_mask), 16);
+        __m128i converted = _mm_or_si128(_mm_and_si128(pixels, green_alpha_mask), _mm_or_si128(red, blue));
+        __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(pixels, alpha_mask), zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_andnot_si128(transparent, converted));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const uint8x16_t zero = vdupq_n_u8(0);
+
+    // Deinterleave 16 pixels in B, G, R and A vectors.
+    for (; x + 16 <= width; x += 16) {
+        uint8x16x4_t pixels = vld4q_u8(src + x * 4);
+        uint8x16_t transparent = vceqq_u8(pixels.val[3], zero);
+        uint8x16x4_t converted;
+        converted.val[0] = vbicq_u8(pixels.val[2], transparent);
+        converted.val[1] = vbicq_u8(pixels.val[1], transparent);
+        converted.val[2] = vbicq_u8(pixels.val[0], transparent);
+        converted.val[3] = pixels.val[3];
+        vst4q_u8(dst + x * 4, converted);
+    }
+#endif
+
+    for (; x < width; ++x) {
+        const uint8_t* img_pixel = src + x * 4;
+        uint8_t* dst_pixel = dst + x * 4;
+        dst_pixel[0] = img_pixel[2];
+        dst_pixel[1] = img_pixel[1];
+        dst_pixel[2] = img_pixel[0];
+        dst_pixel[3] = img_pixel[3];
+
+        // GL_LINEAR white artifact removal
+        // Make the r,g,b values black to prevent OpenGL to make linear average with
+        // another color when smoothing.
+        // This is removing the white edges often seen on sprites.
+        if (dst_pixel[3] == 0) {
+            dst_pixel[0] = 0;
+            dst_pixel[1] = 0;
+            dst_pixel[2] = 0;
+        }
+    }
+}
+
 bool ImageMemory::LoadImage(const std::string& filename)
 {
     assert(_pixels.empty());
@@ -73,6 +136,21 @@ bool ImageMemory::LoadImage(const std::string& filename)
         IF_PRINT_WARNING(VIDEO_DEBUG) << "_pixels member was not empty upon function invocation" << std::endl;
     }
 
+    // Use the pixels decoded in advance, when the file was preloaded.
+    ImageDecoder& image_decoder = VideoManager->_image_decoder;
+    if (image_decoder.IsRequested(filename))
+        return image_decoder.TakeImage(filename, *this);
+
+    return _DecodeImage(filename);
+}
+
+bool ImageMemory::_DecodeImage(const std::string& filename)
+{
+    // Read the pixels decoded by a previous run, when the file didn't change.
+    const ImageCache& image_cache = VideoManager->_image_cache;
+    if (image_cache.LoadImage(filename, *this))
+        return true;
+
     SDL_Surface* temp_surf = IMG_Load(filename.c_str());
     if (temp_surf == nullptr) {
         PRINT_ERROR << "Couldn't load image file: " << filename << std::endl;
@@ -94,53 +172,47 @@ bool ImageMemory::LoadImage(const std::string& filename)
     Resize(alpha_surf->w, alpha_surf->h, 3 == alpha_surf->format->BytesPerPixel);
 
     // convert the data so that it works in our format
-    uint8_t* img_pixel = nullptr;
-    uint8_t* dst_pixel = nullptr;
+#if SDL_BYTEORDER != SDL_BIG_ENDIAN
+    if (alpha_format) { // ARGB8888
+        for (uint32_t y = 0; y < _height; ++y) {
+            ConvertARGBRow(static_cast<uint8_t *>(alpha_surf->pixels) + y * alpha_surf->pitch,
+                           &_pixels[y * _width * GetBytesPerPixel()], _width);
+        }
+    }
+    else
+#endif
+    {
+        uint8_t* img_pixel = nullptr;
+        uint8_t* dst_pixel = nullptr;
 
-    for (uint32_t y = 0; y < _height; ++y) {
-        for (uint32_t x = 0; x < _width; ++x) {
-            img_pixel = static_cast<uint8_t *>(alpha_surf->pixels) + y * alpha_surf->pitch + x * alpha_surf->format->BytesPerPixel;
-            dst_pixel = &_pixels[(y * _width + x) * GetBytesPerPixel()];
+        for (uint32_t y = 0; y < _height; ++y) {
+            for (uint32_t x = 0; x < _width; ++x) {
+                img_pixel = static_cast<uint8_t *>(alpha_surf->pixels) + y * alpha_surf->pitch + x * alpha_surf->format->BytesPerPixel;
+                dst_pixel = &_pixels[(y * _width + x) * GetBytesPerPixel()];
 #if SDL_BYTEORDER == SDL_BIG_ENDIAN
-            if (alpha_format) {
-                dst_pixel[0] = img_pixel[0];
-                dst_pixel[1] = img_pixel[1];
-                dst_pixel[2] = img_pixel[2];
-                dst_pixel[3] = img_pixel[3];
-            } else {
-                dst_pixel[2] = img_pixel[0];
-                dst_pixel[1] = img_pixel[1];
-                dst_pixel[0] = img_pixel[2];
-                dst_pixel[3] = img_pixel[3];
-            }
-#else
-            if (alpha_format) { // ARGB8888
-#ifdef __APPLE__
-                dst_pixel[3] = img_pixel[3];
-                dst_pixel[0] = img_pixel[2];
-                dst_pixel[1] = img_pixel[1];
-                dst_pixel[2] = img_pixel[0];
+                if (alpha_format) {
+                    dst_pixel[0] = img_pixel[0];
+                    dst_pixel[1] = img_pixel[1];
+                    dst_pixel[2] = img_pixel[2];
+                    dst_pixel[3] = img_pixel[3];
+                } else {
+                    dst_pixel[2] = img_pixel[0];
+                    dst_pixel[1] = img_pixel[1];
+                    dst_pixel[0] = img_pixel[2];
+                    dst_pixel[3] = img_pixel[3];
+                }
 #else
-                dst_pixel[2] = img_pixel[0];
-                dst_pixel[1] = img_pixel[1];
-                dst_pixel[0] = img_pixel[2];
-                dst_pixel[3] = img_pixel[3];
-#endif
-            } else {
                 dst_pixel[0] = img_pixel[0];
                 dst_pixel[1] = img_pixel[1];
                 dst_pixel[2] = img_pixel[2];
                 dst_pixel[3] = img_pixel[3];
-            }
 #endif
-            // GL_LINEAR white artifact removal
-            // Make the r,g,b values black to prevent OpenGL to make linear average with
-            // another color when smoothing.
-            // This is removing the white edges often seen on sprites.
-            if (dst_pixel[3] == 0) {
-                dst_pixel[0] = 0;
-                dst_pixel[1] = 0;
-                dst_pixel[2] = 0;
+                // GL_LINEAR white artifact removal
+                if (dst_pixel[3] == 0) {
+                    dst_pixel[0] = 0;
+                    dst_pixel[1] = 0;
+                    dst_pixel[2] = 0;
+                }
             }
         }
     }
@@ -155,6 +227,8 @@ bool ImageMemory::LoadImage(const std::string& filename)
         alpha_surf = nullptr;
     }
 
+    image_cache.StoreImage(filename, *this);
+
     return true;
 }
 
@@ -376,7 +450,7 @@ void ImageMemory::CopyFromTexture(TexSheet *texture)
                     << std::endl;
     }
 
-    TextureManager->_BindTexture(texture->tex_id);
+    TextureManager->_BindTexSheet(texture);
     glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, &_pixels[0]);
 }
 
@@ -469,6 +543,15 @@ void ImageMemory::GlReadPixels(int32_t x, int32_t y)
                  _rgb_format ? GL_RGB : GL_RGBA, GL_UNSIGNED_BYTE, &_pixels[0]);
 }
 
+void ImageMemory::CopyFromBuffer(const void* buffer)
+{
+    assert(buffer != nullptr);
+    if (_pixels.empty())
+        return;
+
+    memcpy(&_pixels[0], buffer, _pixels.size());
+}
+
 void ImageMemory::VerticalFlip()
 {
     std::vector<uint8_t> flipped;
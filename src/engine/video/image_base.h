@@ -68,13 +68,13 @@ namespace private_video
 *** ***************************************************************************/
 class ImageMemory
 {
+    friend class ImageDecoder;
+    friend class ImageCache;
+
 public:
     ImageMemory();
     explicit ImageMemory(const SDL_Surface* surface);
 
-    ~ImageMemory()
-    {}
-
     size_t GetWidth() const {
         return _width;
     }
@@ -94,6 +94,7 @@ public:
     /** \brief Loads raw image data from a file and stores the data in the class members
     *** \param filename The name of the image file to load.
     *** \return True if the image was loaded successfully, false if it was not
+    *** \note The pixels are taken from the image decoder when the file was preloaded.
     **/
     bool LoadImage(const std::string &filename);
 
@@ -150,6 +151,11 @@ public:
     //! \brief Wrapper of glReadPixels on the image pixels at the given coordinates.
     void GlReadPixels(int32_t x, int32_t y);
 
+    /** \brief Copies raw pixel data matching the current image dimensions and format.
+    *** \param buffer The pixel data, e.g. a mapped pixel buffer object.
+    **/
+    void CopyFromBuffer(const void* buffer);
+
     //! \brief Copy a texture at given pixel coordinates.
     void CopyFrom(const ImageMemory& src, uint32_t src_offset, uint32_t dst_bytes, uint32_t dst_offset);
     void CopyFrom(const ImageMemory& src, uint32_t src_offset);
@@ -169,6 +175,13 @@ private:
 
     //! \brief Set to true if the data is in RGB format, false if the data is in RGBA format.
     bool _rgb_format;
+
+    /** \brief Decodes an image file and stores the data in the class members
+    *** \param filename The name of the image file to decode.
+    *** \return True if the image was decoded successfully, false if it was not
+    *** \note This only uses the image cache of the video engine and can be called from any thread.
+    **/
+    bool _DecodeImage(const std::string &filename);
 }; // class ImageMemory
 
 
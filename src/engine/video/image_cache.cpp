@@ -0,0 +1,334 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2012-2016 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    image_cache.cpp
+*** \author  Yohann Ferreira, yohann ferreira orange fr
+*** \brief   Source file for the ImageCache class.
+*** ***************************************************************************/
+
+#include "image_cache.h"
+
+#include "image_base.h"
+
+#include "utils/utils_common.h"
+#include "utils/utils_files.h"
+#include "utils/utils_strings.h"
+
+#include <SDL2/SDL_thread.h>
+
+#include <sys/stat.h>
+#include <dirent.h>
+#ifndef _WIN32
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <unistd.h>
+#   include <utime.h>
+#else
+#   include <sys/utime.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <vector>
+
+namespace vt_video
+{
+
+namespace private_video
+{
+
+//! \brief Identifies the cache files, and their format version.
+const char IMAGE_CACHE_MAGIC[8] = { 'V', 'T', 'I', 'M', 'G', '0', '0', '1' };
+
+//! \brief The maximum total size of the cache files, in bytes.
+const int32_t IMAGE_CACHE_MAX_SIZE = 128 * 1024 * 1024;
+
+//! \brief The total size the cache is pruned to, leaving room for new images.
+const int32_t IMAGE_CACHE_PRUNED_SIZE = IMAGE_CACHE_MAX_SIZE / 4 * 3;
+
+//! \brief The header of the cache files, followed by the source path and the pixels.
+struct ImageCacheHeader {
+    char magic[8];
+    uint64_t source_size;
+    int64_t source_time;
+    uint32_t width;
+    uint32_t height;
+    uint32_t rgb_format;
+    uint32_t path_length;
+};
+
+//! \brief A cache file found when pruning the cache.
+struct ImageCacheFile {
+    std::string filename;
+    time_t last_use;
+    int32_t size;
+};
+
+//! \brief Sorts the cache files from the most to the least recently used.
+static bool IsMoreRecentlyUsed(const ImageCacheFile& first, const ImageCacheFile& second)
+{
+    return first.last_use > second.last_use;
+}
+
+//! \brief Tells whether a file name ends with the given extension.
+static bool HasExtension(const std::string& name, const std::string& extension)
+{
+    return name.size() > extension.size()
+           && name.compare(name.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+//! \brief Tells whether a cache file still matches its source file.
+static bool IsCacheFileUpToDate(const std::string& cache_filename)
+{
+    std::ifstream input(cache_filename.c_str(), std::ios::binary);
+    ImageCacheHeader header;
+    if (!input.read(reinterpret_cast<char*>(&header), sizeof(header))
+            || memcmp(header.magic, IMAGE_CACHE_MAGIC, sizeof(header.magic)) != 0)
+        return false;
+
+    std::string source_filename(header.path_length, '\0');
+    if (header.path_length == 0 || !input.read(&source_filename[0], header.path_length))
+        return false;
+
+    struct stat source_info;
+    return stat(source_filename.c_str(), &source_info) == 0
+           && header.source_size == static_cast<uint64_t>(source_info.st_size)
+           && header.source_time == static_cast<int64_t>(source_info.st_mtime);
+}
+
+//! \brief Reads a whole cache file, mapped in memory when possible.
+class CacheFileReader
+{
+public:
+    explicit CacheFileReader(const std::string& filename):
+        _data(nullptr),
+        _size(0),
+        _mapped(false)
+    {
+#ifndef _WIN32
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+
+        struct stat file_info;
+        if (fstat(fd, &file_info) == 0 && file_info.st_size > 0) {
+            void* data = mmap(nullptr, file_info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                _data = static_cast<const uint8_t*>(data);
+                _size = file_info.st_size;
+                _mapped = true;
+            }
+        }
+        close(fd);
+#else
+        std::ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
+        if (!file)
+            return;
+
+        _buffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        if (!_buffer.empty() && file.read(reinterpret_cast<char*>(&_buffer[0]), _buffer.size())) {
+            _data = &_buffer[0];
+            _size = _buffer.size();
+        }
+#endif
+    }
+
+    ~CacheFileReader()
+    {
+#ifndef _WIN32
+        if (_mapped)
+            munmap(const_cast<uint8_t*>(_data), _size);
+#endif
+    }
+
+    const uint8_t* GetData() const {
+        return _data;
+    }
+
+    size_t GetSize() const {
+        return _size;
+    }
+
+private:
+    const uint8_t* _data;
+    size_t _size;
+    bool _mapped;
+#ifdef _WIN32
+    std::vector<uint8_t> _buffer;
+#endif
+};
+
+void ImageCache::SetDirectory(const std::string& directory)
+{
+    if (!directory.empty() && !vt_utils::DoesFileExist(directory) && !vt_utils::MakeDirectory(directory)) {
+        PRINT_WARNING << "Couldn't create the image cache directory: " << directory << std::endl;
+        _directory.clear();
+        return;
+    }
+
+    _directory = directory;
+    SDL_AtomicSet(&_size, 0);
+    if (!_directory.empty())
+        _PruneCache();
+}
+
+bool ImageCache::LoadImage(const std::string& filename, ImageMemory& image) const
+{
+    if (_directory.empty())
+        return false;
+
+    struct stat source_info;
+    if (stat(filename.c_str(), &source_info) != 0)
+        return false;
+
+    CacheFileReader reader(_GetCacheFilename(filename));
+    const uint8_t* data = reader.GetData();
+    if (data == nullptr || reader.GetSize() < sizeof(ImageCacheHeader))
+        return false;
+
+    // The cache file is only valid for the current version of the source file.
+    ImageCacheHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, IMAGE_CACHE_MAGIC, sizeof(header.magic)) != 0
+            || header.source_size != static_cast<uint64_t>(source_info.st_size)
+            || header.source_time != static_cast<int64_t>(source_info.st_mtime)
+            || header.path_length != filename.size())
+        return false;
+
+    size_t bytes_per_pixel = header.rgb_format ? 3 : 4;
+    size_t pixels_size = static_cast<size_t>(header.width) * header.height * bytes_per_pixel;
+    size_t pixels_offset = sizeof(header) + header.path_length;
+    if (reader.GetSize() != pixels_offset + pixels_size
+            || memcmp(data + sizeof(header), filename.data(), header.path_length) != 0)
+        return false;
+
+    image.Resize(header.width, header.height, header.rgb_format != 0);
+    image.CopyFromBuffer(data + pixels_offset);
+
+    // The modification time of the cache files tells when they were last used.
+    utime(_GetCacheFilename(filename).c_str(), nullptr);
+    return true;
+}
+
+void ImageCache::StoreImage(const std::string& filename, const ImageMemory& image) const
+{
+    if (_directory.empty() || image._pixels.empty())
+        return;
+
+    struct stat source_info;
+    if (stat(filename.c_str(), &source_info) != 0)
+        return;
+
+    ImageCacheHeader header;
+    memcpy(header.magic, IMAGE_CACHE_MAGIC, sizeof(header.magic));
+    header.source_size = static_cast<uint64_t>(source_info.st_size);
+    header.source_time = static_cast<int64_t>(source_info.st_mtime);
+    header.width = static_cast<uint32_t>(image._width);
+    header.height = static_cast<uint32_t>(image._height);
+    header.rgb_format = image._rgb_format ? 1 : 0;
+    header.path_length = static_cast<uint32_t>(filename.size());
+
+    // Reserve the room in the cache first.
+    int32_t file_size = static_cast<int32_t>(sizeof(header) + filename.size() + image._pixels.size());
+    if (SDL_AtomicAdd(&_size, file_size) + file_size > IMAGE_CACHE_MAX_SIZE) {
+        SDL_AtomicAdd(&_size, -file_size);
+        return;
+    }
+
+    // Write in a temporary file first, so that an interrupted write or
+    // another thread storing the same image never leaves a broken file.
+    std::string cache_filename = _GetCacheFilename(filename);
+    std::string temp_filename = cache_filename + "." + vt_utils::NumberToString(SDL_ThreadID()) + ".tmp";
+    std::ofstream output(temp_filename.c_str(), std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(filename.data(), filename.size());
+    output.write(reinterpret_cast<const char*>(&image._pixels[0]), image._pixels.size());
+    output.close();
+    if (!output) {
+        std::remove(temp_filename.c_str());
+        SDL_AtomicAdd(&_size, -file_size);
+        return;
+    }
+
+    // The replaced cache file leaves the room it took, once and only once removed.
+    struct stat cache_info;
+    if (stat(cache_filename.c_str(), &cache_info) == 0 && std::remove(cache_filename.c_str()) == 0)
+        SDL_AtomicAdd(&_size, -static_cast<int32_t>(cache_info.st_size));
+
+    if (std::rename(temp_filename.c_str(), cache_filename.c_str()) != 0) {
+        std::remove(temp_filename.c_str());
+        SDL_AtomicAdd(&_size, -file_size);
+    }
+}
+
+std::string ImageCache::_GetCacheFilename(const std::string& filename) const
+{
+    std::ostringstream cache_filename;
+    cache_filename << _directory << std::hex << std::hash<std::string>()(filename) << ".rgba";
+    return cache_filename.str();
+}
+
+void ImageCache::_PruneCache()
+{
+    DIR* dir = opendir(_directory.c_str());
+    if (dir == nullptr) {
+        PRINT_WARNING << "Couldn't open the image cache directory: " << _directory << std::endl;
+        return;
+    }
+
+    std::vector<ImageCacheFile> cache_files;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        std::string name = entry->d_name;
+        std::string cache_filename = _directory + name;
+        struct stat file_info;
+        if (stat(cache_filename.c_str(), &file_info) != 0 || !S_ISREG(file_info.st_mode))
+            continue;
+
+        // Removes the leftovers of interrupted writes, and the files of changed or removed images.
+        if (HasExtension(name, ".tmp")
+                || (HasExtension(name, ".rgba") && !IsCacheFileUpToDate(cache_filename))) {
+            std::remove(cache_filename.c_str());
+            continue;
+        }
+
+        if (!HasExtension(name, ".rgba"))
+            continue;
+
+        ImageCacheFile cache_file;
+        cache_file.filename = cache_filename;
+        cache_file.last_use = file_info.st_mtime;
+        cache_file.size = static_cast<int32_t>(std::min<off_t>(file_info.st_size, IMAGE_CACHE_MAX_SIZE));
+        cache_files.push_back(cache_file);
+    }
+    closedir(dir);
+
+    // Keep the most recently used files.
+    std::sort(cache_files.begin(), cache_files.end(), IsMoreRecentlyUsed);
+    int32_t total_size = 0;
+    for (uint32_t i = 0; i < cache_files.size(); ++i) {
+        if (total_size + cache_files[i].size > IMAGE_CACHE_PRUNED_SIZE) {
+            std::remove(cache_files[i].filename.c_str());
+            continue;
+        }
+        total_size += cache_files[i].size;
+    }
+
+    SDL_AtomicSet(&_size, total_size);
+}
+
+} // namespace private_video
+
+} // namespace vt_video
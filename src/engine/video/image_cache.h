@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2012-2016 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    image_cache.h
+*** \author  Yohann Ferreira, yohann ferreira orange fr
+*** \brief   Header file for the ImageCache class.
+***
+*** Decoding PNG files is most of the time spent loading images, and the same
+*** files are decoded again at every launch and every time their texture
+*** sheets are reloaded. The cache stores the decoded pixels in the user data
+*** folder, so that they can be read back directly from then on.
+*** ***************************************************************************/
+
+#ifndef __IMAGE_CACHE_HEADER__
+#define __IMAGE_CACHE_HEADER__
+
+#include <SDL2/SDL_atomic.h>
+
+#include <string>
+
+namespace vt_video
+{
+
+namespace private_video
+{
+
+class ImageMemory;
+
+/** ****************************************************************************
+*** \brief Stores decoded images on disk.
+***
+*** Each image file gets a cache file named after a hash of its path, holding
+*** the path, size and modification time of the source file and the raw
+*** pixels. The cache file is rewritten when the source file changes.
+***
+*** The cache size is capped. When the folder is set, the cache files whose
+*** source file changed or disappeared are removed, and then the least recently
+*** used ones until the cache is back under 3/4 of its cap. No new image is
+*** stored once the cap is reached, until the next pruning.
+***
+*** \note Loading and storing images can be done from any thread, but the
+*** cache folder must be set before images are decoded on worker threads.
+*** ***************************************************************************/
+class ImageCache
+{
+public:
+    ImageCache()
+    {
+        SDL_AtomicSet(&_size, 0);
+    }
+
+    /** \brief Sets the folder where the decoded images are stored.
+    *** \param directory The folder, created if needed. An empty string disables the cache.
+    **/
+    void SetDirectory(const std::string& directory);
+
+    //! \brief Tells whether the cache is used.
+    bool IsEnabled() const {
+        return !_directory.empty();
+    }
+
+    /** \brief Reads the decoded pixels of an image file from the cache.
+    *** \param filename The image file.
+    *** \param image The image receiving the pixels.
+    *** \return False if the image isn't cached or its source file changed.
+    **/
+    bool LoadImage(const std::string& filename, ImageMemory& image) const;
+
+    /** \brief Writes the decoded pixels of an image file in the cache.
+    *** \param filename The image file the pixels were decoded from.
+    *** \param image The decoded pixels.
+    **/
+    void StoreImage(const std::string& filename, const ImageMemory& image) const;
+
+private:
+    //! \brief The folder where the decoded images are stored, empty when the cache is disabled.
+    std::string _directory;
+
+    //! \brief The total size of the cache files, in bytes.
+    mutable SDL_atomic_t _size;
+
+    //! \brief Returns the cache file used for an image file.
+    std::string _GetCacheFilename(const std::string& filename) const;
+
+    //! \brief Removes the outdated cache files, and the least recently used ones above the size cap.
+    void _PruneCache();
+};
+
+} // namespace private_video
+
+} // namespace vt_video
+
+#endif // __IMAGE_CACHE_HEADER__
@@ -0,0 +1,211 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2012-2016 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    image_decoder.cpp
+*** \author  Yohann Ferreira, yohann ferreira orange fr
+*** \brief   Source file for the ImageDecoder class.
+*** ***************************************************************************/
+
+#include "image_decoder.h"
+
+#include "video.h"
+
+#include "utils/utils_common.h"
+
+#include <SDL2/SDL_cpuinfo.h>
+#include <SDL2/SDL_image.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace vt_video
+{
+
+namespace private_video
+{
+
+//! \brief The maximum number of image decoding threads.
+const int32_t IMAGE_DECODER_MAX_THREADS = 4;
+
+ImageDecoder::ImageDecoder():
+    _mutex(nullptr),
+    _job_queued(nullptr),
+    _job_done(nullptr),
+    _quit(false)
+{
+}
+
+ImageDecoder::~ImageDecoder()
+{
+    if (_mutex != nullptr) {
+        SDL_LockMutex(_mutex);
+        _quit = true;
+        SDL_CondBroadcast(_job_queued);
+        SDL_UnlockMutex(_mutex);
+    }
+
+    for (uint32_t i = 0; i < _threads.size(); ++i)
+        SDL_WaitThread(_threads[i], nullptr);
+    _threads.clear();
+
+    // No job is being decoded anymore.
+    for (std::map<std::string, DecodingJob*>::iterator it = _jobs.begin(); it != _jobs.end(); ++it)
+        delete it->second;
+    _jobs.clear();
+    _queue.clear();
+
+    if (_mutex != nullptr) {
+        SDL_DestroyCond(_job_done);
+        SDL_DestroyCond(_job_queued);
+        SDL_DestroyMutex(_mutex);
+    }
+}
+
+void ImageDecoder::RequestImages(const std::vector<std::string>& filenames)
+{
+    _StartThreads();
+
+    if (_threads.empty()) {
+        // Without worker threads, the images are simply decoded when loaded.
+        return;
+    }
+
+    SDL_LockMutex(_mutex);
+    for (uint32_t i = 0; i < filenames.size(); ++i) {
+        if (_jobs.find(filenames[i]) != _jobs.end())
+            continue;
+
+        DecodingJob* job = new DecodingJob();
+        job->filename = filenames[i];
+        job->state = JOB_QUEUED;
+        job->success = false;
+        job->discarded = false;
+
+        _jobs[job->filename] = job;
+        _queue.push_back(job);
+    }
+    SDL_CondBroadcast(_job_queued);
+    SDL_UnlockMutex(_mutex);
+}
+
+bool ImageDecoder::TakeImage(const std::string& filename, ImageMemory& image)
+{
+    std::map<std::string, DecodingJob*>::iterator it = _jobs.find(filename);
+    if (it == _jobs.end()) {
+        IF_PRINT_WARNING(VIDEO_DEBUG) << "the image wasn't requested: " << filename << std::endl;
+        return image._DecodeImage(filename);
+    }
+
+    DecodingJob* job = it->second;
+
+    SDL_LockMutex(_mutex);
+    _jobs.erase(it);
+
+    // No worker thread got to it yet: it is faster to decode it here than to wait.
+    if (job->state == JOB_QUEUED) {
+        _queue.erase(std::find(_queue.begin(), _queue.end(), job));
+        SDL_UnlockMutex(_mutex);
+
+        delete job;
+        return image._DecodeImage(filename);
+    }
+
+    while (job->state != JOB_DONE)
+        SDL_CondWait(_job_done, _mutex);
+    SDL_UnlockMutex(_mutex);
+
+    bool success = job->success;
+    if (success)
+        image = std::move(job->image);
+    delete job;
+
+    return success;
+}
+
+void ImageDecoder::Clear()
+{
+    if (_mutex == nullptr)
+        return;
+
+    SDL_LockMutex(_mutex);
+    for (std::map<std::string, DecodingJob*>::iterator it = _jobs.begin(); it != _jobs.end(); ++it) {
+        DecodingJob* job = it->second;
+        if (job->state == JOB_DECODING)
+            job->discarded = true;
+        else
+            delete job;
+    }
+    _jobs.clear();
+    _queue.clear();
+    SDL_UnlockMutex(_mutex);
+}
+
+void ImageDecoder::_StartThreads()
+{
+    if (_mutex != nullptr)
+        return;
+
+    _mutex = SDL_CreateMutex();
+    _job_queued = SDL_CreateCond();
+    _job_done = SDL_CreateCond();
+
+    // SDL_image loads its format libraries on demand, which isn't thread-safe.
+    IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);
+
+    // Leave a core to the main thread.
+    int32_t thread_count = std::min(std::max(SDL_GetCPUCount() - 1, 1), IMAGE_DECODER_MAX_THREADS);
+    for (int32_t i = 0; i < thread_count; ++i) {
+        SDL_Thread* thread = SDL_CreateThread(_DecodeImages, "image decoder", this);
+        if (thread == nullptr) {
+            IF_PRINT_WARNING(VIDEO_DEBUG) << "could not start an image decoding thread: "
+                                          << SDL_GetError() << std::endl;
+            break;
+        }
+        _threads.push_back(thread);
+    }
+}
+
+int ImageDecoder::_DecodeImages(void* data)
+{
+    ImageDecoder* decoder = static_cast<ImageDecoder*>(data);
+
+    SDL_LockMutex(decoder->_mutex);
+    while (true) {
+        while (!decoder->_quit && decoder->_queue.empty())
+            SDL_CondWait(decoder->_job_queued, decoder->_mutex);
+
+        if (decoder->_quit)
+            break;
+
+        DecodingJob* job = decoder->_queue.front();
+        decoder->_queue.pop_front();
+        job->state = JOB_DECODING;
+        SDL_UnlockMutex(decoder->_mutex);
+
+        bool success = job->image._DecodeImage(job->filename);
+
+        SDL_LockMutex(decoder->_mutex);
+        if (job->discarded) {
+            delete job;
+        }
+        else {
+            job->success = success;
+            job->state = JOB_DONE;
+            SDL_CondBroadcast(decoder->_job_done);
+        }
+    }
+    SDL_UnlockMutex(decoder->_mutex);
+
+    return 0;
+}
+
+} // namespace private_video
+
+} // namespace vt_video
@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2012-2016 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    image_decoder.h
+*** \author  Yohann Ferreira, yohann ferreira orange fr
+*** \brief   Header file for the ImageDecoder class.
+***
+*** Maps, battles and menus load dozens of image files in a row, and decoding
+*** them is most of their loading time. The images known in advance can be
+*** requested in a batch: they are decoded by a pool of worker threads while
+*** the main thread goes on, and ImageMemory::LoadImage() picks the decoded
+*** pixels up instead of decoding the files again. The texture uploads stay
+*** on the main thread.
+*** ***************************************************************************/
+
+#ifndef __IMAGE_DECODER_HEADER__
+#define __IMAGE_DECODER_HEADER__
+
+#include "image_base.h"
+
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_mutex.h>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vt_video
+{
+
+namespace private_video
+{
+
+/** ****************************************************************************
+*** \brief Decodes batches of image files on worker threads.
+***
+*** \note Only the main thread may request and take images. The worker threads
+*** are started with the first request.
+*** ***************************************************************************/
+class ImageDecoder
+{
+public:
+    ImageDecoder();
+
+    //! \brief Stops the worker threads and frees the images nobody took.
+    ~ImageDecoder();
+
+    /** \brief Queues image files to be decoded by the worker threads.
+    *** \param filenames The image files. The ones already requested are skipped.
+    **/
+    void RequestImages(const std::vector<std::string>& filenames);
+
+    //! \brief Tells whether an image file was requested and not taken yet.
+    bool IsRequested(const std::string& filename) const {
+        return _jobs.find(filename) != _jobs.end();
+    }
+
+    /** \brief Gives the pixels of a requested image.
+    *** \param filename The image file, which must have been requested.
+    *** \param image The image receiving the pixels.
+    *** \return False if the image couldn't be decoded.
+    ***
+    *** Waits for the image when it is being decoded, and decodes it directly
+    *** when no worker thread got to it yet.
+    **/
+    bool TakeImage(const std::string& filename, ImageMemory& image);
+
+    //! \brief Drops the queued requests and the decoded images nobody took.
+    void Clear();
+
+private:
+    //! \brief The states of a decoding job.
+    enum JOB_STATE {
+        JOB_QUEUED,
+        JOB_DECODING,
+        JOB_DONE
+    };
+
+    //! \brief An image file to decode.
+    struct DecodingJob {
+        std::string filename;
+        ImageMemory image;
+        JOB_STATE state;
+        bool success;
+
+        //! \brief Set when the job was dropped while being decoded: the worker thread frees it.
+        bool discarded;
+    };
+
+    //! \brief The worker threads.
+    std::vector<SDL_Thread*> _threads;
+
+    //! \brief Protects the jobs and the queue.
+    SDL_mutex* _mutex;
+
+    //! \brief Signaled when jobs are queued or when the worker threads must stop.
+    SDL_cond* _job_queued;
+
+    //! \brief Signaled when a job is decoded.
+    SDL_cond* _job_done;
+
+    //! \brief The jobs waiting for a worker thread.
+    std::deque<DecodingJob*> _queue;
+
+    //! \brief All the jobs not taken yet, indexed by filename.
+    std::map<std::string, DecodingJob*> _jobs;
+
+    //! \brief Tells the worker threads to stop.
+    bool _quit;
+
+    //! \brief Starts the worker threads, once.
+    void _StartThreads();
+
+    //! \brief The worker threads function.
+    static int _DecodeImages(void* data);
+};
+
+} // namespace private_video
+
+} // namespace vt_video
+
+#endif // __IMAGE_DECODER_HEADER__
@@ -52,25 +52,6 @@ public:
     float _z;
 };
 
-/*!***************************************************************************
- *  \brief this is used in texture coordinate array for DrawArrays()
- *         Unless animated particles are used, this can be generated just once
- *****************************************************************************/
-
-class ParticleTexCoord
-{
-public:
-    ParticleTexCoord():
-        _t0(0.0f),
-        _t1(0.0f)
-    {
-    }
-
-    //! The texture coordinates of a vertex of the particle's quad.
-    float _t0;
-    float _t1;
-};
-
 /*!***************************************************************************
  *  \brief this is the structure we use to represent a particle
  *****************************************************************************/
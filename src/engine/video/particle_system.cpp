@@ -19,9 +19,11 @@
 
 #include "particle_keyframe.h"
 #include "engine/video/video.h"
+#include "engine/video/gl/gl_particle_system.h"
 
 #include "utils/utils_random.h"
 
+#include <algorithm>
 #include <cassert>
 
 using namespace vt_utils;
@@ -31,6 +33,21 @@ using namespace vt_common;
 namespace vt_mode_manager
 {
 
+//! \brief Writes a vertex of a particle quad.
+static inline void SetVertex(gl::ParticleBufferVertex& vertex, const ParticleVertex& position,
+                             float u, float v, const Color& color)
+{
+    vertex.x = position._x;
+    vertex.y = position._y;
+    vertex.z = position._z;
+    vertex.u = u;
+    vertex.v = v;
+    vertex.r = color[0];
+    vertex.g = color[1];
+    vertex.b = color[2];
+    vertex.a = color[3];
+}
+
 bool ParticleSystem::_Create(ParticleSystemDef *sys_def)
 {
     // Make sure the system def is valid before initializing.
@@ -45,8 +62,6 @@ bool ParticleSystem::_Create(ParticleSystemDef *sys_def)
 
     _particles.resize(_system_def->max_particles);
     _particle_vertices.resize(_system_def->max_particles * 4);
-    _particle_texcoords.resize(_system_def->max_particles * 4);
-    _particle_colors.resize(_system_def->max_particles * 4);
 
     _alive = true;
     _stopped = false;
@@ -81,9 +96,9 @@ void ParticleSystem::Draw()
         VideoManager->EnableBlending();
 
         if (_system_def->blend_mode == VIDEO_BLEND)
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            VideoManager->SetNormalBlendFunction();
         else
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive.
+            VideoManager->SetAdditiveBlendFunction();
     }
 
     if (_system_def->use_stencil) {
@@ -114,15 +129,10 @@ void ParticleSystem::Draw()
 
     StillImage* id = _animation.GetFrame(_animation.GetCurrentFrameIndex());
     private_video::ImageTexture* img = id->_image_texture;
-    TextureManager->_BindTexture(img->texture_sheet->tex_id);
+    TextureManager->_BindTexSheet(img->texture_sheet);
 
     float frame_progress = _animation.GetPercentProgress();
 
-    float u1 = img->u1;
-    float u2 = img->u2;
-    float v1 = img->v1;
-    float v2 = img->v2;
-
     float img_width  = static_cast<float>(img->width);
     float img_height = static_cast<float>(img->height);
 
@@ -221,60 +231,12 @@ void ParticleSystem::Draw()
         }
     }
 
-    // Fill the color array.
-
-    int32_t c = 0;
-    for (int32_t j = 0; j < _num_particles; ++j) {
-        Color color = _particles[j].color;
-
-        if (_system_def->smooth_animation)
-            color = color * (1.0f - frame_progress);
-
-        _particle_colors[c] = color;
-        ++c;
-        _particle_colors[c] = color;
-        ++c;
-        _particle_colors[c] = color;
-        ++c;
-        _particle_colors[c] = color;
-        ++c;
-    }
-
-    // Fill the texture coordinate array.
-
-    int32_t t = 0;
-    for (int32_t j = 0; j < _num_particles; ++j) {
-        // The upper-left vertex.
-        _particle_texcoords[t]._t0 = u1;
-        _particle_texcoords[t]._t1 = v1;
-        ++t;
-
-        // The upper-right vertex.
-        _particle_texcoords[t]._t0 = u2;
-        _particle_texcoords[t]._t1 = v1;
-        ++t;
-
-        // The lower-right vertex.
-        _particle_texcoords[t]._t0 = u2;
-        _particle_texcoords[t]._t1 = v2;
-        ++t;
-
-        // The lower-left vertex.
-        _particle_texcoords[t]._t0 = u1;
-        _particle_texcoords[t]._t1 = v2;
-        ++t;
-    }
-
     // Load the sprite shader program.
     gl::ShaderProgram* shader_program = VideoManager->LoadShaderProgram(gl::shader_programs::Sprite);
     assert(shader_program != nullptr);
 
     // Draw the particle system.
-    VideoManager->DrawParticleSystem(shader_program,
-                                     reinterpret_cast<float*>(&_particle_vertices[0]),
-                                     reinterpret_cast<float*>(&_particle_texcoords[0]),
-                                     reinterpret_cast<float*>(&_particle_colors[0]),
-                                     _num_particles * 4);
+    _DrawVertices(shader_program, img, _system_def->smooth_animation ? 1.0f - frame_progress : 1.0f);
 
     if (_system_def->smooth_animation) {
         uint32_t findex = _animation.GetCurrentFrameIndex();
@@ -282,63 +244,47 @@ void ParticleSystem::Draw()
 
         StillImage *id2 = _animation.GetFrame(findex);
         private_video::ImageTexture *img2 = id2->_image_texture;
-        TextureManager->_BindTexture(img2->texture_sheet->tex_id);
-
-        u1 = img2->u1;
-        u2 = img2->u2;
-        v1 = img2->v1;
-        v2 = img2->v2;
-
-        t = 0;
-        for (int32_t j = 0; j < _num_particles; ++j) {
-            // The upper-left vertex.
-            _particle_texcoords[t]._t0 = u1;
-            _particle_texcoords[t]._t1 = v1;
-            ++t;
-
-            // The upper-right vertex.
-            _particle_texcoords[t]._t0 = u2;
-            _particle_texcoords[t]._t1 = v1;
-            ++t;
-
-            // The lower-right vertex.
-            _particle_texcoords[t]._t0 = u2;
-            _particle_texcoords[t]._t1 = v2;
-            ++t;
-
-            // The lower-left vertex.
-            _particle_texcoords[t]._t0 = u1;
-            _particle_texcoords[t]._t1 = v2;
-            ++t;
-        }
-
-        c = 0;
-        for (int32_t j = 0; j < _num_particles; ++j) {
-            Color color = _particles[j].color;
-            color = color * frame_progress;
-
-            _particle_colors[c] = color;
-            ++c;
-            _particle_colors[c] = color;
-            ++c;
-            _particle_colors[c] = color;
-            ++c;
-            _particle_colors[c] = color;
-            ++c;
-        }
+        TextureManager->_BindTexSheet(img2->texture_sheet);
 
         // Draw the particle system.
-        VideoManager->DrawParticleSystem(shader_program,
-                                         reinterpret_cast<float*>(&_particle_vertices[0]),
-                                         reinterpret_cast<float*>(&_particle_texcoords[0]),
-                                         reinterpret_cast<float*>(&_particle_colors[0]),
-                                         _num_particles * 4);
+        _DrawVertices(shader_program, img2, frame_progress);
     }
 
     // Unload the shader program.
     VideoManager->UnloadShaderProgram();
 }
 
+void ParticleSystem::_DrawVertices(gl::ShaderProgram* shader_program,
+                                   const private_video::ImageTexture* img,
+                                   float color_factor)
+{
+    const float u1 = img->u1;
+    const float u2 = img->u2;
+    const float v1 = img->v1;
+    const float v2 = img->v2;
+
+    // Write the vertices directly into the video engine memory, in as many
+    // draws as needed for the biggest systems.
+    const int32_t max_particles = static_cast<int32_t>(VideoManager->GetMaxParticleVertices() / 4);
+
+    for (int32_t first = 0; first < _num_particles; first += max_particles) {
+        const int32_t num_particles = std::min(_num_particles - first, max_particles);
+        gl::ParticleBufferVertex* vertices = VideoManager->MapParticleVertices(num_particles * 4);
+
+        int32_t v = first * 4;
+        for (int32_t j = first; j < first + num_particles; ++j) {
+            const Color color = _particles[j].color * color_factor;
+
+            SetVertex(*vertices++, _particle_vertices[v++], u1, v1, color); // The upper-left vertex.
+            SetVertex(*vertices++, _particle_vertices[v++], u2, v1, color); // The upper-right vertex.
+            SetVertex(*vertices++, _particle_vertices[v++], u2, v2, color); // The lower-right vertex.
+            SetVertex(*vertices++, _particle_vertices[v++], u1, v2, color); // The lower-left vertex.
+        }
+
+        VideoManager->DrawParticleSystem(shader_program);
+    }
+}
+
 //-----------------------------------------------------------------------------
 // Update: updates particle positions and properties, and emits/kills particles
 //-----------------------------------------------------------------------------
@@ -35,6 +35,14 @@
 
 #include "engine/video/image.h"
 
+namespace vt_video
+{
+namespace gl
+{
+class ShaderProgram;
+}
+}
+
 namespace vt_mode_manager
 {
 
@@ -393,6 +401,16 @@ private:
      */
     void _RespawnParticle(int32_t i, const EffectParameters &params);
 
+    /*!
+     *  \brief streams the particle quads to the video engine and draws them
+     * \param shader_program the shader program to draw with
+     * \param img the texture of the current animation frame
+     * \param color_factor the factor applied to the particle colors
+     */
+    void _DrawVertices(vt_video::gl::ShaderProgram *shader_program,
+                       const vt_video::private_video::ImageTexture *img,
+                       float color_factor);
+
     //! The system definition, contains information like the emitter properties, lifetime of
     //! particles, particle keyframes, etc. Basically everything which isn't instance-specific
     //! Note that this pointer shouldn't be deleted by the particle system, since it's handled by
@@ -406,14 +424,12 @@ private:
     //! we might set a particle quota for the system which is higher than what's actually there.)
     int32_t _num_particles;
 
-    //! The array of particle vertices. Note that this array contains FOUR vertices per particle.
-    //! This is used for rendering the particles with OpenGL
+    //! The corners of the particle quads, computed on update. Note that this array contains
+    //! FOUR vertices per particle. They are written along with the texture coordinates and
+    //! colors in the shared particle vertex buffer when drawing.
     std::vector<ParticleVertex> _particle_vertices;
-    std::vector<vt_video::Color> _particle_colors;
-    std::vector<ParticleTexCoord> _particle_texcoords;
 
-    //! This array holds everything except positions and colors. The reason we keep positions and
-    //! colors separate is so that they can be efficiently fed to OpenGL for rendering.
+    //! This array holds everything else about the particles.
     std::vector<Particle> _particles;
 
     //! if stopped is true, no new particles should be emitted
@@ -0,0 +1,224 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2012-2016 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    screenshot.cpp
+*** \author  Yohann Ferreira, yohann ferreira orange fr
+*** \brief   Source file for the ScreenshotWriter class.
+*** ***************************************************************************/
+
+#include "screenshot.h"
+
+#include "video.h"
+
+#include "utils/utils_common.h"
+
+#include <cassert>
+
+namespace vt_video
+{
+
+namespace private_video
+{
+
+//! \brief The number of frames to let the GPU complete a readback before mapping its buffer.
+const uint32_t SCREENSHOT_READBACK_FRAMES = 2;
+
+//! \brief Screenshots are saved without alpha channel.
+const uint32_t SCREENSHOT_BYTES_PER_PIXEL = 3;
+
+//! \brief Tells whether pixel buffer objects can be used on the current GL context.
+static bool IsPixelBufferSupported()
+{
+#ifdef __APPLE__
+    // OpenGL 2.1 is always available there.
+    return true;
+#else
+    return GLEW_VERSION_2_1 || GLEW_ARB_pixel_buffer_object;
+#endif
+}
+
+ScreenshotWriter::ScreenshotWriter()
+{
+}
+
+ScreenshotWriter::~ScreenshotWriter()
+{
+    // The pixel buffers must have been released by Clear() while the GL context
+    // was still current: it may be gone by now.
+    if (!_pending_readbacks.empty()) {
+        IF_PRINT_WARNING(VIDEO_DEBUG) << "Pending screenshot readbacks weren't released: "
+                                      << _pending_readbacks.size() << std::endl;
+        _pending_readbacks.clear();
+    }
+
+    // Let the worker threads finish writing their files.
+    for (uint32_t i = 0; i < _encoding_jobs.size(); ++i) {
+        SDL_WaitThread(_encoding_jobs[i]->thread, nullptr);
+        delete _encoding_jobs[i];
+    }
+    _encoding_jobs.clear();
+}
+
+void ScreenshotWriter::Clear()
+{
+    for (uint32_t i = 0; i < _pending_readbacks.size(); ++i) {
+        const GLuint buffers[] = { _pending_readbacks[i].buffer };
+        glDeleteBuffers(1, buffers);
+    }
+    _pending_readbacks.clear();
+}
+
+bool ScreenshotWriter::RequestScreenshot(const std::string& filename, const ScreenRect& screen_rect)
+{
+    if (screen_rect.width <= 0 || screen_rect.height <= 0) {
+        IF_PRINT_WARNING(VIDEO_DEBUG) << "Invalid screen area for screenshot: " << filename << std::endl;
+        return false;
+    }
+
+    const uint32_t width = static_cast<uint32_t>(screen_rect.width);
+    const uint32_t height = static_cast<uint32_t>(screen_rect.height);
+
+    // The rows are tightly packed, as RGB rows aren't always 4-bytes aligned.
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    // Fallback: read the pixels synchronously, but still encode in the background.
+    if (!IsPixelBufferSupported()) {
+        EncodingJob* job = new EncodingJob();
+        job->filename = filename;
+        job->image.Resize(width, height, true);
+        job->image.GlReadPixels(screen_rect.left, screen_rect.top);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+        if (VideoManager->CheckGLError()) {
+            IF_PRINT_WARNING(VIDEO_DEBUG) << "An OpenGL error occured: "
+                                          << VideoManager->CreateGLErrorString() << std::endl;
+            delete job;
+            return false;
+        }
+
+        _StartEncodingJob(job);
+        return true;
+    }
+
+    PendingReadback readback;
+    readback.filename = filename;
+    readback.buffer = 0;
+    readback.width = width;
+    readback.height = height;
+    readback.frames_left = SCREENSHOT_READBACK_FRAMES;
+
+    glGenBuffers(1, &readback.buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, width * height * SCREENSHOT_BYTES_PER_PIXEL,
+                 nullptr, GL_STREAM_READ);
+
+    // With a pack buffer bound, the last parameter is an offset in the buffer
+    // and the call returns without waiting for the pixels.
+    glReadPixels(screen_rect.left, screen_rect.top, width, height,
+                 GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    if (VideoManager->CheckGLError()) {
+        IF_PRINT_WARNING(VIDEO_DEBUG) << "An OpenGL error occured: "
+                                      << VideoManager->CreateGLErrorString() << std::endl;
+        const GLuint buffers[] = { readback.buffer };
+        glDeleteBuffers(1, buffers);
+        return false;
+    }
+
+    _pending_readbacks.push_back(readback);
+    return true;
+}
+
+void ScreenshotWriter::Update()
+{
+    // Map the readbacks the GPU had time to complete.
+    std::vector<PendingReadback>::iterator it = _pending_readbacks.begin();
+    while (it != _pending_readbacks.end()) {
+        if (it->frames_left > 0) {
+            --it->frames_left;
+            ++it;
+            continue;
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, it->buffer);
+        const void* pixels = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+
+        if (pixels != nullptr) {
+            EncodingJob* job = new EncodingJob();
+            job->filename = it->filename;
+            job->image.Resize(it->width, it->height, true);
+            job->image.CopyFromBuffer(pixels);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+            _StartEncodingJob(job);
+        }
+        else {
+            PRINT_WARNING << "Couldn't map the screenshot pixel buffer for: "
+                          << it->filename << std::endl;
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        const GLuint buffers[] = { it->buffer };
+        glDeleteBuffers(1, buffers);
+        it = _pending_readbacks.erase(it);
+    }
+
+    // Clean up the finished encoding jobs.
+    std::vector<EncodingJob*>::iterator job_it = _encoding_jobs.begin();
+    while (job_it != _encoding_jobs.end()) {
+        EncodingJob* job = *job_it;
+        if (SDL_AtomicGet(&job->done) == 0) {
+            ++job_it;
+            continue;
+        }
+
+        SDL_WaitThread(job->thread, nullptr);
+        delete job;
+        job_it = _encoding_jobs.erase(job_it);
+    }
+}
+
+void ScreenshotWriter::_StartEncodingJob(EncodingJob* job)
+{
+    assert(job != nullptr);
+    SDL_AtomicSet(&job->done, 0);
+
+    job->thread = SDL_CreateThread(_EncodeScreenshot, "screenshot", job);
+    if (job->thread == nullptr) {
+        // No thread available: do the work right away.
+        IF_PRINT_WARNING(VIDEO_DEBUG) << "Couldn't create the screenshot thread: "
+                                      << SDL_GetError() << std::endl;
+        _EncodeScreenshot(job);
+        delete job;
+        return;
+    }
+
+    _encoding_jobs.push_back(job);
+}
+
+int ScreenshotWriter::_EncodeScreenshot(void* data)
+{
+    EncodingJob* job = static_cast<EncodingJob*>(data);
+
+    // OpenGL returns the rows bottom to top.
+    job->image.VerticalFlip();
+    bool success = job->image.SaveImage(job->filename);
+
+    SDL_AtomicSet(&job->done, 1);
+    return success ? 0 : -1;
+}
+
+} // namespace private_video
+
+} // namespace vt_video
@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2012-2016 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    screenshot.h
+*** \author  Yohann Ferreira, yohann ferreira orange fr
+*** \brief   Header file for the ScreenshotWriter class.
+***
+*** Screenshots are read back from the framebuffer into pixel buffer objects,
+*** which lets the GPU transfer the pixels while the game keeps running. The
+*** pixels are fetched a few frames later and encoded to PNG on a worker
+*** thread, so that taking a screenshot doesn't stall the main loop.
+*** ***************************************************************************/
+
+#ifndef __SCREENSHOT_HEADER__
+#define __SCREENSHOT_HEADER__
+
+#include "image_base.h"
+#include "screen_rect.h"
+
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_atomic.h>
+
+#include <string>
+#include <vector>
+
+namespace vt_video
+{
+
+namespace private_video
+{
+
+/** ****************************************************************************
+*** \brief Reads screenshots back asynchronously and saves them in the background.
+***
+*** Requests go through two stages: a pending readback, waiting for the GPU
+*** to fill its pixel buffer object, then an encoding job, during which a
+*** worker thread flips the image and writes the PNG file.
+***
+*** \note When pixel buffer objects aren't supported, the pixels are read
+*** synchronously, but the PNG encoding is still done on a worker thread.
+*** ***************************************************************************/
+class ScreenshotWriter
+{
+public:
+    ScreenshotWriter();
+
+    //! \brief Waits for the running encoding jobs. Clear() must have been called before.
+    ~ScreenshotWriter();
+
+    /** \brief Starts reading back the given screen area to save it in a file.
+    *** \param filename The full filename of the PNG file to write.
+    *** \param screen_rect The screen area to read, in pixels.
+    *** \return False if the readback could not be started.
+    **/
+    bool RequestScreenshot(const std::string& filename, const ScreenRect& screen_rect);
+
+    /** \brief Fetches the completed readbacks, starts their encoding jobs,
+    *** and cleans up the finished ones. Must be called once per frame.
+    **/
+    void Update();
+
+    //! \brief Releases all the pending pixel buffers. Used when the GL context is going away.
+    void Clear();
+
+private:
+    //! \brief A framebuffer readback waiting for the GPU transfer to complete.
+    struct PendingReadback {
+        std::string filename;
+
+        //! \brief The pixel buffer object receiving the pixels.
+        GLuint buffer;
+
+        uint32_t width;
+        uint32_t height;
+
+        //! \brief The number of frames to wait before mapping the buffer.
+        uint32_t frames_left;
+    };
+
+    //! \brief A screenshot being flipped and written by a worker thread.
+    struct EncodingJob {
+        std::string filename;
+        ImageMemory image;
+        SDL_Thread* thread;
+
+        //! \brief Set to 1 by the worker thread once the file is written.
+        SDL_atomic_t done;
+    };
+
+    //! \brief The readbacks still in flight.
+    std::vector<PendingReadback> _pending_readbacks;
+
+    //! \brief The encoding jobs running or waiting to be cleaned up.
+    std::vector<EncodingJob*> _encoding_jobs;
+
+    //! \brief Starts the worker thread of a job whose image is filled, and takes ownership of it.
+    void _StartEncodingJob(EncodingJob* job);
+
+    //! \brief The worker thread entry point, data being an EncodingJob.
+    static int _EncodeScreenshot(void* data);
+};
+
+} // namespace private_video
+
+} // namespace vt_video
+
+#endif // __SCREENSHOT_HEADER__
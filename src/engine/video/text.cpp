@@ -34,6 +34,8 @@
 #   include <SDL2/SDL_ttf.h>
 #endif
 
+#include <algorithm>
+
 // The script filename used to configure the text styles used in game.
 const std::string _font_script_filename = "data/config/fonts.lua";
 
@@ -49,6 +51,24 @@ TextSupervisor *TextManager = nullptr;
 const uint16_t NEW_LINE = '\n';
 const uint16_t SPACE_CHAR = 0x20;
 
+//! \brief The maximum number of wrapping results kept per font.
+const uint32_t WRAPPED_TEXT_CACHE_SIZE = 256;
+
+//! \brief Returns the key of a wrapping result in the font cache.
+static size_t GetWrappedTextKey(const ustring& text, uint32_t max_width, bool interwords_spaces)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    const uint16_t* characters = text.c_str();
+    for (size_t i = 0; i < text.length(); ++i) {
+        hash ^= characters[i];
+        hash *= 1099511628211ULL;
+    }
+    hash ^= (static_cast<uint64_t>(max_width) << 1) | (interwords_spaces ? 1 : 0);
+    hash *= 1099511628211ULL;
+    return static_cast<size_t>(hash);
+}
+
 // -----------------------------------------------------------------------------
 // FontProperties class
 // -----------------------------------------------------------------------------
@@ -75,6 +95,91 @@ void FontProperties::ClearFont()
         TTF_CloseFont(ttf_font);
 
     ttf_font = nullptr;
+
+    // The cached metrics belonged to the font.
+    _glyph_metrics.clear();
+    _kernings.clear();
+    _wrapped_texts.clear();
+}
+
+const FontProperties::GlyphMetrics& FontProperties::GetGlyphMetrics(uint16_t glyph)
+{
+    auto it = _glyph_metrics.find(glyph);
+    if (it != _glyph_metrics.end())
+        return it->second;
+
+    int min_x = 0;
+    int max_x = 0;
+    int advance = 0;
+    if (ttf_font == nullptr ||
+            TTF_GlyphMetrics(ttf_font, glyph, &min_x, &max_x, nullptr, nullptr, &advance) != 0) {
+        // Glyphs missing from the font take no room.
+        min_x = 0;
+        max_x = 0;
+        advance = 0;
+    }
+
+    GlyphMetrics& metrics = _glyph_metrics[glyph];
+    metrics.min_x = min_x;
+    metrics.max_x = max_x;
+    metrics.advance = advance;
+    return metrics;
+}
+
+int32_t FontProperties::GetKerning(uint16_t previous_glyph, uint16_t glyph)
+{
+#if SDL_VERSIONNUM(SDL_TTF_MAJOR_VERSION, SDL_TTF_MINOR_VERSION, SDL_TTF_PATCHLEVEL) >= SDL_VERSIONNUM(2, 0, 14)
+    if (ttf_font == nullptr || TTF_GetFontKerning(ttf_font) == 0)
+        return 0;
+
+    uint32_t pair = (static_cast<uint32_t>(previous_glyph) << 16) | glyph;
+    auto it = _kernings.find(pair);
+    if (it != _kernings.end())
+        return it->second;
+
+    int32_t kerning = TTF_GetFontKerningSizeGlyphs(ttf_font, previous_glyph, glyph);
+    _kernings[pair] = kerning;
+    return kerning;
+#else
+    // Older SDL_ttf versions only give the kerning of glyph indices,
+    // which aren't known here.
+    (void)previous_glyph;
+    (void)glyph;
+    return 0;
+#endif
+}
+
+const std::vector<ustring>* FontProperties::GetWrappedText(const ustring& text,
+                                                            uint32_t max_width,
+                                                            bool interwords_spaces) const
+{
+    auto it = _wrapped_texts.find(GetWrappedTextKey(text, max_width, interwords_spaces));
+    if (it == _wrapped_texts.end())
+        return nullptr;
+
+    // Check the parameters, in case of a hash collision.
+    const WrappedText& wrapped_text = it->second;
+    if (wrapped_text.max_width != max_width || wrapped_text.interwords_spaces != interwords_spaces ||
+            !(wrapped_text.text == text))
+        return nullptr;
+
+    return &wrapped_text.lines;
+}
+
+void FontProperties::AddWrappedText(const ustring& text,
+                                    uint32_t max_width,
+                                    bool interwords_spaces,
+                                    const std::vector<ustring>& lines)
+{
+    // The same texts are wrapped again and again, so a simple size bound is enough.
+    if (_wrapped_texts.size() >= WRAPPED_TEXT_CACHE_SIZE)
+        _wrapped_texts.clear();
+
+    WrappedText& wrapped_text = _wrapped_texts[GetWrappedTextKey(text, max_width, interwords_spaces)];
+    wrapped_text.text = text;
+    wrapped_text.max_width = max_width;
+    wrapped_text.interwords_spaces = interwords_spaces;
+    wrapped_text.lines = lines;
 }
 
 FontProperties::FontProperties(const FontProperties&)
@@ -519,7 +624,7 @@ void TextImage::_Regenerate()
     }
 
     // Iterate through each line of text and render a text texture for each one.
-    std::vector<ustring> lines_array = TextManager->WrapText(_text, fp->ttf_font, _max_width);
+    std::vector<ustring> lines_array = TextManager->WrapText(_text, fp, _max_width);
     std::vector<ustring>::iterator line_iter;
     for(line_iter = lines_array.begin(); line_iter != lines_array.end(); ++line_iter) {
 
@@ -908,120 +1013,109 @@ int32_t TextSupervisor::CalculateTextWidth(TTF_Font* ttf_font, const std::string
 }
 
 std::vector<vt_utils::ustring> TextSupervisor::WrapText(const vt_utils::ustring& text,
-                                                        TTF_Font* ttf_font,
+                                                        FontProperties* font_properties,
                                                         uint32_t max_width)
 {
-    std::vector<vt_utils::ustring> lines_array;
+    std::vector<vt_utils::ustring> wrapped_lines_array;
     if (text.empty() || max_width == 0) {
         // This can happen when called with uninit // gui objects.
-        return lines_array;
+        return wrapped_lines_array;
     }
 
-    // We split the text using new lines in a first row
-    ustring temp_text = text;
-    uint32_t text_length = temp_text.length();
-
-    for (uint32_t i = 0; i < text_length; ++i) {
-        if(!(temp_text[i] == NEW_LINE))
-            continue;
-
-        // We add the substring (except the end line)
-        if (i > 0)
-            lines_array.push_back(temp_text.substr(0, i));
-        else // It's only a new line
-            lines_array.push_back(ustring());
-
-        // We reached the string's end
-        if (i + 1 == text_length) {
-            temp_text.clear();
-            break;
-        }
-
-        // We then cut the temp string used part (and the new line)
-        temp_text = temp_text.substr(i + 1);
-        text_length = temp_text.length();
-        i = -1; // Will be set to 0 after the loop end.
+    if (font_properties == nullptr || font_properties->ttf_font == nullptr) {
+        IF_PRINT_WARNING(VIDEO_DEBUG) << "invalid font properties" << std::endl;
+        return wrapped_lines_array;
     }
 
-    // If there is still some text, we push the rest in the vector
-    if (temp_text.length() > 0)
-        lines_array.push_back(temp_text);
+    // Some languages have spaces in the sentence, some don't (Japanese, Chinese, ...)
+    std::string locale = vt_system::SystemManager->GetLanguageLocale();
+    bool interwords_spaces = vt_system::SystemManager->GetLocaleProperty(locale).UsesInterWordsSpaces();
 
-    // We then perform word wrapping in a loop until all the text is added
-    // And copy it into the new vector
-    std::vector<vt_utils::ustring> wrapped_lines_array;
-    uint32_t num_lines = lines_array.size();
-    for (uint32_t line_index = 0; line_index < num_lines; ++line_index) {
-        ustring temp_line = lines_array[line_index];
+    const std::vector<vt_utils::ustring>* cached_lines = font_properties->GetWrappedText(text, max_width, interwords_spaces);
+    if (cached_lines != nullptr)
+        return *cached_lines;
 
-        // If it's an empty string, we add a blank line.
-        if (temp_line.empty()) {
-            wrapped_lines_array.push_back(temp_line);
-            continue;
-        }
-
-        // Some languages have spaces in the sentence, some don't (Japanese, Chinese, ...)
-        std::string locale = vt_system::SystemManager->GetLanguageLocale();
-        bool interwords_spaces = vt_system::SystemManager->GetLocaleProperty(locale).UsesInterWordsSpaces();
+    const uint16_t* characters = text.c_str();
+    const size_t text_length = text.length();
+    const int32_t max_line_width = static_cast<int32_t>(max_width);
 
-        while(!temp_line.empty()) {
-            int32_t text_width = TextManager->CalculateTextWidth(ttf_font, temp_line);
+    // We split the text using new lines in a first row
+    size_t paragraph_start = 0;
+    while (paragraph_start < text_length) {
+        size_t paragraph_end = paragraph_start;
+        while (paragraph_end < text_length && characters[paragraph_end] != NEW_LINE)
+            ++paragraph_end;
 
-            // If the text can fit in the text box, add the whole line and return
-            if(text_width < (int32_t)max_width) {
-                wrapped_lines_array.push_back(temp_line);
-                break;
-            }
+        // If it's an empty string, we add a blank line.
+        if (paragraph_end == paragraph_start)
+            wrapped_lines_array.push_back(ustring());
+
+        // We then perform word wrapping until all the paragraph is added
+        size_t line_start = paragraph_start;
+        while (line_start < paragraph_end) {
+            // The line width is computed the way SDL_ttf does, while adding the glyphs one by one.
+            int32_t pen_x = 0;
+            int32_t min_x = 0;
+            int32_t max_x = 0;
+            size_t line_end = paragraph_end;
+            size_t last_breakable_index = paragraph_end;
+            bool width_exceeded = false;
+
+            for (size_t i = line_start; i < paragraph_end; ++i) {
+                if (i > line_start)
+                    pen_x += font_properties->GetKerning(characters[i - 1], characters[i]);
+
+                const FontProperties::GlyphMetrics& glyph = font_properties->GetGlyphMetrics(characters[i]);
+                min_x = std::min(min_x, pen_x + glyph.min_x);
+                max_x = std::max(max_x, pen_x + std::max(glyph.advance, glyph.max_x));
+                pen_x += glyph.advance;
 
-            // Otherwise, find the maximum number of words which can fit and make that substring a line
-            // Word boundaries are found by calling the == 0x20 test
-            ustring wrapped_line;
-            int32_t num_wrapped_chars = 0;
-            int32_t last_breakable_index = -1;
-            int32_t line_length = static_cast<int32_t>(temp_line.length());
-            while (num_wrapped_chars < line_length) {
-                wrapped_line += temp_line[num_wrapped_chars];
                 // If we meet a space character (0x20), we can wrap the text
                 // If the current language don't have any spaces in the sentence, check all words.
-                if (!interwords_spaces || temp_line[num_wrapped_chars] == SPACE_CHAR) {
-                    int32_t text_width = TextManager->CalculateTextWidth(ttf_font, wrapped_line);
-
-                    if(text_width < (int32_t)max_width) {
-                        // We haven't gone past the breaking point: mark this as a possible breaking point
-                        last_breakable_index = num_wrapped_chars;
-                    } else {
-                        // We exceeded the maximum width, so go back to the previous breaking point.
-                        // If there was no previous breaking point (== -1), then just break it off at
-                        // the current character position.
-                        if(last_breakable_index != -1)
-                            num_wrapped_chars = last_breakable_index;
-                        break;
-                    }
-                } // (temp_line[num_wrapped_chars] == SPACE_CHAR)
-                ++num_wrapped_chars;
-            } // while (num_wrapped_chars < line_length)
-
-            // Figure out the number of characters in the wrapped line and construct the wrapped line
-            text_width = TextManager->CalculateTextWidth(ttf_font, wrapped_line);
-            if(text_width >= (int32_t)max_width && last_breakable_index != -1) {
-                num_wrapped_chars = last_breakable_index;
+                if (interwords_spaces && characters[i] != SPACE_CHAR)
+                    continue;
+
+                if (max_x - min_x < max_line_width) {
+                    // We haven't gone past the breaking point: mark this as a possible breaking point
+                    last_breakable_index = i;
+                } else {
+                    // We exceeded the maximum width, so go back to the previous breaking point.
+                    // If there was no previous breaking point, then just break it off at
+                    // the current character position.
+                    line_end = (last_breakable_index != paragraph_end) ? last_breakable_index : i;
+                    width_exceeded = true;
+                    break;
+                }
+            }
+
+            if (!width_exceeded) {
+                // If the text can fit in the text box, add the whole line.
+                if (max_x - min_x < max_line_width) {
+                    wrapped_lines_array.push_back(text.substr(line_start, paragraph_end - line_start));
+                    break;
+                }
+                // Otherwise, the last word is too long.
+                if (last_breakable_index != paragraph_end)
+                    line_end = last_breakable_index;
             }
-            wrapped_line = temp_line.substr(0, num_wrapped_chars);
+
+            // Always move forward, even when a single glyph is wider than the text box.
+            if (!interwords_spaces && line_end == line_start)
+                ++line_end;
 
             // Add the new wrapped line to the text.
-            wrapped_lines_array.push_back(wrapped_line);
+            wrapped_lines_array.push_back(text.substr(line_start, line_end - line_start));
 
             // If the current language has spaces in the sentence, the wrapped chars include a last space.
             if (interwords_spaces)
-                num_wrapped_chars++;
-            // If there is no more text remaining, we have finished.
-            if (num_wrapped_chars >= line_length)
-                break;
-            // Otherwise, we need to grab the rest of the text that remains to be added and loop again.
-            else
-                temp_line = temp_line.substr(num_wrapped_chars, line_length - num_wrapped_chars);
-        } // while (temp_line.empty() == false)
-    } // for each lines of text
+                ++line_end;
+            line_start = line_end;
+        }
+
+        paragraph_start = paragraph_end + 1;
+    }
+
+    font_properties->AddWrappedText(text, max_width, interwords_spaces, wrapped_lines_array);
 
     // Returns the wrapped lines.
     return wrapped_lines_array;
@@ -1096,7 +1190,7 @@ void TextSupervisor::_RenderText(const uint16_t* text, FontProperties* font_prop
     VideoManager->EnableBlending();
 
     // Update the blending function.
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    VideoManager->SetNormalBlendFunction();
 
     // Push the matrix stack.
     VideoManager->PushMatrix();
@@ -1226,7 +1320,7 @@ void TextSupervisor::_RenderText(const uint16_t* text, FontProperties* font_prop
     VideoManager->EnableBlending();
 
     // Update the blending function.
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    VideoManager->SetNormalBlendFunction();
 
     //
     // Draw the shadow first.
@@ -27,6 +27,7 @@
 #include "utils/ustring.h"
 
 #include <map>
+#include <unordered_map>
 
 typedef struct _TTF_Font TTF_Font;
 
@@ -91,7 +92,52 @@ public:
     //! \brief Used to know the font size currently used.
     uint32_t font_size;
 
+    //! \brief The horizontal metrics of a glyph, as used by SDL_ttf to size a text.
+    struct GlyphMetrics {
+        int32_t min_x;
+        int32_t max_x;
+        int32_t advance;
+    };
+
+    /** \brief Returns the metrics of a glyph.
+    *** They are read from the font the first time the glyph is requested.
+    **/
+    const GlyphMetrics& GetGlyphMetrics(uint16_t glyph);
+
+    //! \brief Returns the kerning offset between two glyphs, cached the same way.
+    int32_t GetKerning(uint16_t previous_glyph, uint16_t glyph);
+
+    /** \brief Returns a previous wrapping result of a text.
+    *** \return The wrapped lines, or nullptr if the text wasn't wrapped with these parameters.
+    **/
+    const std::vector<vt_utils::ustring>* GetWrappedText(const vt_utils::ustring& text,
+                                                         uint32_t max_width,
+                                                         bool interwords_spaces) const;
+
+    //! \brief Keeps a wrapping result of a text, so that it isn't computed again.
+    void AddWrappedText(const vt_utils::ustring& text,
+                        uint32_t max_width,
+                        bool interwords_spaces,
+                        const std::vector<vt_utils::ustring>& lines);
+
 private:
+    //! \brief A wrapping result of a text.
+    struct WrappedText {
+        vt_utils::ustring text;
+        uint32_t max_width;
+        bool interwords_spaces;
+        std::vector<vt_utils::ustring> lines;
+    };
+
+    //! \brief The metrics of the glyphs met so far, indexed by character.
+    std::unordered_map<uint16_t, GlyphMetrics> _glyph_metrics;
+
+    //! \brief The kerning offsets met so far, indexed by character pairs.
+    std::unordered_map<uint32_t, int32_t> _kernings;
+
+    //! \brief The last wrapping results, indexed by a hash of their parameters.
+    std::unordered_map<size_t, WrappedText> _wrapped_texts;
+
     //! \brief The copy constructor and assignment operator are hidden by design
     //! to cause compilation errors when attempting to copy or assign this class.
     FontProperties(const FontProperties& font_properties);
@@ -568,9 +614,12 @@ public:
 
     /** \brief Returns the text as a vector of lines which text width is inferior or equal to the given pixel max width.
     *** \param text The ustring text
-    *** \param ttf_font The True Type SDL font object
+    *** \param font_properties The properties of the font used to render the text
+    ***
+    *** The widths are computed from the glyph metrics cached in the font properties,
+    *** in a single pass over the text, and the results are kept for the next calls.
     **/
-    std::vector<vt_utils::ustring> WrapText(const vt_utils::ustring& text, TTF_Font* ttf_font, uint32_t max_width);
+    std::vector<vt_utils::ustring> WrapText(const vt_utils::ustring& text, FontProperties* font_properties, uint32_t max_width);
     //@}
 
     //! \name Class member access methods
@@ -42,7 +42,9 @@ TexSheet::TexSheet(uint32_t sheet_width, uint32_t sheet_height, GLuint sheet_id,
     type(sheet_type),
     is_static(sheet_static),
     smoothed(false),
-    loaded(true)
+    loaded(true),
+    last_used_frame(0),
+    _pixels_copy(nullptr)
 {
     Smooth();
 }
@@ -50,16 +52,24 @@ TexSheet::TexSheet(uint32_t sheet_width, uint32_t sheet_height, GLuint sheet_id,
 TexSheet::~TexSheet()
 {
     // Unload the OpenGL texture from memory.
-    TextureManager->_DeleteTexture(tex_id);
+    if (loaded)
+        TextureManager->_DeleteTexture(tex_id);
+
+    delete _pixels_copy;
 }
 
-bool TexSheet::Unload()
+bool TexSheet::Unload(bool keep_copy)
 {
     if (loaded == false) {
         IF_PRINT_WARNING(VIDEO_DEBUG) << "attempted to unload an already unloaded texture sheet" << std::endl;
         return false;
     }
 
+    if (keep_copy) {
+        _pixels_copy = new ImageMemory();
+        _pixels_copy->CopyFromTexture(this);
+    }
+
     TextureManager->_DeleteTexture(tex_id);
     tex_id = INVALID_TEXTURE_ID;
     loaded = false;
@@ -83,19 +93,33 @@ bool TexSheet::Reload()
     }
 
     tex_id = id;
+    // The texture exists from now on, even if some images fail to reload.
+    loaded = true;
 
     // Restore texture smoothing if applied.
     bool was_smoothed = smoothed;
     smoothed = false;
     Smooth(was_smoothed);
 
-    // Reload all of the images that belong to this texture
+    // Restore the pixels kept in system memory
+    if (_pixels_copy != nullptr) {
+        bool copied = CopyRect(0, 0, *_pixels_copy);
+        delete _pixels_copy;
+        _pixels_copy = nullptr;
+
+        if (copied == false) {
+            PRINT_ERROR << "call to TexSheet::CopyRect() failed" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Or reload all of the images that belong to this texture
     if(TextureManager->_ReloadImagesToSheet(this) == false) {
         PRINT_ERROR << "call to TextureController::_ReloadImagesToSheet() failed" << std::endl;
         return false;
     }
 
-    loaded = true;
     return true;
 }
 
@@ -45,6 +45,7 @@
 
 #include "utils/gl_include.h"
 
+#include <cstddef>
 #include <set>
 
 namespace vt_video
@@ -69,8 +70,10 @@ enum TexSheetType {
     VIDEO_TEXSHEET_32x64 = 1,
     VIDEO_TEXSHEET_64x64 = 2,
     VIDEO_TEXSHEET_ANY = 3,
+    //! \brief Variable sized sheets reserved for screen captures, kept resident between captures.
+    VIDEO_TEXSHEET_CAPTURE = 4,
 
-    VIDEO_TEXSHEET_TOTAL = 4
+    VIDEO_TEXSHEET_TOTAL = 5
 };
 
 
@@ -151,15 +154,22 @@ public:
     virtual uint32_t GetNumberTextures() = 0;
 
     /** \brief Unloads all texture memory used by OpenGL for this sheet
+    *** \param keep_copy Whether to keep a copy of the sheet pixels in system memory,
+    *** for sheets holding images which can't be reloaded from their files.
     *** \return Success/failure
     **/
-    bool Unload();
+    bool Unload(bool keep_copy = false);
 
     /** \brief Reloads all the images into the sheet and reallocates OpenGL memory
     *** \return Success/failure
     **/
     bool Reload();
 
+    //! \brief Returns the video memory used by the sheet when loaded, in bytes.
+    size_t GetMemorySize() const {
+        return static_cast<size_t>(width) * height * 4;
+    }
+
     /** \brief Copies pixel data of an image over to a sub-rectangle in the texture sheet
     *** \param x X coordinate of the texture sheet where to copy the pixel data to
     *** \param y Y coordinate of the texture sheet where to copy the pixel data to
@@ -219,9 +229,16 @@ public:
     //! \brief Flag indicating if texture sheet is loaded or not
     bool loaded;
 
+    //! \brief The texture controller frame at which the sheet was last bound for drawing
+    uint32_t last_used_frame;
+
 protected:
     //! \brief The width and height of the sheet in number of texture blocks
     int32_t _block_width, _block_height;
+
+private:
+    //! \brief The sheet pixels kept in system memory while the sheet is unloaded, if any.
+    ImageMemory* _pixels_copy;
 }; // class TexSheet
 
 
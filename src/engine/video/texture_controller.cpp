@@ -21,6 +21,8 @@
 #include "engine/mode_manager.h"
 #include "engine/video/video.h"
 
+#include <algorithm>
+
 using namespace vt_video::private_video;
 
 namespace vt_video
@@ -29,8 +31,13 @@ namespace vt_video
 //! \brief A pointer to the texture controller.
 TextureController* TextureManager = nullptr;
 
+//! \brief The number of frames a texture sheet must stay undrawn before it can be unloaded.
+const uint32_t RESIDENCY_MIN_IDLE_FRAMES = 60;
+
 TextureController::TextureController() :
-    _debug_current_sheet(-1)
+    _debug_current_sheet(-1),
+    _frame_count(0),
+    _video_memory_budget(0)
 {
 }
 
@@ -155,6 +162,8 @@ void TextureController::DEBUG_ShowTexSheet()
         sprintf(buf, "  Type:    64x64");
     else if (sheet->type == VIDEO_TEXSHEET_ANY)
         sprintf(buf, "  Type:    Any size");
+    else if (sheet->type == VIDEO_TEXSHEET_CAPTURE)
+        sprintf(buf, "  Type:    Screen capture");
     else
         sprintf(buf, "  Type:    Unknown");
 
@@ -169,9 +178,28 @@ void TextureController::DEBUG_ShowTexSheet()
     VideoManager->MoveRelative(0, 20);
     TextManager->Draw(buf);
 
+    sprintf(buf, "  Loaded:  %d", sheet->loaded);
+    VideoManager->MoveRelative(0, 20);
+    TextManager->Draw(buf);
+
+    sprintf(buf, "  VRAM:    %u / %u MiB", static_cast<uint32_t>(GetVideoMemoryUsage() / (1024 * 1024)),
+            GetVideoMemoryBudget());
+    VideoManager->MoveRelative(0, 20);
+    TextManager->Draw(buf);
+
     VideoManager->PopState();
 }
 
+size_t TextureController::GetVideoMemoryUsage() const
+{
+    size_t usage = 0;
+    for(uint32_t i = 0; i < _tex_sheets.size(); ++i) {
+        if(_tex_sheets[i]->loaded)
+            usage += _tex_sheets[i]->GetMemorySize();
+    }
+    return usage;
+}
+
 GLuint TextureController::_CreateBlankGLTexture(int32_t width, int32_t height)
 {
     GLuint tex_id;
@@ -209,6 +237,17 @@ void TextureController::_BindTexture(GLuint tex_id)
     glBindTexture(GL_TEXTURE_2D, tex_id);
 }
 
+void TextureController::_BindTexSheet(TexSheet *sheet)
+{
+    // Sheets unloaded to respect the video memory budget come back when drawn.
+    if(!sheet->loaded && !sheet->Reload()) {
+        IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to reload an unloaded texture sheet" << std::endl;
+    }
+
+    sheet->last_used_frame = _frame_count;
+    _BindTexture(sheet->tex_id);
+}
+
 void TextureController::_DeleteTexture(GLuint tex_id)
 {
     if (tex_id != 0) {
@@ -247,6 +286,9 @@ TexSheet *TextureController::_CreateTexSheet(int32_t width, int32_t height, TexS
     else
         sheet = new VariableTexSheet(width, height, tex_id, type, is_static);
 
+    // Don't let a new sheet be unloaded before its first images are drawn.
+    sheet->last_used_frame = _frame_count;
+
     _tex_sheets.push_back(sheet);
     return sheet;
 }
@@ -277,6 +319,36 @@ void TextureController::_RemoveSheet(TexSheet *sheet)
     IF_PRINT_WARNING(VIDEO_DEBUG) << "could not find texture sheet to delete" << std::endl;
 }
 
+TexSheet *TextureController::_GetScreenCaptureSheet(int32_t width, int32_t height)
+{
+    TexSheet *capture_sheet = nullptr;
+
+    std::vector<TexSheet *>::iterator i = _tex_sheets.begin();
+    while(i != _tex_sheets.end()) {
+        TexSheet *sheet = *i;
+        if(sheet == nullptr || sheet->type != VIDEO_TEXSHEET_CAPTURE || sheet->GetNumberTextures() > 0) {
+            ++i;
+            continue;
+        }
+
+        if(capture_sheet == nullptr && static_cast<int32_t>(sheet->width) == width
+                && static_cast<int32_t>(sheet->height) == height) {
+            capture_sheet = sheet;
+            ++i;
+            continue;
+        }
+
+        // Unused capture sheet of an outdated size or in surplus: free its texture memory.
+        delete sheet;
+        i = _tex_sheets.erase(i);
+    }
+
+    if(capture_sheet != nullptr)
+        return capture_sheet;
+
+    return _CreateTexSheet(width, height, VIDEO_TEXSHEET_CAPTURE, false);
+}
+
 TexSheet *TextureController::_InsertImageInTexSheet(BaseTexture *image, ImageMemory &load_info, bool is_static)
 {
     // Image sizes larger than 512 in either dimension require their own texture sheet
@@ -311,7 +383,7 @@ TexSheet *TextureController::_InsertImageInTexSheet(BaseTexture *image, ImageMem
     else
         type = VIDEO_TEXSHEET_ANY;
 
-    // Look through all existing texture sheets and see if the image will fit in any of the ones which
+    // Look through all existing texture sheets and see if the image will fit in any of the loaded ones which
     // match the type and static status that we are looking for
     for(uint32_t i = 0; i < _tex_sheets.size(); ++i) {
         TexSheet *sheet = _tex_sheets[i];
@@ -320,7 +392,7 @@ TexSheet *TextureController::_InsertImageInTexSheet(BaseTexture *image, ImageMem
             continue;
         }
 
-        if(sheet->type == type && sheet->is_static == is_static) {
+        if(sheet->type == type && sheet->is_static == is_static && sheet->loaded) {
             if(sheet->AddTexture(image, load_info)) {
                 return sheet;
             }
@@ -452,6 +524,63 @@ bool TextureController::_ReloadImagesToSheet(TexSheet *sheet)
     return success;
 } // bool TextureController::_ReloadImagesToSheet(TexSheet* sheet)
 
+bool TextureController::_CanReloadImagesFromFiles(TexSheet *sheet) const
+{
+    // Images created from memory (e.g. screen captures) don't have a file.
+    for(std::map<std::string, ImageTexture *>::const_iterator i = _images.begin(); i != _images.end(); ++i) {
+        if(i->second->texture_sheet == sheet && !vt_utils::DoesFileExist(i->second->filename))
+            return false;
+    }
+    return true;
+}
+
+void TextureController::_UpdateResidency()
+{
+    ++_frame_count;
+
+    if(_video_memory_budget == 0)
+        return;
+
+    // Unloaded sheets whose images were all removed won't be drawn anymore.
+    std::vector<TexSheet *>::iterator i = _tex_sheets.begin();
+    while(i != _tex_sheets.end()) {
+        if(!(*i)->loaded && (*i)->GetNumberTextures() == 0) {
+            delete *i;
+            i = _tex_sheets.erase(i);
+            continue;
+        }
+        ++i;
+    }
+
+    size_t usage = GetVideoMemoryUsage();
+    if(usage <= _video_memory_budget)
+        return;
+
+    // Find the sheets which can be unloaded, least recently drawn first.
+    std::vector<TexSheet *> idle_sheets;
+    for(uint32_t j = 0; j < _tex_sheets.size(); ++j) {
+        TexSheet *sheet = _tex_sheets[j];
+        if(!sheet->loaded || sheet->is_static || sheet->type == VIDEO_TEXSHEET_CAPTURE)
+            continue;
+        if(_frame_count - sheet->last_used_frame < RESIDENCY_MIN_IDLE_FRAMES || sheet->GetNumberTextures() == 0)
+            continue;
+        idle_sheets.push_back(sheet);
+    }
+
+    std::sort(idle_sheets.begin(), idle_sheets.end(), [](const TexSheet *a, const TexSheet *b) {
+        return a->last_used_frame < b->last_used_frame;
+    });
+
+    for(uint32_t j = 0; j < idle_sheets.size() && usage > _video_memory_budget; ++j) {
+        TexSheet *sheet = idle_sheets[j];
+        size_t sheet_size = sheet->GetMemorySize();
+
+        // The sheets which can't be reloaded from the image files are kept in system memory.
+        if(sheet->Unload(!_CanReloadImagesFromFiles(sheet)))
+            usage -= sheet_size;
+    }
+}
+
 
 
 void TextureController::_RegisterImageTexture(ImageTexture *img)
@@ -73,6 +73,25 @@ public:
     **/
     void DEBUG_ShowTexSheet();
 
+    /** \brief Sets the amount of video memory the texture sheets may use
+    *** \param megabytes The budget, in megabytes. 0 means no limit (the default).
+    ***
+    *** When the budget is exceeded, the least recently drawn sheets are unloaded
+    *** and reloaded the next time one of their images is drawn. Static sheets and
+    *** screen capture sheets always stay loaded.
+    **/
+    void SetVideoMemoryBudget(uint32_t megabytes) {
+        _video_memory_budget = static_cast<size_t>(megabytes) * 1024 * 1024;
+    }
+
+    //! \brief Returns the video memory budget, in megabytes. 0 means no limit.
+    uint32_t GetVideoMemoryBudget() const {
+        return static_cast<uint32_t>(_video_memory_budget / (1024 * 1024));
+    }
+
+    //! \brief Returns the video memory used by the loaded texture sheets, in bytes.
+    size_t GetVideoMemoryUsage() const;
+
 private:
     virtual ~TextureController() override;
 
@@ -88,6 +107,12 @@ private:
     //! \brief An index to _tex_sheets of the current texture sheet being shown in debug mode. -1 indicates no sheet
     int32_t _debug_current_sheet;
 
+    //! \brief The number of frames since the start, used to know which sheets were drawn recently
+    uint32_t _frame_count;
+
+    //! \brief The video memory the texture sheets may use, in bytes. 0 means no limit
+    size_t _video_memory_budget;
+
     // ---------- Private methods
 
     //! \name Texture Operations
@@ -105,6 +130,11 @@ private:
     **/
     void _BindTexture(GLuint tex_id);
 
+    /** \brief Binds the texture of a sheet in order to draw from it
+    *** \param sheet The sheet to bind, which is reloaded first if it was unloaded
+    **/
+    void _BindTexSheet(private_video::TexSheet *sheet);
+
     /** \brief A wrapper to glDeleteTextures() that also adds checking to eliminate redundant texture binding
     *** \param tex_id The integer handle to the OpenGL texture to delete
      */
@@ -127,6 +157,18 @@ private:
     **/
     void _RemoveSheet(private_video::TexSheet *sheet);
 
+    /** \brief Returns an empty texture sheet dedicated to screen captures
+    *** \param width The width of the sheet, in pixels
+    *** \param height The height of the sheet, in pixels
+    *** \return A pointer to an empty capture sheet, or nullptr if a new one could not be created
+    ***
+    *** Capture sheets are never shared with regular images and are not deleted when the capture
+    *** using them is released, so that each new capture reuses the texture memory of an old one
+    *** instead of allocating a full screen texture every time. Unused capture sheets of another
+    *** size (e.g. after a resolution change) are released by this call.
+    **/
+    private_video::TexSheet *_GetScreenCaptureSheet(int32_t width, int32_t height);
+
     /** \brief Inserts an image into a compatible texture sheet
     *** \param image A pointer to the image to insert
     *** \param load_info The attributes of the image to be inserted
@@ -144,6 +186,16 @@ private:
     *** \return True only if every single image owned by the TexSheet was successfully reloaded back into it
     **/
     bool _ReloadImagesToSheet(private_video::TexSheet *sheet);
+
+    /** \brief Tells whether all the images of a texture sheet can be reloaded from their files
+    *** \param sheet A pointer to the TexSheet to check
+    **/
+    bool _CanReloadImagesFromFiles(private_video::TexSheet *sheet) const;
+
+    /** \brief Unloads the least recently drawn texture sheets when the video memory budget is exceeded
+    *** Called once per frame.
+    **/
+    void _UpdateResidency();
     //@}
 
     //! \name Image Texture Operations
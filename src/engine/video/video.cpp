@@ -32,6 +32,10 @@
 
 #include "utils/utils_strings.h"
 
+#include "common/app_settings.h"
+
+#include <cmath>
+
 using namespace vt_utils;
 using namespace vt_video::private_video;
 
@@ -84,6 +88,8 @@ VideoEngine::VideoEngine():
     _current_sample(0),
     _number_samples(0),
     _FPS_textimage(nullptr),
+    _frame_memory_textimage(nullptr),
+    _script_memory_textimage(nullptr),
     _gl_error_code(GL_NO_ERROR),
     _gl_blend_is_active(false),
     _gl_texture_2d_is_active(false),
@@ -104,6 +110,9 @@ VideoEngine::VideoEngine():
     _temp_width(0),
     _temp_height(0),
     _vsync_mode(0),
+    _render_scale(VIDEO_MAX_RENDER_SCALE),
+    _temp_render_scale(VIDEO_MAX_RENDER_SCALE),
+    _secondary_render_target_enabled(false),
     _game_update_mode(false),
     _sprite(nullptr),
     _particle_system(nullptr),
@@ -123,6 +132,7 @@ VideoEngine::VideoEngine():
                                                     VIDEO_STANDARD_RES_WIDTH,
                                                     VIDEO_STANDARD_RES_HEIGHT);
     _current_context.scissoring_enabled = false;
+    _current_context.render_target_capture = false;
 
     _transform_stack.push(gl::Transform());
 
@@ -132,6 +142,9 @@ VideoEngine::VideoEngine():
 
 VideoEngine::~VideoEngine()
 {
+    // Release the screenshot pixel buffers while the GL context is still current.
+    _screenshot_writer.Clear();
+
     // Clean up the sprite.
     if (_sprite != nullptr) {
         delete _sprite;
@@ -178,6 +191,16 @@ VideoEngine::~VideoEngine()
         _FPS_textimage = nullptr;
     }
 
+    if (_frame_memory_textimage != nullptr) {
+        delete _frame_memory_textimage;
+        _frame_memory_textimage = nullptr;
+    }
+
+    if (_script_memory_textimage != nullptr) {
+        delete _script_memory_textimage;
+        _script_memory_textimage = nullptr;
+    }
+
     TextureManager->SingletonDestroy();
 }
 
@@ -373,12 +396,21 @@ void VideoEngine::Clear()
             GL_STENCIL_BUFFER_BIT);
 }
 
+void VideoEngine::SetImageCacheEnabled(bool enabled)
+{
+    _image_cache.SetDirectory(enabled ? vt_common::GetUserDataPath() + "texture_cache/" : std::string());
+}
+
 void VideoEngine::Update()
 {
     uint32_t frame_time = vt_system::SystemManager->GetUpdateTime();
 
     _screen_fader.Update(frame_time);
 
+    _screenshot_writer.Update();
+
+    TextureManager->_UpdateResidency();
+
     if (_fps_display)
         _UpdateFPS();
 }
@@ -482,9 +514,28 @@ bool VideoEngine::ApplySettings()
 
     _UpdateViewportMetrics();
 
+    if (_temp_render_scale < VIDEO_MIN_RENDER_SCALE || _temp_render_scale > VIDEO_MAX_RENDER_SCALE) {
+        IF_PRINT_WARNING(VIDEO_DEBUG) << "Invalid render scale: " << _temp_render_scale
+                                      << ", using the native resolution." << std::endl;
+        _temp_render_scale = VIDEO_MAX_RENDER_SCALE;
+    }
+
+    // Snap the scale to the supported steps, as other values come with uneven target sizes.
+    float scale_steps = std::floor((_temp_render_scale - VIDEO_MIN_RENDER_SCALE) / VIDEO_RENDER_SCALE_STEP + 0.5f);
+    _temp_render_scale = VIDEO_MIN_RENDER_SCALE + scale_steps * VIDEO_RENDER_SCALE_STEP;
+    _render_scale = _temp_render_scale;
+
     // Resize the secondary render target.
     assert(_secondary_render_target != nullptr);
-    _secondary_render_target->Resize(_screen_width, _screen_height);
+    uint32_t target_width = static_cast<uint32_t>(_screen_width * _render_scale + 0.5f);
+    uint32_t target_height = static_cast<uint32_t>(_screen_height * _render_scale + 0.5f);
+    _secondary_render_target->Resize(target_width > 0 ? target_width : 1,
+                                     target_height > 0 ? target_height : 1);
+
+    // Integer upscales keep the pixel art sharp when left unfiltered,
+    // other factors need filtering to avoid uneven pixel sizes.
+    float upscale = 1.0f / _render_scale;
+    _secondary_render_target->SetSmoothFiltering(!vt_utils::IsFloatEqual(upscale, std::floor(upscale + 0.5f), 0.01f));
 
     // Try to apply the VSync mode
     if (_vsync_mode > 2) {
@@ -569,6 +620,13 @@ void VideoEngine::SetViewport(float x, float y, float width, float height)
     _viewport_width = width;
     _viewport_height = height;
 
+    // The secondary render target is drawn at the render scale.
+    if (_secondary_render_target_enabled) {
+        glViewport(_viewport_x_offset * _render_scale, _viewport_y_offset * _render_scale,
+                   _viewport_width * _render_scale, _viewport_height * _render_scale);
+        return;
+    }
+
     glViewport(_viewport_x_offset, _viewport_y_offset,
                _viewport_width, _viewport_height);
 }
@@ -581,6 +639,24 @@ void VideoEngine::EnableBlending()
     }
 }
 
+void VideoEngine::SetNormalBlendFunction()
+{
+    // The target alpha accumulates the coverage, so that it can be composited as premultiplied.
+    if (_current_context.render_target_capture)
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    else
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void VideoEngine::SetAdditiveBlendFunction()
+{
+    // Additive draws brighten the target without covering it.
+    if (_current_context.render_target_capture)
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_ZERO, GL_ONE);
+    else
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+}
+
 void VideoEngine::DisableBlending()
 {
     if(_gl_blend_is_active) {
@@ -625,11 +701,25 @@ void VideoEngine::EnableSecondaryRenderTarget()
 {
     assert(_secondary_render_target != nullptr);
     _secondary_render_target->Bind();
+
+    // Draw the scene at the render scale, until the target is disabled.
+    _secondary_render_target_enabled = true;
+    SetViewport(_viewport_x_offset, _viewport_y_offset, _viewport_width, _viewport_height);
+    if (_current_context.scissoring_enabled)
+        SetScissorRect(_current_context.scissor_rectangle);
 }
 
 void VideoEngine::DisableSecondaryRenderTarget()
 {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!_secondary_render_target_enabled)
+        return;
+
+    _secondary_render_target_enabled = false;
+    SetViewport(_viewport_x_offset, _viewport_y_offset, _viewport_width, _viewport_height);
+    if (_current_context.scissoring_enabled)
+        SetScissorRect(_current_context.scissor_rectangle);
 }
 
 void VideoEngine::DrawSecondaryRenderTarget()
@@ -637,14 +727,15 @@ void VideoEngine::DrawSecondaryRenderTarget()
     assert(_sprite != nullptr);
     assert(_secondary_render_target != nullptr);
 
-    float width_render_target = static_cast<float>(_secondary_render_target->GetWidth());
-    float height_render_target = static_cast<float>(_secondary_render_target->GetHeight());
+    // The render target is upscaled to the whole screen.
+    float screen_width = static_cast<float>(_screen_width);
+    float screen_height = static_cast<float>(_screen_height);
 
     // Set up the video manager state.
     vt_video::VideoManager->PushState();
 
-    vt_video::VideoManager->SetViewport(0.0f, 0.0f, width_render_target, height_render_target);
-    vt_video::VideoManager->SetCoordSys(0.0f, width_render_target, height_render_target, 0.0f);
+    vt_video::VideoManager->SetViewport(0.0f, 0.0f, screen_width, screen_height);
+    vt_video::VideoManager->SetCoordSys(0.0f, screen_width, screen_height, 0.0f);
     vt_video::VideoManager->SetDrawFlags(vt_video::VIDEO_X_LEFT, vt_video::VIDEO_Y_TOP, vt_video::VIDEO_BLEND, 0);
 
     VideoManager->EnableBlending();
@@ -717,6 +808,102 @@ void VideoEngine::DrawSecondaryRenderTarget()
     vt_video::VideoManager->PopState();
 }
 
+void VideoEngine::BeginRenderTargetCapture(gl::RenderTarget* target,
+                                           float left, float right, float bottom, float top)
+{
+    assert(target != nullptr);
+
+    // Size the target so that its texels match the screen pixels.
+    const CoordSys& coordinate_system = _current_context.coordinate_system;
+    float width = std::abs((right - left) / (coordinate_system.GetRight() - coordinate_system.GetLeft()))
+                  * _viewport_width;
+    float height = std::abs((top - bottom) / (coordinate_system.GetTop() - coordinate_system.GetBottom()))
+                   * _viewport_height;
+    unsigned target_width = static_cast<unsigned>(width + 0.5f);
+    unsigned target_height = static_cast<unsigned>(height + 0.5f);
+    if (target_width == 0)
+        target_width = 1;
+    if (target_height == 0)
+        target_height = 1;
+
+    if (target->GetWidth() != target_width || target->GetHeight() != target_height)
+        target->Resize(target_width, target_height);
+
+    PushState();
+
+    target->Bind();
+    SetViewport(0.0f, 0.0f, target_width, target_height);
+    SetCoordSys(left, right, bottom, top);
+    DisableScissoring();
+    Clear();
+    _current_context.render_target_capture = true;
+}
+
+void VideoEngine::EndRenderTargetCapture()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Restores the screen viewport and coordinate system.
+    PopState();
+}
+
+void VideoEngine::DrawRenderTarget(gl::RenderTarget* target,
+                                   float left, float right, float bottom, float top,
+                                   const Color& color)
+{
+    assert(target != nullptr);
+
+    // The vertex positions are already in the current coordinate system.
+    PushMatrix();
+    _transform_stack.top().Reset();
+
+    // The captured colors are premultiplied by their alpha.
+    EnableBlending();
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    EnableTexture2D();
+    target->BindTexture();
+
+    gl::ShaderProgram* shader_program = LoadShaderProgram(gl::shader_programs::Sprite);
+    assert(shader_program != nullptr);
+
+    // The vertex positions.
+    float vertex_positions[] =
+    {
+        left,  bottom, 0.0f, // Vertex One.
+        right, bottom, 0.0f, // Vertex Two.
+        right, top,    0.0f, // Vertex Three.
+        left,  top,    0.0f  // Vertex Four.
+    };
+
+    // The vertex texture coordinates.
+    float vertex_texture_coordinates[] =
+    {
+        0.0f, 0.0f, // Vertex One.
+        1.0f, 0.0f, // Vertex Two.
+        1.0f, 1.0f, // Vertex Three.
+        0.0f, 1.0f  // Vertex Four.
+    };
+
+    // The vertex colors.
+    float vertex_colors[] =
+    {
+        1.0f, 1.0f, 1.0f, 1.0f, // Vertex One.
+        1.0f, 1.0f, 1.0f, 1.0f, // Vertex Two.
+        1.0f, 1.0f, 1.0f, 1.0f, // Vertex Three.
+        1.0f, 1.0f, 1.0f, 1.0f  // Vertex Four.
+    };
+
+    // The modulation color must be premultiplied as well.
+    Color premultiplied_color(color[0] * color[3], color[1] * color[3], color[2] * color[3], color[3]);
+    DrawSprite(shader_program, vertex_positions, vertex_texture_coordinates, vertex_colors, premultiplied_color);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    UnloadShaderProgram();
+
+    PopMatrix();
+}
+
 gl::ShaderProgram* VideoEngine::LoadShaderProgram(const gl::shader_programs::ShaderPrograms& shader_program)
 {
     gl::ShaderProgram* result = nullptr;
@@ -735,19 +922,24 @@ void VideoEngine::UnloadShaderProgram()
     glUseProgram(0);
 }
 
-void VideoEngine::DrawParticleSystem(gl::ShaderProgram* shader_program,
-                                     float* vertex_positions,
-                                     float* vertex_texture_coordinates,
-                                     float* vertex_colors,
-                                     unsigned number_of_vertices)
+gl::ParticleBufferVertex* VideoEngine::MapParticleVertices(unsigned number_of_vertices)
 {
     assert(_particle_system != nullptr);
-    assert(shader_program != nullptr);
-    assert(vertex_positions != nullptr);
-    assert(vertex_texture_coordinates != nullptr);
-    assert(vertex_colors != nullptr);
     assert(number_of_vertices % 4 == 0);
 
+    return _particle_system->MapVertices(number_of_vertices);
+}
+
+unsigned VideoEngine::GetMaxParticleVertices() const
+{
+    return gl::PARTICLE_BUFFER_SEGMENT_VERTICES;
+}
+
+void VideoEngine::DrawParticleSystem(gl::ShaderProgram* shader_program)
+{
+    assert(_particle_system != nullptr);
+    assert(shader_program != nullptr);
+
     // Load the shader uniforms common to all programs.
     float buffer[16] = { 0 };
     _transform_stack.top().Apply(buffer);
@@ -763,7 +955,7 @@ void VideoEngine::DrawParticleSystem(gl::ShaderProgram* shader_program,
     shader_program->UpdateUniform("u_Color", reinterpret_cast<const float*>(&::vt_video::Color::white), 4);
 
     // Draw the particle system.
-    _particle_system->Draw(vertex_positions, vertex_texture_coordinates, vertex_colors, number_of_vertices);
+    _particle_system->Draw();
 }
 
 void VideoEngine::DrawSprite(gl::ShaderProgram* shader_program,
@@ -824,6 +1016,14 @@ void VideoEngine::SetScissorRect(const ScreenRect& screen_rectangle)
 {
     _current_context.scissor_rectangle = screen_rectangle;
 
+    if (_secondary_render_target_enabled) {
+        glScissor(static_cast<GLint>(_current_context.scissor_rectangle.left * _render_scale),
+                  static_cast<GLint>(_current_context.scissor_rectangle.top * _render_scale),
+                  static_cast<GLsizei>(_current_context.scissor_rectangle.width * _render_scale),
+                  static_cast<GLsizei>(_current_context.scissor_rectangle.height * _render_scale));
+        return;
+    }
+
     glScissor(static_cast<GLint>(_current_context.scissor_rectangle.left),
               static_cast<GLint>(_current_context.scissor_rectangle.top),
               static_cast<GLsizei>(_current_context.scissor_rectangle.width),
@@ -1001,11 +1201,10 @@ StillImage VideoEngine::CaptureScreen()
                                                static_cast<int32_t>(viewport_height));
     new_image->AddReference();
 
-    // Create a texture sheet of an appropriate size that can retain the capture
-    TexSheet *temp_sheet = TextureManager->_CreateTexSheet(RoundUpPow2(static_cast<uint32_t>(viewport_width)),
-                                                           RoundUpPow2(static_cast<uint32_t>(viewport_height)),
-                                                           VIDEO_TEXSHEET_ANY,
-                                                           false);
+    // Get a resident texture sheet of an appropriate size that can retain the capture.
+    // The sheet memory is reused from previous captures of the same size when possible.
+    TexSheet *temp_sheet = TextureManager->_GetScreenCaptureSheet(RoundUpPow2(static_cast<uint32_t>(viewport_width)),
+                                                                  RoundUpPow2(static_cast<uint32_t>(viewport_height)));
     VariableTexSheet *sheet = dynamic_cast<VariableTexSheet *>(temp_sheet);
 
     // Ensure that texture sheet creation succeeded, insert the texture image into the sheet, and copy the screen into the sheet
@@ -1016,14 +1215,13 @@ StillImage VideoEngine::CaptureScreen()
     }
 
     if (sheet->InsertTexture(new_image) == false) {
-        TextureManager->_RemoveSheet(sheet);
         delete new_image;
         throw Exception("could not insert captured screen image into texture sheet",
                         __FILE__, __LINE__, __FUNCTION__);
     }
 
     if (sheet->CopyScreenRect(0, 0, screen_rect) == false) {
-        TextureManager->_RemoveSheet(sheet);
+        sheet->RemoveTexture(new_image);
         delete new_image;
         throw Exception("call to TexSheet::CopyScreenRect() failed",
                         __FILE__, __LINE__, __FUNCTION__);
@@ -1151,27 +1349,18 @@ void VideoEngine::SetBrightness(float value)
 
 void VideoEngine::MakeScreenshot(const std::string &filename)
 {
-    private_video::ImageMemory buffer;
-
     // Retrieve the width and height of the viewport.
     GLint viewport_dimensions[4]; // viewport_dimensions[2] is the width, [3] is the height
     glGetIntegerv(GL_VIEWPORT, viewport_dimensions);
 
-    // Buffer to store the image before it is flipped
-    buffer.Resize(viewport_dimensions[2], viewport_dimensions[3], true);
-
-    // Read the viewport pixel data
-    buffer.GlReadPixels(viewport_dimensions[0], viewport_dimensions[1]);
+    ScreenRect screen_rect(viewport_dimensions[0], viewport_dimensions[1],
+                           viewport_dimensions[2], viewport_dimensions[3]);
 
-    if(CheckGLError()) {
-        IF_PRINT_WARNING(VIDEO_DEBUG) << "An OpenGL error occured: "
-                                      << CreateGLErrorString() << std::endl;
-        return;
+    // The pixels are fetched and written to the file in the following frames.
+    if (!_screenshot_writer.RequestScreenshot(filename, screen_rect)) {
+        IF_PRINT_WARNING(VIDEO_DEBUG) << "Couldn't take the screenshot: "
+                                      << filename << std::endl;
     }
-
-    // Vertically flip the image, then swap the flipped and original images
-    buffer.VerticalFlip();
-    buffer.SaveImage(filename);
 }
 
 void VideoEngine::DrawLine(float x1, float y1, unsigned width1,
@@ -1220,7 +1409,7 @@ void VideoEngine::DrawLine(float x1, float y1, unsigned width1,
     DisableTexture2D();
 
     // Normal blending.
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    SetNormalBlendFunction();
 
     // Load the solid shader program.
     gl::ShaderProgram* shader_program = VideoManager->LoadShaderProgram(gl::shader_programs::Solid);
@@ -1369,6 +1558,10 @@ void VideoEngine::_UpdateFPS()
     // We only create the text image when needed, to permit getting the text style correctly.
     if (!_FPS_textimage)
         _FPS_textimage = new TextImage("FPS: ", TextStyle("text20", Color::white));
+    if (!_frame_memory_textimage)
+        _frame_memory_textimage = new TextImage("Frame allocs: ", TextStyle("text20", Color::white));
+    if (!_script_memory_textimage)
+        _script_memory_textimage = new TextImage("Lua heap: ", TextStyle("text20", Color::white));
 
     //! \brief Maximum milliseconds that the current frame time and our averaged frame time must vary
     //! before we begin trying to catch up
@@ -1423,6 +1616,16 @@ void VideoEngine::_UpdateFPS()
 
     // The text to display to the screen
     _FPS_textimage->SetText("FPS: " + NumberToString(avg_fps));
+
+    // Show how much temporary memory the last frame needed.
+    const vt_system::FrameAllocator& frame_allocator = vt_system::SystemManager->GetFrameAllocator();
+    _frame_memory_textimage->SetText("Frame allocs: " + NumberToString(frame_allocator.GetLastFrameAllocations())
+                                     + " (" + NumberToString(frame_allocator.GetLastFrameBytes() / 1024) + " KiB)");
+
+    // And how big the Lua memory is, and the time spent collecting it.
+    const vt_system::ScriptCollector& script_collector = vt_system::SystemManager->GetScriptCollector();
+    _script_memory_textimage->SetText("Lua heap: " + NumberToString(script_collector.GetHeapSize()) + " KiB, GC: "
+                                      + NumberToString(script_collector.GetFrameTime()) + " us");
 }
 
 void VideoEngine::_DrawFPS()
@@ -1436,6 +1639,14 @@ void VideoEngine::_DrawFPS()
                  VIDEO_BLEND, 0);
     Move(930.0f, 40.0f); // Upper right hand corner of the screen
     _FPS_textimage->Draw();
+    if (_frame_memory_textimage) {
+        Move(780.0f, 65.0f);
+        _frame_memory_textimage->Draw();
+    }
+    if (_script_memory_textimage) {
+        MoveRelative(0.0f, 25.0f);
+        _script_memory_textimage->Draw();
+    }
     PopState();
 }
 
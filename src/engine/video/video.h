@@ -40,7 +40,10 @@
 #include "engine/video/gl/gl_shaders.h"
 #include "engine/video/gl/gl_transform.h"
 #include "engine/video/image.h"
+#include "engine/video/image_cache.h"
+#include "engine/video/image_decoder.h"
 #include "engine/video/screen_rect.h"
+#include "engine/video/screenshot.h"
 #include "engine/video/text.h"
 #include "engine/video/texture_controller.h"
 
@@ -70,6 +73,7 @@ class ModeEngine;
 namespace vt_video {
 
 namespace gl {
+struct ParticleBufferVertex;
 class ParticleSystem;
 class RenderTarget;
 class Shader;
@@ -115,6 +119,7 @@ class VideoEngine : public vt_utils::Singleton<VideoEngine>
     friend class private_video::TexSheet;
     friend class private_video::FixedTexSheet;
     friend class private_video::VariableTexSheet;
+    friend class private_video::ImageMemory;
 
     friend class ImageDescriptor;
     friend class CompositeImage;
@@ -245,6 +250,21 @@ public:
         return _vsync_mode;
     }
 
+    /** \brief Sets the resolution scale at which the map scene is rendered.
+     *  \param scale A factor of the screen resolution, between VIDEO_MIN_RENDER_SCALE
+     *  and VIDEO_MAX_RENDER_SCALE, snapped to VIDEO_RENDER_SCALE_STEP.
+     *  The GUI is always drawn at the native resolution.
+     *  \note  you must call ApplySettings() to actually apply the change
+     */
+    void SetRenderScale(float scale) {
+        _temp_render_scale = scale;
+    }
+
+    //! \brief Gets the currently applied render scale.
+    float GetRenderScale() const {
+        return _render_scale;
+    }
+
     //! \brief Returns a reference to the current coordinate system
     const CoordSys& GetCoordSys() const {
         return _current_context.coordinate_system;
@@ -305,12 +325,21 @@ public:
     //! Perform the OpenGL corresponding calls, but only if necessary.
     void EnableBlending();
     void DisableBlending();
+
+    //! \brief Sets the normal or additive blending function used by the next draws.
+    //! While capturing a render target, the target alpha accumulates the drawn coverage.
+    void SetNormalBlendFunction();
+    void SetAdditiveBlendFunction();
     void EnableStencilTest();
     void DisableStencilTest();
     void EnableTexture2D();
     void DisableTexture2D();
 
-    //! Enables the secondary render target.
+    /** \brief Enables the secondary render target.
+    ***
+    ***        The viewports and scissor rectangles set until the target is
+    ***        disabled are scaled down to the render scale.
+    **/
     void EnableSecondaryRenderTarget();
 
     //! Disables the secondary render target.
@@ -323,18 +352,45 @@ public:
     **/
     void DrawSecondaryRenderTarget();
 
+    /** \brief Redirects the drawing into the given render target.
+    ***
+    ***        The rectangle, given in the current coordinate system, is mapped
+    ***        onto the whole target, which is resized to the rectangle size in
+    ***        screen pixels and cleared. This call must be followed by
+    ***        EndRenderTargetCapture().
+    ***
+    *** \note The capture must not happen while the secondary render target is enabled.
+    **/
+    void BeginRenderTargetCapture(gl::RenderTarget* target,
+                                  float left, float right, float bottom, float top);
+
+    //! \brief Restores the drawing onto the screen, and the state saved by BeginRenderTargetCapture().
+    void EndRenderTargetCapture();
+
+    /** \brief Draws the texture of a render target stretched over the given rectangle,
+    ***        in the current coordinate system.
+    **/
+    void DrawRenderTarget(gl::RenderTarget* target,
+                          float left, float right, float bottom, float top,
+                          const Color& color = ::vt_video::Color::white);
+
     //! \brief Loads a shader program.
     gl::ShaderProgram* LoadShaderProgram(const gl::shader_programs::ShaderPrograms& shader_program);
 
     //! \brief Unloads the currently loaded shader program.
     void UnloadShaderProgram();
 
-    //! \brief Draws a particle system.
-    void DrawParticleSystem(gl::ShaderProgram* shader_program,
-                            float* vertex_positions,
-                            float* vertex_texture_coordinates,
-                            float* vertex_colors,
-                            unsigned number_of_vertices);
+    /** \brief Gives the memory where the vertices of the next particle system draw are written.
+    *** \param number_of_vertices The number of vertices, a multiple of 4 up to GetMaxParticleVertices().
+    *** \return The vertices, to be filled before the next call to DrawParticleSystem().
+    **/
+    gl::ParticleBufferVertex* MapParticleVertices(unsigned number_of_vertices);
+
+    //! \brief Returns the maximum number of vertices of a single particle system draw.
+    unsigned GetMaxParticleVertices() const;
+
+    //! \brief Draws the vertices last given by MapParticleVertices().
+    void DrawParticleSystem(gl::ShaderProgram* shader_program);
 
     //! \brief Draws a sprite.
     void DrawSprite(gl::ShaderProgram* shader_program,
@@ -464,6 +520,9 @@ public:
     *** captures in memory at the same time. You should be careful not to have too many
     *** screen captures existing at one time, because each image capture requires a relatively
     *** large amount of texutre memory (roughly 3GB for a 1024x768 screen).
+    ***
+    *** \note The copy is done on the GPU, into a capture texture sheet which stays resident
+    *** once the capture is released, so that the next capture reuses it.
     **/
     StillImage CaptureScreen();
 
@@ -588,9 +647,34 @@ public:
 
     /** \brief Takes a screenshot and saves the image to a file
     *** \param filename The name of the file, if any, to save the screenshot as. Default is "screenshot.png"
+    *** \note The pixels are read back asynchronously and the file is written by a worker thread,
+    *** so the file only appears a few frames later.
     **/
     void MakeScreenshot(const std::string &filename = "screenshot.png");
 
+    /** \brief Starts decoding image files on worker threads, before they are loaded
+    *** \param filenames The image files which are about to be loaded
+    *** \note The images are still loaded as usual, but their pixels are then ready.
+    **/
+    void PreloadImages(const std::vector<std::string>& filenames) {
+        _image_decoder.RequestImages(filenames);
+    }
+
+    //! \brief Drops the preloaded images which weren't loaded.
+    void ClearPreloadedImages() {
+        _image_decoder.Clear();
+    }
+
+    /** \brief Enables or disables the on-disk cache of the decoded images
+    *** \note The cache must be set up before images are preloaded.
+    **/
+    void SetImageCacheEnabled(bool enabled);
+
+    //! \brief Tells whether the decoded images are cached on disk.
+    bool IsImageCacheEnabled() const {
+        return _image_cache.IsEnabled();
+    }
+
     /** \brief toggles debug information display.
     *** currently used for debugging game modes, and more especially the map mode.
      */
@@ -667,6 +751,12 @@ private:
     //! The FPS text
     TextImage* _FPS_textimage;
 
+    //! \brief The frame allocator usage text, shown below the FPS.
+    TextImage* _frame_memory_textimage;
+
+    //! \brief The Lua memory and garbage collection time text, shown below the FPS.
+    TextImage* _script_memory_textimage;
+
     //! \brief Holds the most recently fetched OpenGL error code
     GLenum _gl_error_code;
 
@@ -707,6 +797,15 @@ private:
     //! \brief Manages the current screen fading effect when fading is activated
     private_video::ScreenFader _screen_fader;
 
+    //! \brief Reads back and saves the requested screenshots without stalling the game.
+    private_video::ScreenshotWriter _screenshot_writer;
+
+    //! \brief Decodes the preloaded image files on worker threads.
+    private_video::ImageDecoder _image_decoder;
+
+    //! \brief Stores the decoded images on disk.
+    private_video::ImageCache _image_cache;
+
     //! Keeps whether debug info about the current game mode should be drawn.
     bool _debug_info;
 
@@ -734,6 +833,15 @@ private:
     //! \brief Stores the current vsync mode.
     uint32_t _vsync_mode;
 
+    //! \brief The resolution scale of the secondary render target.
+    float _render_scale;
+
+    //! holds the desired render scale. Not actually applied until ApplySettings() is called
+    float _temp_render_scale;
+
+    //! \brief Set while the drawing goes into the secondary render target, at the render scale.
+    bool _secondary_render_target_enabled;
+
     //! \brief The game main loop update mode.
     //! \note update_mode true for performance, false for the CPU-gentle loop.
     //! It is always on performance when VSync is enabled.
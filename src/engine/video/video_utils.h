@@ -35,6 +35,13 @@ const float VIDEO_STANDARD_RES_HEIGHT = 768.0f;
 const float VIDEO_VIEWPORT_WIDTH  = 800.0f;
 const float VIDEO_VIEWPORT_HEIGHT = 600.0f;
 
+//! \brief The range of the internal render scale, applied to the map scene.
+const float VIDEO_MIN_RENDER_SCALE = 0.5f;
+const float VIDEO_MAX_RENDER_SCALE = 1.0f;
+
+//! \brief The render scale is a multiple of this step: 50%, 75% or 100%.
+const float VIDEO_RENDER_SCALE_STEP = 0.25f;
+
 //! \brief The number of FPS samples to retain across frames
 const uint32_t FPS_SAMPLES = 250;
 
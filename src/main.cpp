@@ -163,6 +163,11 @@ static bool LoadSettings()
     VideoManager->SetFullscreen(settings.ReadBool("full_screen"));
     if (settings.DoesUIntExist("vsync_mode"))
         VideoManager->SetVSyncMode(settings.ReadUInt("vsync_mode"));
+    if (settings.DoesFloatExist("render_scale"))
+        VideoManager->SetRenderScale(settings.ReadFloat("render_scale"));
+    if (settings.DoesUIntExist("video_memory_budget"))
+        TextureManager->SetVideoMemoryBudget(settings.ReadUInt("video_memory_budget"));
+    VideoManager->SetImageCacheEnabled(!settings.DoesBoolExist("texture_cache") || settings.ReadBool("texture_cache"));
     GUIManager->SetUserMenuSkin(settings.ReadString("ui_theme"));
     settings.CloseTable(); // video_settings
 
@@ -355,6 +360,9 @@ static void InitializeEngine()
     vt_defs::BindCommonCode();
     vt_defs::BindModeCode();
 
+    // The collection of the Lua memory is then done in steps every frame.
+    SystemManager->GetScriptCollector().Initialize(ScriptManager->GetGlobalState());
+
     if(!SystemManager->SingletonInitialize()) {
         throw Exception("ERROR: unable to initialize SystemManager",
                         __FILE__, __LINE__, __FUNCTION__);
@@ -460,6 +468,9 @@ void UpdateEngine(uint32_t update_tick)
 {
     //uint32_t update_begin_tick = update_tick;
 
+    // The temporary data of the last frame isn't used anymore.
+    SystemManager->GetFrameAllocator().Reset();
+
     // Update timers for correct time-based movement operation
     SystemManager->UpdateTimers(update_tick);
 
@@ -487,6 +498,9 @@ void UpdateEngine(uint32_t update_tick)
     // Update the game status
     ModeManager->Update();
 
+    // Collect the garbage left by the scripts of this frame
+    SystemManager->GetScriptCollector().Step();
+
     //std::cout << "Update events delay: " << SDL_GetTicks() - update_tick << "ms" << std::endl;
     //std::cout << "Update total delay: " << SDL_GetTicks() - update_begin_tick << "ms" << std::endl;
 }
@@ -622,7 +636,12 @@ int main(int argc, char* argv[])
             // We want to be nice with the CPU % used..
             // And set fixed rendering updates
             if (render_tick < next_render_tick) {
-                SDL_Delay(next_render_tick - render_tick);
+                // Use the time left before the next frame to collect script garbage.
+                SystemManager->GetScriptCollector().UseIdleTime(next_render_tick);
+
+                render_tick = SDL_GetTicks();
+                if (render_tick < next_render_tick)
+                    SDL_Delay(next_render_tick - render_tick);
                 continue;
             }
 
@@ -29,6 +29,7 @@
 #include "common/app_name.h"
 #include "common/app_settings.h"
 #include "common/global/global.h"
+#include "common/script_cache.h"
 
 #include <SDL2/SDL_ttf.h>
 
@@ -97,6 +98,12 @@ bool ParseProgramOptions(int32_t &return_code, int32_t argc, char* argv[])
             }
             return_code = 0;
             return false;
+        } else if(options[i] == "--warm-script-cache") {
+            uint32_t num_scripts = PrecompileScripts("data");
+            std::cout << "Precompiled " << num_scripts << " scripts in: "
+                      << GetUserDataPath() << "script_cache/" << std::endl;
+            return_code = 0;
+            return false;
         } else {
             std::cerr << "Unrecognized option: " << options[i] << std::endl;
             PrintUsage();
@@ -153,7 +160,8 @@ void PrintUsage()
             << "  --disable-audio   :: disables loading and playing audio" << std::endl
             << "  --help/-h         :: prints this help menu" << std::endl
             << "  --info/-i         :: prints information about the user's system" << std::endl
-            << "  --reset/-r        :: resets game configuration to use default settings" << std::endl;
+            << "  --reset/-r        :: resets game configuration to use default settings" << std::endl
+            << "  --warm-script-cache :: precompiles all the game scripts ahead of time" << std::endl;
 }
 
 bool PrintSystemInformation()
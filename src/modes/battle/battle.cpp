@@ -117,6 +117,7 @@ BattleMode::BattleMode() :
     _command_supervisor(nullptr),
     _dialogue_supervisor(nullptr),
     _battle_finish(nullptr),
+    _battle_objects_changed(true),
     _current_number_swaps(0),
     _last_enemy_dying(false),
     _stamina_icon_alpha(1.0f),
@@ -172,7 +173,7 @@ void BattleMode::_ResetMusicState()
     std::string battle_music = GlobalManager->GetBattleMedia().battle_music_filename;
     AudioManager->LoadMusic(battle_music, this);
     // Retrieve from audio cache
-    MusicDescriptor* music = AudioManager->RetrieveMusic(battle_music);
+    MusicDescriptor* music = AudioManager->RetrieveMusic(battle_music, this);
     MusicDescriptor* active_music = AudioManager->GetActiveMusic();
 
     // Stop the current music if it's not the right one.
@@ -239,6 +240,8 @@ void BattleMode::RestartBattle()
     _enemy_actors.clear();
     _enemy_party.clear();
     _ready_queue.clear();
+    _battle_objects.clear();
+    _battle_objects_changed = true;
 
     for(uint32_t i = 0; i < _initial_enemy_actors_info.size(); ++i)
         AddEnemy(_initial_enemy_actors_info[i].enemy_id,
@@ -259,7 +262,7 @@ void BattleMode::RestartBattle()
     delete _command_supervisor;
     _command_supervisor = new CommandSupervisor();
 
-    MusicDescriptor* music = AudioManager->RetrieveMusic(GlobalManager->GetBattleMedia().battle_music_filename);
+    MusicDescriptor* music = AudioManager->RetrieveMusic(GlobalManager->GetBattleMedia().battle_music_filename, this);
     if(music)
     {
         music->Rewind();
@@ -276,6 +279,21 @@ static bool CompareObjectsYCoord(BattleObject *one, BattleObject *other)
     return (one->GetYLocation() < other->GetYLocation());
 }
 
+//! \brief Sorts the battle objects which were already sorted the frame before.
+//! Only the moving objects are out of place, so an insertion sort does it in about linear time.
+static void ResortObjectsYCoord(std::vector<BattleObject *>& objects)
+{
+    for(uint32_t i = 1; i < objects.size(); ++i) {
+        BattleObject* object = objects[i];
+        uint32_t j = i;
+        while(j > 0 && CompareObjectsYCoord(object, objects[j - 1])) {
+            objects[j] = objects[j - 1];
+            --j;
+        }
+        objects[j] = object;
+    }
+}
+
 void BattleMode::Update()
 {
     // Update potential battle animations
@@ -303,31 +321,37 @@ void BattleMode::Update()
     if(_dialogue_supervisor->IsDialogueActive())
         _dialogue_supervisor->Update();
 
-    // Update all actors animations and y-sorting
-    _battle_objects.clear();
-    for(uint32_t i = 0; i < _character_actors.size(); ++i) {
+    // Update all actors animations
+    for(uint32_t i = 0; i < _character_actors.size(); ++i)
         _character_actors[i]->Update();
-        _battle_objects.push_back(_character_actors[i]);
-    }
-    for(uint32_t i = 0; i < _enemy_actors.size(); ++i) {
+    for(uint32_t i = 0; i < _enemy_actors.size(); ++i)
         _enemy_actors[i]->Update();
-        _battle_objects.push_back(_enemy_actors[i]);
-    }
 
-    // Add effects (particles and animations)
+    // Update the effects (particles and animations)
     for(std::vector<BattleObject *>::iterator it = _battle_effects.begin();
             it != _battle_effects.end();) {
         if((*it)->CanBeRemoved()) {
             delete (*it);
             it = _battle_effects.erase(it);
+            _battle_objects_changed = true;
         } else {
             (*it)->Update();
-            _battle_objects.push_back(*it);
             ++it;
         }
     }
 
-    std::sort(_battle_objects.begin(), _battle_objects.end(), CompareObjectsYCoord);
+    // Y-sorting: the draw list is only rebuilt when objects were added or removed,
+    // and kept sorted from one frame to the next otherwise.
+    if(_battle_objects_changed) {
+        _battle_objects.clear();
+        _battle_objects.insert(_battle_objects.end(), _character_actors.begin(), _character_actors.end());
+        _battle_objects.insert(_battle_objects.end(), _enemy_actors.begin(), _enemy_actors.end());
+        _battle_objects.insert(_battle_objects.end(), _battle_effects.begin(), _battle_effects.end());
+        std::sort(_battle_objects.begin(), _battle_objects.end(), CompareObjectsYCoord);
+        _battle_objects_changed = false;
+    } else {
+        ResortObjectsYCoord(_battle_objects);
+    }
 
     // If the battle is in scene mode, we only update animation
     if (_scene_mode)
@@ -535,6 +559,7 @@ void BattleMode::AddEnemy(uint32_t new_enemy_id, float position_x, float positio
 
     _enemy_actors.push_back(new_battle_enemy);
     _enemy_party.push_back(new_battle_enemy);
+    _battle_objects_changed = true;
 
     // Sort the enemies based on their Y location.
     // The player will then be able to target them in that order
@@ -779,6 +804,7 @@ void BattleMode::_Initialize()
         BattleCharacter* new_actor = new BattleCharacter(active_party.GetCharacterAtIndex(i));
         _character_actors.push_back(new_actor);
         _character_party.push_back(new_actor);
+        _battle_objects_changed = true;
 
     // Sort the characters based on their Y location.
     // The player will then be able to target them in that order
@@ -879,6 +905,7 @@ void BattleMode::TriggerBattleParticleEffect(const std::string &effect_filename,
     effect->Start();
 
     _battle_effects.push_back(effect);
+    _battle_objects_changed = true;
 }
 
 private_battle::BattleAnimation* BattleMode::CreateBattleAnimation(const std::string& animation_filename)
@@ -889,6 +916,7 @@ private_battle::BattleAnimation* BattleMode::CreateBattleAnimation(const std::st
     animation->SetVisible(false);
 
     _battle_effects.push_back(animation);
+    _battle_objects_changed = true;
     return animation;
 }
 
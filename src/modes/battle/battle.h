@@ -381,6 +381,9 @@ private:
     **/
     std::vector<private_battle::BattleObject *> _battle_objects;
 
+    //! \brief Tells whether actors or effects were added or removed, and _battle_objects must be rebuilt.
+    bool _battle_objects_changed;
+
     /** \brief The number of character swaps that the player may currently perform
     *** The maximum number of swaps ever allowed is four, thus the value of this class member will always have the range [0, 4].
     *** This member is also used to determine how many swap cards to draw on the battle screen.
@@ -18,6 +18,8 @@
 #include "common/global/actors/global_attack_point.h"
 #include "common/global/global_skills.h"
 
+#include "engine/frame_allocator.h"
+
 #include "utils/utils_random.h"
 
 using namespace vt_common;
@@ -823,7 +825,7 @@ void BattleActor::_LoadAIScript()
 void BattleActor::_DecideAction()
 {
     const std::vector<GlobalSkill *>& actor_skills = _global_actor->GetSkills();
-    std::vector<GlobalSkill *> usable_skills;
+    vt_system::FrameVector<GlobalSkill *> usable_skills;
     std::vector<GlobalSkill*>::const_iterator skill_it = actor_skills.begin();
     while(skill_it != actor_skills.end()) {
         if((*skill_it)->IsExecutableInBattle() && (*skill_it)->GetSPRequired() <= GetSkillPoints())
@@ -843,8 +845,8 @@ void BattleActor::_DecideAction()
     std::deque<BattleActor *>& characters = IsEnemy() ? BM->GetEnemyParty() : BM->GetCharacterParty();
     std::deque<BattleActor *>& enemies = IsEnemy() ? BM->GetCharacterParty() : BM->GetEnemyParty();
 
-    std::deque<BattleActor *> alive_characters;
-    std::deque<BattleActor *> dead_characters;
+    vt_system::FrameDeque<BattleActor *> alive_characters;
+    vt_system::FrameDeque<BattleActor *> dead_characters;
     std::deque<BattleActor *>::const_iterator it = characters.begin();
     while(it != characters.end()) {
         if((*it)->IsAlive())
@@ -859,7 +861,7 @@ void BattleActor::_DecideAction()
     }
 
     // and the enemies depending on their state
-    std::deque<BattleActor *> alive_enemies;
+    vt_system::FrameDeque<BattleActor *> alive_enemies;
     it = enemies.begin();
     while(it != enemies.end()) {
         if((*it)->IsAlive())
@@ -17,6 +17,7 @@
 #include "modes/map/map_event_supervisor.h"
 
 #include "common/global/global.h"
+#include "engine/audio/audio.h"
 #include "engine/input.h"
 
 namespace vt_map
@@ -40,6 +41,9 @@ MapDialogueSupervisor::MapDialogueSupervisor() :
 
 MapDialogueSupervisor::~MapDialogueSupervisor()
 {
+    if(_current_dialogue != nullptr)
+        vt_audio::AudioManager->UnduckMusic();
+
     _current_dialogue = nullptr;
     _current_options = nullptr;
 
@@ -115,6 +119,9 @@ void MapDialogueSupervisor::StartDialogue(const std::string& dialogue_id)
         PRINT_WARNING << "beginning a new dialogue while another dialogue is still active" << std::endl;
     }
 
+    // Lower the music while the dialogue is read.
+    vt_audio::AudioManager->DuckMusic();
+
     _line_counter = 0;
     _current_dialogue = dialogue;
     _emote_triggered = false;
@@ -157,6 +164,7 @@ void MapDialogueSupervisor::EndDialogue()
     }
 
     map_mode->PopState();
+    vt_audio::AudioManager->UnduckMusic();
 
     std::string event_id = _current_dialogue->GetEventAtDialogueEnd();
     if (!event_id.empty()) {
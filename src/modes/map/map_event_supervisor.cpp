@@ -415,7 +415,7 @@ void EventSupervisor::EndAllEvents(VirtualSprite *sprite)
 void EventSupervisor::Update()
 {
     // Store the events that became active in the delayed event loop.
-    std::vector<MapEvent *> events_to_start;
+    vt_system::FrameVector<MapEvent *> events_to_start;
 
     // Update all launch event timers and start all events whose timers have finished
     for(std::vector<std::pair<int32_t, MapEvent *> >::iterator it = _active_delayed_events.begin();
@@ -435,11 +435,11 @@ void EventSupervisor::Update()
     }
 
     // Starts the events that became active.
-    for(std::vector<MapEvent *>::iterator it = events_to_start.begin(); it != events_to_start.end(); ++it)
+    for(vt_system::FrameVector<MapEvent *>::iterator it = events_to_start.begin(); it != events_to_start.end(); ++it)
         StartEvent(*it);
 
     // Store the events that ended within the update loop.
-    std::vector<MapEvent *> finished_events;
+    vt_system::FrameVector<MapEvent *> finished_events;
 
     // Make the engine aware that the event supervisor is entering the event update loop
     _is_updating = true;
@@ -461,7 +461,7 @@ void EventSupervisor::Update()
 
     // We examine the event links only after the events has been removed from the active list
     // and the active list has finished parsing, to avoid a crash when adding a new event within the update loop.
-    for(std::vector<MapEvent *>::iterator it = finished_events.begin(); it != finished_events.end(); ++it) {
+    for(vt_system::FrameVector<MapEvent *>::iterator it = finished_events.begin(); it != finished_events.end(); ++it) {
         _ExamineEventLinks(*it, false);
     }
 }
@@ -44,6 +44,7 @@
 
 #include "common/global/global.h"
 #include "common/global/actors/global_character.h"
+#include "common/script_cache.h"
 
 // DEPRECATED: Used only to check old filenames
 #include "utils/utils_files.h"
@@ -163,6 +164,7 @@ MapMode::MapMode(const std::string& data_filename, const std::string& script_fil
 
     // Init the camera position text style
     _debug_camera_position.SetStyle(TextStyle("title22", Color::white, VIDEO_TEXT_SHADOW_DARK));
+    _debug_path_cache.SetStyle(TextStyle("title22", Color::white, VIDEO_TEXT_SHADOW_DARK));
 
     if (_auto_save_enabled && permit_autosave) {
         GlobalManager->AutoSave(_map_data_filename, _map_script_filename, _run_stamina,
@@ -298,7 +300,7 @@ void MapMode::_ResetMusicState()
 {
     // Reload desired music in case it was removed from the cache.
     AudioManager->LoadMusic(_music_filename);
-    MusicDescriptor* music = AudioManager->RetrieveMusic(_music_filename);
+    MusicDescriptor* music = AudioManager->RetrieveMusic(_music_filename, this);
     MusicDescriptor* active_music = AudioManager->GetActiveMusic();
 
     // Stop the current music if it's not the right one.
@@ -436,6 +438,16 @@ void MapMode::Update()
     std::ostringstream coord_txt;
     coord_txt << "Camera position: " << x_pos << ", " << y_pos;
     _debug_camera_position.SetText(coord_txt.str());
+
+    // Path cache statistics
+    uint32_t hits = _object_supervisor->GetPathCacheHits();
+    uint32_t requests = hits + _object_supervisor->GetPathCacheMisses();
+    std::ostringstream path_cache_txt;
+    path_cache_txt << "Path cache: " << _object_supervisor->GetNumberCachedPaths() << " paths, "
+                   << hits << "/" << requests << " hits";
+    if(requests > 0)
+        path_cache_txt << " (" << (hits * 100 / requests) << "%)";
+    _debug_path_cache.SetText(path_cache_txt.str());
 }
 
 void MapMode::Draw()
@@ -463,6 +475,17 @@ void MapMode::DrawPostEffects()
     // as post-effects but before the GUI.
     _object_supervisor->DrawLights();
 
+    //
+    // TODO: #435 Draw the composited, native resolution map
+    //       onto the primary render target with the appropriate
+    //       scale factor and offsets.
+    //
+    //       Currently, the secondary render target is treated
+    //       identically to a full screen quad.
+    //
+
+    VideoManager->DrawSecondaryRenderTarget();
+
     GetScriptSupervisor().DrawPostEffects();
 
     // Draw the gui, unaffected by potential fading effects.
@@ -666,7 +689,7 @@ bool MapMode::_Load()
     }
 
     // Open map script file and read in the basic map properties and tile definitions
-    if(!_map_script.OpenFile(_map_data_filename)) {
+    if(!_map_script.OpenFile(vt_common::GetPrecompiledScript(_map_data_filename))) {
         PRINT_ERROR << "Couldn't open map data file: "
                     << _map_data_filename << std::endl;
         return false;
@@ -711,7 +734,7 @@ bool MapMode::_Load()
     ScriptManager->DropGlobalTable(_map_script_tablespace);
 
     // Open map script file and read in the basic map properties and tile definitions
-    if(!_map_script.OpenFile(_map_script_filename)) {
+    if(!_map_script.OpenFile(vt_common::GetPrecompiledScript(_map_script_filename))) {
         PRINT_ERROR << "Couldn't open map script file: "
                     << _map_script_filename << std::endl;
         return false;
@@ -776,6 +799,9 @@ bool MapMode::_Load()
         return false;
     }
 
+    // The zones and static objects are now known.
+    _object_supervisor->ComputeZonesSpawnCells();
+
     _update_function = _map_script.ReadFunctionPointer("Update");
 
     // If the "home map" flag is set, let's save the map as new home in case of escape.
@@ -1223,20 +1249,11 @@ void MapMode::_DrawMapLayers()
         _DrawDebugGrid();
     }
 
-    VideoManager->DisableSecondaryRenderTarget();
-
     VideoManager->PopState();
 
-    //
-    // TODO: #435 Draw the composited, native resolution map
-    //       onto the primary render target with the appropriate
-    //       scale factor and offsets.
-    //
-    //       Currently, the secondary render target is treated
-    //       identically to a full screen quad.
-    //
-
-    VideoManager->DrawSecondaryRenderTarget();
+    // The secondary render target stays enabled, so that the foreground, the effect
+    // overlays and the lights are drawn at the render scale as well.
+    // It is composited in DrawPostEffects(), before the GUI.
 }
 
 void MapMode::_DrawStaminaBar(const vt_video::Color &blending)
@@ -1349,6 +1366,8 @@ void MapMode::_DrawGUI()
     VideoManager->SetDrawFlags(VIDEO_X_LEFT, VIDEO_Y_CENTER, VIDEO_BLEND, 0);
     VideoManager->Move(10.0f, 10.0f);
     _debug_camera_position.Draw();
+    VideoManager->MoveRelative(0.0f, 30.0f);
+    _debug_path_cache.Draw();
     VideoManager->PopState();
 }
 
@@ -547,6 +547,9 @@ private:
     //! \brief the camera position debug text
     vt_video::TextImage _debug_camera_position;
 
+    //! \brief the path cache statistics debug text
+    vt_video::TextImage _debug_path_cache;
+
     //! \brief The direction the camera will move on next update
     vt_common::Position2D _camera_move;
 
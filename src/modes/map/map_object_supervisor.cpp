@@ -25,8 +25,13 @@
 #include "common/global/global.h"
 #include "common/global/actors/global_character.h"
 
+#include "engine/frame_allocator.h"
+
 #include "utils/utils_numeric.h"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace vt_common;
 
 namespace vt_map
@@ -35,11 +40,60 @@ namespace vt_map
 namespace private_map
 {
 
+//! \brief The side length of the ambient sounds spatial index cells, in map grid units.
+const float AMBIENT_SOUND_CELL_SIZE = 16.0f;
+
+//! \brief The minimal time between two ambient sounds evaluations while the camera moves, in milliseconds.
+const int32_t AMBIENT_SOUND_UPDATE_TIME = 100;
+
+//! \brief The time between two ambient sounds evaluations while the camera doesn't move, in milliseconds.
+const int32_t AMBIENT_SOUND_IDLE_UPDATE_TIME = 500;
+
+//! \brief Used for sound objects without sound descriptor.
+const uint32_t NO_AMBIENT_SOUND_SLOT = 0xFFFFFFFF;
+
+//! \brief The maximum number of path nodes kept in the path cache, before it is cleared.
+const uint32_t PATH_CACHE_MAX_NODES = 16384;
+
+//! \brief The number of nodes at both ends of the cached paths found again around the other sprites.
+const uint32_t PATH_SPRITE_AVOIDANCE_NODES = 16;
+
+//! \brief The distance of the cells not reached by the flow field.
+const uint16_t FLOW_FIELD_UNREACHED = 0xFFFF;
+
+//! \brief The number of cells computed beyond the enemies aggro range,
+//! so that they can go around the obstacles close to its border.
+const int32_t FLOW_FIELD_MARGIN = 4;
+
+//! \brief The distance around the screen within which objects are updated every frame, in map grid units.
+const float ACTIVITY_MARGIN = 8.0f;
+
+//! \brief The distance around the screen within which objects are updated at a reduced rate.
+const float REDUCED_ACTIVITY_MARGIN = 32.0f;
+
+//! \brief Objects at reduced activity are updated once every that many frames.
+const uint32_t REDUCED_ACTIVITY_PERIOD = 4;
+
 ObjectSupervisor::ObjectSupervisor() :
     _num_grid_x_axis(0),
     _num_grid_y_axis(0),
     _last_id(1), //! Every object Id must be > 0 since 0 is reserved for speakerless dialogues.
-    _visible_party_member(nullptr)
+    _visible_party_member(nullptr),
+    _ambient_sound_cells_x(0),
+    _ambient_sound_cells_y(0),
+    _ambient_sound_cells_width(0),
+    _ambient_sound_cells_height(0),
+    _ambient_sound_update_time(0),
+    _ambient_sound_index_dirty(false),
+    _ambient_sounds_refresh(false),
+    _flow_field_root_x(-1),
+    _flow_field_root_y(-1),
+    _flow_field_version(0),
+    _static_collision_version(0),
+    _path_cache_valid_version(0),
+    _path_cache_hits(0),
+    _path_cache_misses(0),
+    _activity_frame(0)
 {}
 
 ObjectSupervisor::~ObjectSupervisor()
@@ -91,6 +145,10 @@ void ObjectSupervisor::RegisterObject(MapObject* object)
         _all_objects.resize(obj_id + 1, nullptr);
     _all_objects[obj_id] = object;
 
+    // Physical objects and treasures added while the map is running block the cached paths.
+    if(GetCollisionFromObjectType(object) == WALL_COLLISION)
+        NotifyStaticCollisionChange(object->GetGridCollisionRectangle());
+
     switch(object->GetObjectDrawLayer()) {
     case FLATGROUND_OBJECT:
         _flat_ground_objects.push_back(object);
@@ -118,6 +176,7 @@ void ObjectSupervisor::AddAmbientSound(SoundObject* object)
     }
 
     _sound_objects.push_back(object);
+    _ambient_sound_index_dirty = true;
 }
 
 void ObjectSupervisor::AddLight(Light* light)
@@ -184,6 +243,9 @@ void ObjectSupervisor::DeleteObject(MapObject* object)
         }
     }
 
+    if(GetCollisionFromObjectType(object) == WALL_COLLISION)
+        NotifyStaticCollisionChange(object->GetGridCollisionRectangle());
+
     std::vector<MapObject*>::iterator it;
     std::vector<MapObject*>::iterator it_end;
     std::vector<MapObject*>* to_iterate = nullptr;
@@ -224,12 +286,34 @@ void ObjectSupervisor::DeleteObject(MapObject* object)
     delete object;
 }
 
+/** \brief Sorts the objects of a draw layer in draw order.
+*** The layers stay sorted from one frame to the next and only the moving objects
+*** may be out of place, so an insertion sort does it in about linear time.
+*** It is also stable, which keeps objects at the same height from flickering.
+**/
+static void SortDrawLayer(std::vector<MapObject*>& objects)
+{
+    MapObject_Ptr_Less less;
+    for(uint32_t i = 1; i < objects.size(); ++i) {
+        MapObject* object = objects[i];
+        if(!less(object, objects[i - 1]))
+            continue;
+
+        uint32_t j = i;
+        do {
+            objects[j] = objects[j - 1];
+            --j;
+        } while(j > 0 && less(object, objects[j - 1]));
+        objects[j] = object;
+    }
+}
+
 void ObjectSupervisor::SortObjects()
 {
-    std::sort(_flat_ground_objects.begin(), _flat_ground_objects.end(), MapObject_Ptr_Less());
-    std::sort(_ground_objects.begin(), _ground_objects.end(), MapObject_Ptr_Less());
-    std::sort(_pass_objects.begin(), _pass_objects.end(), MapObject_Ptr_Less());
-    std::sort(_sky_objects.begin(), _sky_objects.end(), MapObject_Ptr_Less());
+    SortDrawLayer(_flat_ground_objects);
+    SortDrawLayer(_ground_objects);
+    SortDrawLayer(_pass_objects);
+    SortDrawLayer(_sky_objects);
 }
 
 bool ObjectSupervisor::Load(vt_script::ReadScriptDescriptor &map_file)
@@ -251,30 +335,112 @@ bool ObjectSupervisor::Load(vt_script::ReadScriptDescriptor &map_file)
     return true;
 }
 
+void ObjectSupervisor::NotifyStaticCollisionChange(const Rectangle2D& area)
+{
+    ++_static_collision_version;
+
+    for(uint32_t i = 0; i < _zones.size(); ++i)
+        _zones[i]->UpdateWalkableCells(area);
+
+    // The path graph is only updated around the changes, unless there are too many of them.
+    if(!_path_graph.IsBuilt())
+        return;
+    if(_path_graph_dirty_areas.size() < PATH_GRAPH_MAX_DIRTY_AREAS) {
+        _path_graph_dirty_areas.push_back(area);
+    }
+    else {
+        _path_graph.Clear();
+        _path_graph_dirty_areas.clear();
+    }
+}
+
+void ObjectSupervisor::ComputeZonesSpawnCells()
+{
+    for(uint32_t i = 0; i < _zones.size(); ++i)
+        _zones[i]->ComputeSpawnCells();
+}
+
 void ObjectSupervisor::Update()
 {
+    // Done first, so that the enemies can read it during their update.
+    _UpdateFlowField();
+    _UpdateActivityRegions();
+
     for(uint32_t i = 0; i < _flat_ground_objects.size(); ++i)
-        _flat_ground_objects[i]->Update();
+        _UpdateObject(_flat_ground_objects[i], i);
     for(uint32_t i = 0; i < _ground_objects.size(); ++i)
-        _ground_objects[i]->Update();
+        _UpdateObject(_ground_objects[i], i);
 
     // Update map points animation and activeness.
     _UpdateMapPoints();
 
     for(uint32_t i = 0; i < _pass_objects.size(); ++i)
-        _pass_objects[i]->Update();
+        _UpdateObject(_pass_objects[i], i);
     for(uint32_t i = 0; i < _sky_objects.size(); ++i)
-        _sky_objects[i]->Update();
+        _UpdateObject(_sky_objects[i], i);
     for(uint32_t i = 0; i < _halos.size(); ++i)
-        _halos[i]->Update();
+        _UpdateObject(_halos[i], i);
     for(uint32_t i = 0; i < _lights.size(); ++i)
-        _lights[i]->Update();
-    for(uint32_t i = 0; i < _zones.size(); ++i)
-        _zones[i]->Update();
+        _UpdateObject(_lights[i], i);
+
+    // Zones are only updated at full rate, as the camera zones must see the camera
+    // entering and exiting them.
+    for(uint32_t i = 0; i < _zones.size(); ++i) {
+        MapZone* zone = _zones[i];
+        if(!zone->CanSleep() || zone->IntersectsWith(_reduced_activity_region))
+            zone->Update();
+    }
 
     _UpdateAmbientSounds();
 }
 
+void ObjectSupervisor::_UpdateActivityRegions()
+{
+    ++_activity_frame;
+
+    const Rectangle2D& screen_edges = MapMode::CurrentInstance()->GetMapFrame().screen_edges;
+    _activity_region = Rectangle2D(screen_edges.left - ACTIVITY_MARGIN,
+                                   screen_edges.right + ACTIVITY_MARGIN,
+                                   screen_edges.top - ACTIVITY_MARGIN,
+                                   screen_edges.bottom + ACTIVITY_MARGIN);
+    _reduced_activity_region = Rectangle2D(screen_edges.left - REDUCED_ACTIVITY_MARGIN,
+                                           screen_edges.right + REDUCED_ACTIVITY_MARGIN,
+                                           screen_edges.top - REDUCED_ACTIVITY_MARGIN,
+                                           screen_edges.bottom + REDUCED_ACTIVITY_MARGIN);
+}
+
+void ObjectSupervisor::_UpdateObject(MapObject* object, uint32_t index)
+{
+    const uint32_t frame_time = vt_system::SystemManager->GetUpdateTime();
+
+    // Objects with ongoing work, such as sprites moved by events, are always updated.
+    if(object->CanSleep()) {
+        const Rectangle2D image_rect = object->GetGridImageRectangle();
+        if(!image_rect.IntersectsWith(_reduced_activity_region)) {
+            // Sleeping objects are frozen, and don't catch up when waking up.
+            object->SetSkippedUpdateTime(0);
+            return;
+        }
+        if(!image_rect.IntersectsWith(_activity_region)
+                && (_activity_frame + index) % REDUCED_ACTIVITY_PERIOD != 0) {
+            object->SetSkippedUpdateTime(object->GetSkippedUpdateTime() + frame_time);
+            return;
+        }
+    }
+
+    const uint32_t skipped_time = object->GetSkippedUpdateTime();
+    if(skipped_time == 0) {
+        object->Update();
+        return;
+    }
+
+    // The objects read the frame time themselves, so it is extended by the time they missed.
+    object->SetSkippedUpdateTime(0);
+    vt_system::SystemManager->SetUpdateTime(frame_time + skipped_time);
+    object->Update();
+    vt_system::SystemManager->SetUpdateTime(frame_time);
+}
+
 void ObjectSupervisor::DrawMapPoints()
 {
     for(uint32_t i = 0; i < _save_points.size(); ++i) {
@@ -384,40 +550,163 @@ void ObjectSupervisor::_UpdateMapPoints()
     }
 }
 
-void ObjectSupervisor::_UpdateAmbientSounds()
+void ObjectSupervisor::_BuildAmbientSoundIndex()
 {
-    // Clear up objects volumes before new update
-    _sound_object_highest_volumes.clear();
-
-    for(std::vector<SoundObject *>::iterator it = _sound_objects.begin();
-            it != _sound_objects.end(); ++it) {
-        (*it)->UpdateVolume();
-
-        // Register the sound as highest if no other sound was already as high.
-        bool found = false;
-        for(auto it2 = _sound_object_highest_volumes.begin();
-                it2 != _sound_object_highest_volumes.end(); ++it2) {
-            if ((*it)->GetSoundDescriptor() == (*it2)->GetSoundDescriptor()) {
-                found = true;
-                // If we found a higher sound, we swap the reference.
-                if ((*it)->GetSoundVolume() > (*it2)->GetSoundVolume())
-                    *it2 = *it;
+    _ambient_sound_index_dirty = false;
+
+    // Give one volume slot to each distinct sound descriptor.
+    _ambient_sound_slots.clear();
+    _sound_object_slots.assign(_sound_objects.size(), NO_AMBIENT_SOUND_SLOT);
+    for(uint32_t i = 0; i < _sound_objects.size(); ++i) {
+        vt_audio::SoundDescriptor* sound = _sound_objects[i]->GetSoundDescriptor();
+        if(!sound)
+            continue;
+
+        for(uint32_t j = 0; j < _ambient_sound_slots.size(); ++j) {
+            if(_ambient_sound_slots[j].sound == sound) {
+                _sound_object_slots[i] = j;
+                break;
+            }
+        }
+        if(_sound_object_slots[i] == NO_AMBIENT_SOUND_SLOT) {
+            _sound_object_slots[i] = _ambient_sound_slots.size();
+            AmbientSoundSlot slot;
+            slot.sound = sound;
+            slot.volume = 0.0f;
+            _ambient_sound_slots.push_back(slot);
+        }
+    }
+
+    // Compute the cells covering every audible area: left, top, right and bottom cells.
+    std::vector<int32_t> areas(_sound_objects.size() * 4, 0);
+    bool first_area = true;
+    int32_t min_x = 0, min_y = 0, max_x = -1, max_y = -1;
+    for(uint32_t i = 0; i < _sound_objects.size(); ++i) {
+        if(_sound_object_slots[i] == NO_AMBIENT_SOUND_SLOT)
+            continue;
+
+        const Position2D& position = _sound_objects[i]->GetPosition();
+        float strength = _sound_objects[i]->GetStrength();
+        int32_t* area = &areas[i * 4];
+        area[0] = static_cast<int32_t>(std::floor((position.x - strength) / AMBIENT_SOUND_CELL_SIZE));
+        area[1] = static_cast<int32_t>(std::floor((position.y - strength) / AMBIENT_SOUND_CELL_SIZE));
+        area[2] = static_cast<int32_t>(std::floor((position.x + strength) / AMBIENT_SOUND_CELL_SIZE));
+        area[3] = static_cast<int32_t>(std::floor((position.y + strength) / AMBIENT_SOUND_CELL_SIZE));
+        if(first_area) {
+            min_x = area[0];
+            min_y = area[1];
+            max_x = area[2];
+            max_y = area[3];
+            first_area = false;
+            continue;
+        }
+        min_x = std::min(min_x, area[0]);
+        min_y = std::min(min_y, area[1]);
+        max_x = std::max(max_x, area[2]);
+        max_y = std::max(max_y, area[3]);
+    }
+
+    _ambient_sound_cells_x = min_x;
+    _ambient_sound_cells_y = min_y;
+    _ambient_sound_cells_width = max_x - min_x + 1;
+    _ambient_sound_cells_height = max_y - min_y + 1;
+    _ambient_sound_cells.clear();
+    _ambient_sound_cells.resize(_ambient_sound_cells_width * _ambient_sound_cells_height);
+
+    // Register each sound object in the cells its audible area overlaps.
+    for(uint32_t i = 0; i < _sound_objects.size(); ++i) {
+        if(_sound_object_slots[i] == NO_AMBIENT_SOUND_SLOT)
+            continue;
+
+        const int32_t* area = &areas[i * 4];
+        for(int32_t y = area[1]; y <= area[3]; ++y) {
+            for(int32_t x = area[0]; x <= area[2]; ++x) {
+                uint32_t cell = (y - min_y) * _ambient_sound_cells_width + (x - min_x);
+                _ambient_sound_cells[cell].push_back(i);
             }
         }
-        if (!found) {
-            // If the sounds wasn't found, we add it.
-            _sound_object_highest_volumes.push_back(*it);
+    }
+
+    _audible_sound_objects.clear();
+    _ambient_sounds_refresh = true;
+}
+
+void ObjectSupervisor::_UpdateAmbientSounds()
+{
+    if(_ambient_sound_index_dirty)
+        _BuildAmbientSoundIndex();
+
+    if(_ambient_sound_slots.empty())
+        return;
+
+    MapMode *map_mode = MapMode::CurrentInstance();
+    const MapFrame& frame = map_mode->GetMapFrame();
+    Position2D listener(frame.screen_edges.left + (frame.screen_edges.right - frame.screen_edges.left) / 2.0f,
+                        frame.screen_edges.top + (frame.screen_edges.bottom - frame.screen_edges.top) / 2.0f);
+
+    // Evaluate the sound objects volumes at a reduced rate, and even less often
+    // when the camera doesn't move.
+    _ambient_sound_update_time += static_cast<int32_t>(vt_system::SystemManager->GetUpdateTime());
+    bool listener_moved = (listener.x != _ambient_sound_listener.x || listener.y != _ambient_sound_listener.y);
+    if(_ambient_sounds_refresh
+            || (listener_moved && _ambient_sound_update_time >= AMBIENT_SOUND_UPDATE_TIME)
+            || _ambient_sound_update_time >= AMBIENT_SOUND_IDLE_UPDATE_TIME) {
+        _ambient_sounds_refresh = false;
+        _ambient_sound_update_time = 0;
+        _ambient_sound_listener = listener;
+
+        for(uint32_t i = 0; i < _ambient_sound_slots.size(); ++i)
+            _ambient_sound_slots[i].volume = 0.0f;
+
+        // The sounds heard previously are evaluated again so they can be turned down,
+        // along with the ones whose audible area overlaps the listener cell.
+        std::vector<uint32_t> candidates;
+        candidates.swap(_audible_sound_objects);
+        int32_t cell_x = static_cast<int32_t>(std::floor(listener.x / AMBIENT_SOUND_CELL_SIZE)) - _ambient_sound_cells_x;
+        int32_t cell_y = static_cast<int32_t>(std::floor(listener.y / AMBIENT_SOUND_CELL_SIZE)) - _ambient_sound_cells_y;
+        if(cell_x >= 0 && cell_x < _ambient_sound_cells_width && cell_y >= 0 && cell_y < _ambient_sound_cells_height) {
+            const std::vector<uint32_t>& cell = _ambient_sound_cells[cell_y * _ambient_sound_cells_width + cell_x];
+            candidates.insert(candidates.end(), cell.begin(), cell.end());
+        }
+
+        // Keep the highest volume of each sound descriptor in a single pass.
+        for(uint32_t i = 0; i < candidates.size(); ++i) {
+            SoundObject* sound_object = _sound_objects[candidates[i]];
+            sound_object->UpdateVolume(listener);
+
+            float volume = sound_object->GetSoundVolume();
+            if(volume <= 0.0f)
+                continue;
+
+            AmbientSoundSlot& slot = _ambient_sound_slots[_sound_object_slots[candidates[i]]];
+            if(volume > slot.volume)
+                slot.volume = volume;
+            _audible_sound_objects.push_back(candidates[i]);
         }
+
+        // Remove the duplicates coming from both the previous sounds and the cell.
+        std::sort(_audible_sound_objects.begin(), _audible_sound_objects.end());
+        _audible_sound_objects.erase(std::unique(_audible_sound_objects.begin(), _audible_sound_objects.end()),
+                                     _audible_sound_objects.end());
     }
 
-    //PRINT_DEBUG << "Number of ambient sounds: " << _sound_objects.size() << std::endl;
-    //PRINT_DEBUG << "Number of selected ambient sounds: " << _sound_object_highest_volumes.size() << std::endl;
+    // Set the volumes of the sound descriptors.
+    // The volume is applied every frame to override the fade in effect volume.
+    for(uint32_t i = 0; i < _ambient_sound_slots.size(); ++i) {
+        vt_audio::SoundDescriptor* sound = _ambient_sound_slots[i].sound;
+        vt_audio::AUDIO_STATE state = sound->GetState();
+        bool playing = (state == vt_audio::AUDIO_STATE_PLAYING || state == vt_audio::AUDIO_STATE_FADE_IN);
+
+        // Stop sound if needed.
+        if(_ambient_sound_slots[i].volume <= 0.1f) {
+            if(playing)
+                sound->FadeOut(1000.0f);
+            continue;
+        }
 
-    // Set the volumes of the elected sounds
-    // Since we share sound descriptor instances, all sounds are updated in any case.
-    for(auto it = _sound_object_highest_volumes.begin();
-            it != _sound_object_highest_volumes.end(); ++it) {
-        (*it)->ApplyVolume();
+        if(!playing)
+            sound->FadeIn(1000.0f);
+        sound->SetVolume(_ambient_sound_slots[i].volume);
     }
 }
 
@@ -497,7 +786,7 @@ MapObject *ObjectSupervisor::FindNearestInteractionObject(const VirtualSprite *s
     // Go through all objects and determine which (if any) lie within the search area
 
     // A vector to hold objects which are inside the search area (either partially or fully)
-    std::vector<MapObject *> valid_objects;
+    vt_system::FrameVector<MapObject *> valid_objects;
     // A pointer to the vector of objects to search
     std::vector<MapObject *>* search_vector = &_GetObjectsFromDrawLayer(sprite->GetObjectDrawLayer());
 
@@ -677,7 +966,235 @@ COLLISION_TYPE ObjectSupervisor::DetectCollision(MapObject* object,
     return NO_COLLISION;
 }
 
+COLLISION_TYPE ObjectSupervisor::DetectSpriteCollision(MapObject* object, float x_pos, float y_pos)
+{
+    if(!object || object->GetCollisionMask() == NO_COLLISION)
+        return NO_COLLISION;
+
+    Rectangle2D sprite_rect = object->GetGridCollisionRectangle(x_pos, y_pos);
+
+    std::vector<MapObject *>& objects = _GetObjectsFromDrawLayer(object->GetObjectDrawLayer());
+    for(uint32_t i = 0; i < objects.size(); ++i) {
+        MapObject *collision_object = objects[i];
+        if(!collision_object || collision_object == object
+                || collision_object->GetCollisionMask() == NO_COLLISION)
+            continue;
+
+        // Only check the sprites the object would collide with.
+        COLLISION_TYPE collision = GetCollisionFromObjectType(collision_object);
+        if(collision != CHARACTER_COLLISION && collision != ENEMY_COLLISION)
+            continue;
+        if(!(object->GetCollisionMask() & collision))
+            continue;
+
+        if(CheckObjectCollision(sprite_rect, collision_object))
+            return collision;
+    }
+
+    return NO_COLLISION;
+}
+
+bool ObjectSupervisor::PathCacheKey::operator<(const PathCacheKey& other) const
+{
+    if(start_x != other.start_x)
+        return start_x < other.start_x;
+    if(start_y != other.start_y)
+        return start_y < other.start_y;
+    if(destination.x != other.destination.x)
+        return destination.x < other.destination.x;
+    if(destination.y != other.destination.y)
+        return destination.y < other.destination.y;
+    if(coll_half_width != other.coll_half_width)
+        return coll_half_width < other.coll_half_width;
+    if(coll_height != other.coll_height)
+        return coll_height < other.coll_height;
+    if(collision_mask != other.collision_mask)
+        return collision_mask < other.collision_mask;
+    return draw_layer < other.draw_layer;
+}
+
 Path ObjectSupervisor::FindPath(VirtualSprite *sprite, const Position2D& destination, uint32_t max_cost)
+{
+    if(!sprite) {
+        IF_PRINT_WARNING(MAP_DEBUG) << "nullptr sprite passed into function argument" << std::endl;
+        return Path();
+    }
+
+    // Bounded paths are short, and depend on the other sprites positions.
+    if(max_cost > 0)
+        return _ComputePath(sprite, sprite->GetPosition(), destination, max_cost, true);
+
+    if(_path_cache_valid_version != _static_collision_version) {
+        _path_cache.clear();
+        _path_cache_nodes.clear();
+        _path_cache_valid_version = _static_collision_version;
+    }
+
+    PathCacheKey key;
+    key.start_x = static_cast<int16_t>(sprite->GetXPosition());
+    key.start_y = static_cast<int16_t>(sprite->GetYPosition());
+    key.destination = destination;
+    key.coll_half_width = sprite->GetCollGridHalfWidth();
+    key.coll_height = sprite->GetCollGridHeight();
+    key.collision_mask = sprite->GetCollisionMask();
+    key.draw_layer = sprite->GetObjectDrawLayer();
+
+    float offset_x = vt_utils::GetFloatFraction(destination.x);
+    float offset_y = vt_utils::GetFloatFraction(destination.y);
+
+    std::map<PathCacheKey, PathCacheEntry>::const_iterator it = _path_cache.find(key);
+    if(it != _path_cache.end()) {
+        ++_path_cache_hits;
+
+        Path path;
+        path.reserve(it->second.node_count + 1);
+        for(uint32_t i = 0; i < it->second.node_count; ++i) {
+            uint32_t node = it->second.first_node + i * 2;
+            path.push_back(Position2D(((float)_path_cache_nodes[node]) + offset_x,
+                                      ((float)_path_cache_nodes[node + 1]) + offset_y));
+        }
+        path.push_back(destination);
+        return _AvoidSpritesAtPathEnds(sprite, destination, path);
+    }
+
+    ++_path_cache_misses;
+    Path path = _ComputeHierarchicalPath(sprite, destination);
+
+    // Unbounded searches only fail on script errors, which aren't retried.
+    if(path.empty())
+        return path;
+
+    // Start over when the cache is full.
+    uint32_t node_count = path.size() - 1;
+    if(_path_cache_nodes.size() + node_count * 2 > PATH_CACHE_MAX_NODES * 2) {
+        _path_cache.clear();
+        _path_cache_nodes.clear();
+    }
+
+    PathCacheEntry entry;
+    entry.first_node = _path_cache_nodes.size();
+    entry.node_count = node_count;
+    for(uint32_t i = 0; i < node_count; ++i) {
+        _path_cache_nodes.push_back(static_cast<int16_t>(std::floor(path[i].x - offset_x + 0.5f)));
+        _path_cache_nodes.push_back(static_cast<int16_t>(std::floor(path[i].y - offset_y + 0.5f)));
+    }
+    _path_cache.insert(std::make_pair(key, entry));
+
+    return _AvoidSpritesAtPathEnds(sprite, destination, path);
+}
+
+Path ObjectSupervisor::_AvoidSpritesAtPathEnds(VirtualSprite *sprite, const Position2D& destination,
+                                               const Path& skeleton)
+{
+    const Position2D source = sprite->GetPosition();
+
+    // Short paths are found again as a whole.
+    if(skeleton.size() <= PATH_SPRITE_AVOIDANCE_NODES * 2) {
+        Path path = _ComputePath(sprite, source, destination, 0, true);
+        return path.empty() ? skeleton : path;
+    }
+
+    // Allow the ends to go around a few sprites, as they cost three times more.
+    const uint32_t max_cost = PATH_SPRITE_AVOIDANCE_NODES * 4;
+    const uint32_t head_end = PATH_SPRITE_AVOIDANCE_NODES - 1;
+    const uint32_t tail_start = skeleton.size() - 1 - PATH_SPRITE_AVOIDANCE_NODES;
+
+    Path path = _ComputePath(sprite, source, skeleton[head_end], max_cost, true);
+    if(path.empty())
+        path.assign(skeleton.begin(), skeleton.begin() + head_end + 1);
+
+    path.insert(path.end(), skeleton.begin() + head_end + 1, skeleton.begin() + tail_start + 1);
+
+    Path tail = _ComputePath(sprite, skeleton[tail_start], destination, max_cost, true);
+    if(tail.empty())
+        path.insert(path.end(), skeleton.begin() + tail_start + 1, skeleton.end());
+    else
+        path.insert(path.end(), tail.begin(), tail.end());
+
+    return path;
+}
+
+Path ObjectSupervisor::_ComputeHierarchicalPath(VirtualSprite *sprite, const Position2D& destination)
+{
+    const Position2D source = sprite->GetPosition();
+    int32_t start_x = static_cast<int32_t>(source.x);
+    int32_t start_y = static_cast<int32_t>(source.y);
+    int32_t goal_x = static_cast<int32_t>(destination.x);
+    int32_t goal_y = static_cast<int32_t>(destination.y);
+
+    // Short paths are found directly.
+    if(sprite->GetObjectDrawLayer() == SKY_OBJECT
+            || !IsWithinMapBounds(source.x, source.y) || !IsWithinMapBounds(destination.x, destination.y)
+            || _path_graph.AreClustersNeighbours(start_x, start_y, goal_x, goal_y)) {
+        return _ComputePath(sprite, source, destination, 0, false);
+    }
+
+    // The graph depends on the static collisions: only the clusters they changed in are rebuilt.
+    if(!_path_graph.IsBuilt() || !_path_graph_dirty_areas.empty()) {
+        std::vector<Rectangle2D> obstacles;
+        for(uint32_t i = 0; i < _ground_objects.size(); ++i) {
+            MapObject* object = _ground_objects[i];
+            if(GetCollisionFromObjectType(object) == WALL_COLLISION && object->GetCollisionMask() != NO_COLLISION)
+                obstacles.push_back(object->GetGridCollisionRectangle());
+        }
+        if(_path_graph.IsBuilt())
+            _path_graph.Update(_collision_grid, obstacles, _path_graph_dirty_areas);
+        else
+            _path_graph.Build(_collision_grid, obstacles);
+        _path_graph_dirty_areas.clear();
+    }
+
+    std::vector<int32_t> waypoints;
+    std::vector<uint32_t> costs;
+    if(!_path_graph.FindWaypoints(start_x, start_y, goal_x, goal_y, waypoints, costs))
+        return _ComputePath(sprite, source, destination, 0, false);
+
+    // Refine the path between each waypoint, keeping the destination offset.
+    float offset_x = vt_utils::GetFloatFraction(destination.x);
+    float offset_y = vt_utils::GetFloatFraction(destination.y);
+
+    Path path;
+    Position2D segment_start = source;
+    uint32_t previous_cost = 0;
+    for(uint32_t i = 0; i < costs.size(); ++i) {
+        bool last = (i + 1 == costs.size());
+        Position2D segment_end = last ? destination
+                                 : Position2D(static_cast<float>(waypoints[i * 2]) + offset_x,
+                                              static_cast<float>(waypoints[i * 2 + 1]) + offset_y);
+
+        // A waypoint in the cell the segment starts from has nothing to refine.
+        if(static_cast<int32_t>(segment_start.x) == static_cast<int32_t>(segment_end.x)
+                && static_cast<int32_t>(segment_start.y) == static_cast<int32_t>(segment_end.y)) {
+            if(last)
+                path.push_back(destination);
+            else
+                segment_start = segment_end;
+            previous_cost = costs[i];
+            continue;
+        }
+
+        // Leave some slack, as the graph doesn't use the actual sprite collision area.
+        uint32_t segment_max_cost = (costs[i] - previous_cost) * 2 / 10 + PATH_GRAPH_CLUSTER_SIZE;
+        Path segment = _ComputePath(sprite, segment_start, segment_end, segment_max_cost, false);
+        if(segment.empty())
+            segment = _ComputePath(sprite, segment_start, segment_end, 0, false);
+        if(segment.empty()) {
+            IF_PRINT_DEBUG(MAP_DEBUG) << "Couldn't reach a path graph waypoint, "
+                                      << "falling back to a full search." << std::endl;
+            return _ComputePath(sprite, source, destination, 0, false);
+        }
+
+        path.insert(path.end(), segment.begin(), segment.end());
+        segment_start = segment_end;
+        previous_cost = costs[i];
+    }
+
+    return path;
+}
+
+Path ObjectSupervisor::_ComputePath(VirtualSprite *sprite, const Position2D& source,
+                                    const Position2D& destination, uint32_t max_cost,
+                                    bool avoid_sprites)
 {
     // NOTE: Refer to the implementation of the A* algorithm to understand
     // what all these lists and score values are for.
@@ -687,7 +1204,7 @@ Path ObjectSupervisor::FindPath(VirtualSprite *sprite, const Position2D& destina
     // but we still use integer positions for path finding.
     Path path;
 
-    if(!MapMode::CurrentInstance()->GetObjectSupervisor()->IsWithinMapBounds(sprite)) {
+    if(!IsWithinMapBounds(source.x, source.y)) {
         IF_PRINT_WARNING(MAP_DEBUG) << "Sprite position is invalid" << std::endl;
         return path;
     }
@@ -702,7 +1219,7 @@ Path ObjectSupervisor::FindPath(VirtualSprite *sprite, const Position2D& destina
     }
 
     // The starting node of this path discovery
-    PathNode source_node(static_cast<int16_t>(sprite->GetXPosition()), static_cast<int16_t>(sprite->GetYPosition()));
+    PathNode source_node(static_cast<int16_t>(source.x), static_cast<int16_t>(source.y));
     // The ending node.
     PathNode dest(static_cast<int16_t>(destination.x), static_cast<int16_t>(destination.y));
 
@@ -713,8 +1230,9 @@ Path ObjectSupervisor::FindPath(VirtualSprite *sprite, const Position2D& destina
         return path;
     }
 
-    std::vector<PathNode> open_list;
-    std::vector<PathNode> closed_list;
+    // Those lists are temporary and can grow big, so they use the frame memory.
+    vt_system::FrameVector<PathNode> open_list;
+    vt_system::FrameVector<PathNode> closed_list;
 
     // The current "best node"
     PathNode best_node;
@@ -783,8 +1301,8 @@ Path ObjectSupervisor::FindPath(VirtualSprite *sprite, const Position2D& destina
             // Add some g cost when there is another sprite there,
             // so the NPC try to get around when possible,
             // but will still go through it when there are no other choices.
-            if(collision_type == CHARACTER_COLLISION
-                    || collision_type == ENEMY_COLLISION)
+            if(avoid_sprites && (collision_type == CHARACTER_COLLISION
+                                 || collision_type == ENEMY_COLLISION))
                 g_add += basic_gcost * 2;
 
             // If the path has reached the maximum length requested, we abort the path
@@ -801,7 +1319,7 @@ Path ObjectSupervisor::FindPath(VirtualSprite *sprite, const Position2D& destina
             nodes[i].g_score = best_node.g_score + g_add;
 
             // ---------- (D): Check to see if the node is already on the open list and update it if necessary
-            std::vector<PathNode>::iterator iter = std::find(open_list.begin(), open_list.end(), nodes[i]);
+            vt_system::FrameVector<PathNode>::iterator iter = std::find(open_list.begin(), open_list.end(), nodes[i]);
             if(iter != open_list.end()) {
                 // If its G is higher, it means that the path we are on is better, so switch the parent
                 if(iter->g_score > nodes[i].g_score) {
@@ -841,7 +1359,7 @@ Path ObjectSupervisor::FindPath(VirtualSprite *sprite, const Position2D& destina
     closed_list.pop_back();
 
     // Go backwards through the closed list following the parent nodes to construct the path
-    for(std::vector<PathNode>::iterator iter = closed_list.end() - 1; iter != closed_list.begin(); --iter) {
+    for(vt_system::FrameVector<PathNode>::iterator iter = closed_list.end() - 1; iter != closed_list.begin(); --iter) {
         if(iter->tile_y == parent_y && iter->tile_x == parent_x) {
             Position2D next_pos(((float)iter->tile_x) + offset_x, ((float)iter->tile_y) + offset_y);
             path.push_back(next_pos);
@@ -855,6 +1373,202 @@ Path ObjectSupervisor::FindPath(VirtualSprite *sprite, const Position2D& destina
     return path;
 }
 
+uint16_t ObjectSupervisor::GetFlowFieldDirection(float x, float y) const
+{
+    if(_flow_field_directions.empty() || !IsWithinMapBounds(x, y))
+        return 0;
+
+    uint32_t index = static_cast<uint32_t>(y) * _num_grid_x_axis + static_cast<uint32_t>(x);
+    return _flow_field_directions[index];
+}
+
+void ObjectSupervisor::_UpdateFlowField()
+{
+    VirtualSprite* camera = MapMode::CurrentInstance()->GetCamera();
+    if(!camera || !IsWithinMapBounds(camera))
+        return;
+
+    // Rebuild when the camera changed of cell, or when a static obstacle moved.
+    int32_t root_x = static_cast<int32_t>(camera->GetXPosition());
+    int32_t root_y = static_cast<int32_t>(camera->GetYPosition());
+    if(root_x == _flow_field_root_x && root_y == _flow_field_root_y
+            && _flow_field_version == _static_collision_version)
+        return;
+
+    // Only cover the area where enemies can spot the camera.
+    float aggro_range = 0.0f;
+    for(uint32_t i = 0; i < _ground_objects.size(); ++i) {
+        if(_ground_objects[i]->GetObjectType() != ENEMY_TYPE)
+            continue;
+        EnemySprite* enemy = static_cast<EnemySprite*>(_ground_objects[i]);
+        aggro_range = std::max(aggro_range, enemy->GetAggroRange());
+    }
+
+    // No enemy can spot the camera anymore: don't leave them a stale field.
+    if(aggro_range <= 0.0f) {
+        _ClearFlowField();
+        _flow_field_root_x = root_x;
+        _flow_field_root_y = root_y;
+        _flow_field_version = _static_collision_version;
+        return;
+    }
+
+    // Enemies further than a screen away aren't updated.
+    int32_t radius = static_cast<int32_t>(std::ceil(aggro_range)) + FLOW_FIELD_MARGIN;
+    radius = std::min(radius, static_cast<int32_t>(SCREEN_GRID_X_LENGTH));
+
+    _BuildFlowField(root_x, root_y, radius);
+}
+
+void ObjectSupervisor::_ClearFlowField()
+{
+    // Reset the cells reached by the previous computation only.
+    for(uint32_t i = 0; i < _flow_field_cells.size(); ++i) {
+        _flow_field_distances[_flow_field_cells[i]] = FLOW_FIELD_UNREACHED;
+        _flow_field_directions[_flow_field_cells[i]] = 0;
+    }
+    _flow_field_cells.clear();
+    _flow_field_root_x = -1;
+    _flow_field_root_y = -1;
+}
+
+void ObjectSupervisor::_BuildFlowField(int32_t root_x, int32_t root_y, int32_t radius)
+{
+    const uint32_t grid_size = static_cast<uint32_t>(_num_grid_x_axis) * _num_grid_y_axis;
+    if(_flow_field_distances.size() != grid_size) {
+        _flow_field_distances.assign(grid_size, FLOW_FIELD_UNREACHED);
+        _flow_field_directions.assign(grid_size, 0);
+        _flow_field_cells.clear();
+    }
+
+    _ClearFlowField();
+    _flow_field_root_x = root_x;
+    _flow_field_root_y = root_y;
+    _flow_field_version = _static_collision_version;
+
+    const int32_t min_x = std::max(root_x - radius, 0);
+    const int32_t max_x = std::min(root_x + radius, static_cast<int32_t>(_num_grid_x_axis) - 1);
+    const int32_t min_y = std::max(root_y - radius, 0);
+    const int32_t max_y = std::min(root_y + radius, static_cast<int32_t>(_num_grid_y_axis) - 1);
+
+    // The field is computed for the largest enemy, so that none of them is led into a wall.
+    float half_width = 0.0f;
+    float height = 0.0f;
+    for(uint32_t i = 0; i < _ground_objects.size(); ++i) {
+        if(_ground_objects[i]->GetObjectType() != ENEMY_TYPE)
+            continue;
+        half_width = std::max(half_width, _ground_objects[i]->GetCollGridHalfWidth());
+        height = std::max(height, _ground_objects[i]->GetCollGridHeight());
+    }
+
+    // Gather the static objects of the covered area once.
+    Rectangle2D area(static_cast<float>(min_x) - half_width, static_cast<float>(max_x + 1) + half_width,
+                     static_cast<float>(min_y) - height, static_cast<float>(max_y + 1));
+    std::vector<Rectangle2D> static_rects;
+    for(uint32_t i = 0; i < _ground_objects.size(); ++i) {
+        MapObject* object = _ground_objects[i];
+        if(object->GetObjectType() != PHYSICAL_TYPE || object->GetCollisionMask() == NO_COLLISION)
+            continue;
+        Rectangle2D rect = object->GetGridCollisionRectangle();
+        if(rect.IntersectsWith(area))
+            static_rects.push_back(rect);
+    }
+
+    // Tells whether an enemy standing in the middle of the cell doesn't collide.
+    const uint32_t width = _num_grid_x_axis;
+    std::vector<uint8_t> walkable((max_x - min_x + 1) * (max_y - min_y + 1), 0);
+    for(int32_t y = min_y; y <= max_y; ++y) {
+        for(int32_t x = min_x; x <= max_x; ++x) {
+            Rectangle2D rect(static_cast<float>(x) + 0.5f - half_width, static_cast<float>(x) + 0.5f + half_width,
+                             static_cast<float>(y) + 0.5f - height, static_cast<float>(y) + 0.5f);
+            if(rect.left < 0.0f || rect.right >= static_cast<float>(_num_grid_x_axis) ||
+                    rect.top < 0.0f || rect.bottom >= static_cast<float>(_num_grid_y_axis))
+                continue;
+
+            bool collision = false;
+            for(uint32_t ry = static_cast<uint32_t>(rect.top); !collision && ry <= static_cast<uint32_t>(rect.bottom); ++ry) {
+                for(uint32_t rx = static_cast<uint32_t>(rect.left); rx <= static_cast<uint32_t>(rect.right); ++rx) {
+                    if(_collision_grid[ry][rx] > 0) {
+                        collision = true;
+                        break;
+                    }
+                }
+            }
+            for(uint32_t i = 0; !collision && i < static_rects.size(); ++i)
+                collision = rect.IntersectsWith(static_rects[i]);
+
+            if(!collision)
+                walkable[(y - min_y) * (max_x - min_x + 1) + (x - min_x)] = 1;
+        }
+    }
+
+    // Breadth-first search from the root cell. The root is always reached,
+    // even when the camera is standing against a wall.
+    const int32_t orthogonal_x[4] = { -1, 1, 0, 0 };
+    const int32_t orthogonal_y[4] = { 0, 0, -1, 1 };
+
+    uint32_t root_index = static_cast<uint32_t>(root_y) * width + static_cast<uint32_t>(root_x);
+    _flow_field_distances[root_index] = 0;
+    _flow_field_cells.push_back(root_index);
+
+    for(uint32_t next = 0; next < _flow_field_cells.size(); ++next) {
+        uint32_t index = _flow_field_cells[next];
+        int32_t x = static_cast<int32_t>(index % width);
+        int32_t y = static_cast<int32_t>(index / width);
+        uint16_t distance = _flow_field_distances[index];
+
+        for(uint32_t i = 0; i < 4; ++i) {
+            int32_t nx = x + orthogonal_x[i];
+            int32_t ny = y + orthogonal_y[i];
+            if(nx < min_x || nx > max_x || ny < min_y || ny > max_y)
+                continue;
+            if(!walkable[(ny - min_y) * (max_x - min_x + 1) + (nx - min_x)])
+                continue;
+
+            uint32_t neighbour = static_cast<uint32_t>(ny) * width + static_cast<uint32_t>(nx);
+            if(_flow_field_distances[neighbour] != FLOW_FIELD_UNREACHED)
+                continue;
+
+            _flow_field_distances[neighbour] = distance + 1;
+            _flow_field_cells.push_back(neighbour);
+        }
+    }
+
+    // Store the direction toward the closest neighbour of each reached cell,
+    // only cutting corners when both orthogonal neighbours are reached as well.
+    const int32_t neighbour_x[8] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+    const int32_t neighbour_y[8] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+    const uint16_t neighbour_directions[8] = { NORTH, SOUTH, WEST, EAST,
+                                               MOVING_NORTHWEST, MOVING_NORTHEAST,
+                                               MOVING_SOUTHWEST, MOVING_SOUTHEAST };
+
+    for(uint32_t c = 1; c < _flow_field_cells.size(); ++c) {
+        uint32_t index = _flow_field_cells[c];
+        int32_t x = static_cast<int32_t>(index % width);
+        int32_t y = static_cast<int32_t>(index / width);
+
+        uint16_t best_distance = _flow_field_distances[index];
+        uint16_t best_direction = 0;
+        for(uint32_t i = 0; i < 8; ++i) {
+            int32_t nx = x + neighbour_x[i];
+            int32_t ny = y + neighbour_y[i];
+            if(nx < min_x || nx > max_x || ny < min_y || ny > max_y)
+                continue;
+
+            if(i >= 4 && (_flow_field_distances[y * width + nx] == FLOW_FIELD_UNREACHED
+                          || _flow_field_distances[ny * width + x] == FLOW_FIELD_UNREACHED))
+                continue;
+
+            uint16_t distance = _flow_field_distances[ny * width + nx];
+            if(distance < best_distance) {
+                best_distance = distance;
+                best_direction = neighbour_directions[i];
+            }
+        }
+        _flow_field_directions[index] = best_direction;
+    }
+}
+
 void ObjectSupervisor::ReloadVisiblePartyMember()
 {
     // Don't do anything when there is no visible party member.
@@ -945,8 +1659,8 @@ bool ObjectSupervisor::IsStaticCollision(float x, float y)
 
 void ObjectSupervisor::StopSoundObjects()
 {
-    for (uint32_t i = 0; i < _sound_object_highest_volumes.size(); ++i) {
-        vt_audio::SoundDescriptor* sound = _sound_object_highest_volumes[i]->GetSoundDescriptor();
+    for (uint32_t i = 0; i < _ambient_sound_slots.size(); ++i) {
+        vt_audio::SoundDescriptor* sound = _ambient_sound_slots[i].sound;
         if (sound->GetState() == vt_audio::AUDIO_STATE_PLAYING
                 || sound->GetState() == vt_audio::AUDIO_STATE_FADE_IN) {
             sound->Stop();
@@ -956,8 +1670,8 @@ void ObjectSupervisor::StopSoundObjects()
 
 void ObjectSupervisor::RestartSoundObjects()
 {
-    for (uint32_t i = 0; i < _sound_object_highest_volumes.size(); ++i) {
-        vt_audio::SoundDescriptor* sound = _sound_object_highest_volumes[i]->GetSoundDescriptor();
+    for (uint32_t i = 0; i < _ambient_sound_slots.size(); ++i) {
+        vt_audio::SoundDescriptor* sound = _ambient_sound_slots[i].sound;
         if (sound->GetState() == vt_audio::AUDIO_STATE_STOPPED)
             sound->FadeIn(1000.0f);
     }
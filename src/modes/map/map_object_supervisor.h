@@ -12,9 +12,17 @@
 #define __MAP_OBJECT_SUPERVISOR_HEADER__
 
 #include "modes/map/map_objects/map_object.h"
+#include "modes/map/map_path_graph.h"
 
 #include "script/script_read.h"
 
+#include <map>
+
+namespace vt_audio
+{
+class SoundDescriptor;
+}
+
 namespace vt_map
 {
 
@@ -98,7 +106,10 @@ public:
     // Called by the Mazone constructor.
     void AddZone(MapZone* zone);
 
-    //! \brief Sorts objects on all three layers according to their draw order
+    /** \brief Sorts objects on all three layers according to their draw order
+    *** Only the objects which moved since the last call are displaced, so calling it
+    *** every frame costs about a comparison per object.
+    **/
     void SortObjects();
 
     /** \brief Loads the collision grid data and saved state of all map objects
@@ -185,6 +196,13 @@ public:
     COLLISION_TYPE DetectCollision(MapObject* object, float x, float y,
                                    MapObject **collision_object_ptr = nullptr);
 
+    /** \brief Determines if an object would collide with a sprite at the given position.
+    *** Used for positions already known to be free of collisions with the map and
+    *** the static objects, such as the walkable cells of a map zone.
+    *** \return The type of collision detected, which may include NO_COLLISION
+    **/
+    COLLISION_TYPE DetectSpriteCollision(MapObject* object, float x, float y);
+
     /** \brief Finds a path from a sprite's current position to a destination
     *** \param sprite A pointer of the sprite to find the path for
     *** \param dest The destination coordinates
@@ -198,11 +216,55 @@ public:
     *** which map grid elements are walkable.
     ***
     *** \note If an error is detected or a path could not be found, the function will empty the path vector before returning
+    *** \note The unbounded paths are cached per starting cell, destination, sprite collision area and mask,
+    *** so that patrols and scripted routes don't recompute them. Only their static collisions skeleton
+    *** is cached: its beginning and end are then found again going around the other sprites.
+    *** The paths not found and the ones bounded by max_cost are never cached.
     **/
     Path FindPath(private_map::VirtualSprite *sprite,
                   const vt_common::Position2D& destination,
                   uint32_t max_cost = 0);
 
+    /** \brief Discards the data computed from the static collisions, such as the cached paths.
+    *** \param area The area whose collisions changed, in map grid units.
+    *** Called when a physical object or a treasure was moved or had its collision changed.
+    **/
+    void NotifyStaticCollisionChange(const vt_common::Rectangle2D& area);
+
+    //! \brief Computes where the zones enemies can spawn. Called once the map script is loaded.
+    void ComputeZonesSpawnCells();
+
+    //! \brief Returns a number changing every time a static collision changed.
+    uint32_t GetStaticCollisionVersion() const {
+        return _static_collision_version;
+    }
+
+    //! \brief Path cache statistics, shown in the map debug view.
+    //@{
+    uint32_t GetPathCacheHits() const {
+        return _path_cache_hits;
+    }
+
+    uint32_t GetPathCacheMisses() const {
+        return _path_cache_misses;
+    }
+
+    uint32_t GetNumberCachedPaths() const {
+        return _path_cache.size();
+    }
+    //@}
+
+    /** \brief Gives the direction to take to get closer to the camera sprite.
+    *** \param x, y The current position of the sprite, in map grid units.
+    *** \return The direction read from the flow field, or 0 when the position
+    *** isn't covered by it or is already in the camera cell.
+    ***
+    *** The flow field is computed over the collision grid around the camera,
+    *** for the largest enemy collision area, and is only rebuilt when the camera
+    *** changes of cell. Hostile enemies use it to chase the camera around walls.
+    **/
+    uint16_t GetFlowFieldDirection(float x, float y) const;
+
     /** \brief Tells the object supervisor that the given sprite pointer
     *** is the party member object.
     *** This later permits to refresh the sprite shown based on the battle
@@ -267,16 +329,79 @@ public:
     //! Used when leaving a battle for instance.
     void RestartSoundObjects();
 
+    //! \brief Requests the ambient sounds volumes to be recomputed on next update.
+    //! Used when a sound object is started, stopped or has its maximum volume changed.
+    void RefreshAmbientSounds() {
+        _ambient_sounds_refresh = true;
+    }
+
 private:
+    /** \brief Computes an unbounded path ignoring the other sprites, going through the path graph
+    *** waypoints when the destination is far.
+    *** Each part of the path is then found using _ComputePath(), and a full search is done
+    *** when one of them can't be found with the actual sprite collision area.
+    **/
+    Path _ComputeHierarchicalPath(private_map::VirtualSprite *sprite,
+                                  const vt_common::Position2D& destination);
+
+    /** \brief Finds again the beginning and the end of a path ignoring the other sprites, so that
+    *** they go around the sprites close to the source and the destination.
+    *** The parts that can't be found within a short detour are kept as they were.
+    **/
+    Path _AvoidSpritesAtPathEnds(private_map::VirtualSprite *sprite,
+                                 const vt_common::Position2D& destination,
+                                 const Path& skeleton);
+
+    /** \brief Computes a path from the source position using the A* algorithm. See FindPath().
+    *** \param avoid_sprites Whether the cells occupied by other sprites cost more, so that the
+    *** path goes around them when possible.
+    **/
+    Path _ComputePath(private_map::VirtualSprite *sprite,
+                      const vt_common::Position2D& source,
+                      const vt_common::Position2D& destination,
+                      uint32_t max_cost,
+                      bool avoid_sprites);
+
     //! \brief Returns the nearest map point. Used by FindNearestObject.
     private_map::MapObject* _FindNearestMapPoint(const VirtualSprite* sprite);
 
     //! \brief Updates save points animation and active state.
     void _UpdateMapPoints();
 
-    //! \brief Updates the ambient sounds volume according to the camera distance.
+    /** \brief Updates the ambient sounds volume according to the camera distance.
+    *** Only the sound objects that can be heard from the camera position are evaluated,
+    *** and only when the camera moved or every AMBIENT_SOUND_IDLE_UPDATE_TIME otherwise.
+    **/
     void _UpdateAmbientSounds();
 
+    /** \brief Rebuilds the ambient sounds spatial index and the per-descriptor volume slots.
+    *** Called after sound objects were added, as the sound objects are considered static.
+    **/
+    void _BuildAmbientSoundIndex();
+
+    //! \brief Rebuilds the flow field when the camera changed of cell or a static collision changed.
+    void _UpdateFlowField();
+
+    //! \brief Computes the activity regions around the screen for the current frame.
+    void _UpdateActivityRegions();
+
+    /** \brief Updates an object depending on its distance to the screen.
+    *** Objects close to the screen are updated every frame, the ones a bit further
+    *** are updated at a reduced rate, with the time they missed, and the others sleep
+    *** unless they can't.
+    *** \param index The object index in its container, used to spread the reduced updates.
+    **/
+    void _UpdateObject(MapObject* object, uint32_t index);
+
+    //! \brief Resets the cells reached by the last flow field computation.
+    void _ClearFlowField();
+
+    /** \brief Computes the distance of every cell within the given radius to the root cell,
+    *** and the direction each cell should take to get closer to it.
+    *** Only the cells reached by the previous computation are reset.
+    **/
+    void _BuildFlowField(int32_t root_x, int32_t root_y, int32_t radius);
+
     //! \brief Debug: Draws the map zones in orange
     void _DrawMapZones();
 
@@ -349,10 +474,107 @@ private:
     //! to the distance with the camera.
     std::vector<SoundObject *> _sound_objects;
 
-    //! \brief Vector used to know at what exact volume a sound should be played
+    //! \brief The volume at which a shared sound descriptor should be played.
+    struct AmbientSoundSlot {
+        vt_audio::SoundDescriptor* sound;
+
+        //! \brief The highest volume of the sound objects using the descriptor.
+        float volume;
+    };
+
+    //! \brief Flat array used to know at what exact volume a sound should be played
     //! when there are several instances of the same sound in a MapMode.
     //! They are also used when restarting the MapMode.
-    std::vector<SoundObject*> _sound_object_highest_volumes;
+    std::vector<AmbientSoundSlot> _ambient_sound_slots;
+
+    //! \brief The slot index of each sound object, in the same order as _sound_objects.
+    std::vector<uint32_t> _sound_object_slots;
+
+    /** \brief Spatial index of the ambient sounds, made of square cells of AMBIENT_SOUND_CELL_SIZE.
+    *** Each cell lists the indices of the sound objects whose audible radius overlaps it.
+    **/
+    std::vector<std::vector<uint32_t> > _ambient_sound_cells;
+
+    //! \brief The position of the first cell and the number of cells of the spatial index.
+    int32_t _ambient_sound_cells_x, _ambient_sound_cells_y;
+    int32_t _ambient_sound_cells_width, _ambient_sound_cells_height;
+
+    //! \brief The indices of the sound objects audible at the last evaluation.
+    std::vector<uint32_t> _audible_sound_objects;
+
+    //! \brief The camera position at the last evaluation.
+    vt_common::Position2D _ambient_sound_listener;
+
+    //! \brief The time elapsed since the last evaluation, in milliseconds.
+    int32_t _ambient_sound_update_time;
+
+    //! \brief Set when sound objects were added and the spatial index must be rebuilt.
+    bool _ambient_sound_index_dirty;
+
+    //! \brief Set when the ambient sounds must be evaluated on next update.
+    bool _ambient_sounds_refresh;
+
+    //! \brief The distance of each collision grid cell to the flow field root, stored as [y * width + x].
+    std::vector<uint16_t> _flow_field_distances;
+
+    //! \brief The direction to take from each collision grid cell, or 0 when there is none.
+    std::vector<uint16_t> _flow_field_directions;
+
+    //! \brief The indices of the cells reached by the last flow field computation.
+    std::vector<uint32_t> _flow_field_cells;
+
+    //! \brief The cell the flow field is rooted at, or -1 when it was never computed.
+    int32_t _flow_field_root_x, _flow_field_root_y;
+
+    //! \brief The static collision version the flow field was computed with.
+    uint32_t _flow_field_version;
+
+    //! \brief Identifies the paths that can be reused as is.
+    struct PathCacheKey {
+        int16_t start_x;
+        int16_t start_y;
+        vt_common::Position2D destination;
+        float coll_half_width;
+        float coll_height;
+        uint32_t collision_mask;
+        MapObjectDrawLayer draw_layer;
+
+        bool operator<(const PathCacheKey& other) const;
+    };
+
+    //! \brief A cached path, whose nodes are stored in _path_cache_nodes.
+    struct PathCacheEntry {
+        //! \brief The index of the first node coordinates in _path_cache_nodes.
+        uint32_t first_node;
+
+        //! \brief The number of nodes, not counting the destination.
+        uint32_t node_count;
+    };
+
+    //! \brief The cached paths.
+    std::map<PathCacheKey, PathCacheEntry> _path_cache;
+
+    /** \brief The cell coordinates of the cached paths nodes, stored as x, y pairs.
+    *** The nodes positions are rebuilt using the destination offset within its cell.
+    *** Its storage is reused when the cache is cleared.
+    **/
+    std::vector<int16_t> _path_cache_nodes;
+
+    //! \brief Incremented when a static collision changed, making the cached paths invalid.
+    uint32_t _static_collision_version;
+
+    //! \brief The version the cached paths were computed with.
+    uint32_t _path_cache_valid_version;
+
+    //! \brief The clusters graph used to find long paths.
+    PathGraph _path_graph;
+
+    //! \brief The areas whose static collisions changed since the path graph was last updated.
+    std::vector<vt_common::Rectangle2D> _path_graph_dirty_areas;
+
+    //! \brief The number of paths found in, and missing from the cache.
+    uint32_t _path_cache_hits;
+    uint32_t _path_cache_misses;
 
     //! \brief Containers for all of the map source of light, quite similar as the ground objects container.
     std::vector<Halo *> _halos;
@@ -360,6 +582,13 @@ private:
 
     //! \brief Container for all zones used in this map
     std::vector<MapZone *> _zones;
+
+    //! \brief The regions where objects are updated every frame, and at a reduced rate, in map grid units.
+    vt_common::Rectangle2D _activity_region;
+    vt_common::Rectangle2D _reduced_activity_region;
+
+    //! \brief Counts the updates, to know which objects get their reduced rate update.
+    uint32_t _activity_frame;
 }; // class ObjectSupervisor
 
 } // namespace private_map
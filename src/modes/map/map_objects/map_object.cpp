@@ -41,6 +41,7 @@ MapObject::MapObject(MapObjectDrawLayer layer) :
     _coll_grid_half_width(0.0f),
     _coll_grid_height(0.0f),
     _updatable(true),
+    _skipped_update_time(0),
     _visible(true),
     _collision_mask(ALL_COLLISION),
     _draw_on_second_pass(false),
@@ -239,6 +240,18 @@ void MapObject::DrawInteractionIcon()
     _interaction_icon->Draw(icon_color);
 }
 
+void MapObject::_NotifyStaticCollisionChange(const Rectangle2D& previous_area)
+{
+    MapMode* map_mode = MapMode::CurrentInstance();
+    if (!map_mode || !map_mode->GetObjectSupervisor())
+        return;
+
+    // Both the area left and the one now covered changed.
+    ObjectSupervisor* object_supervisor = map_mode->GetObjectSupervisor();
+    object_supervisor->NotifyStaticCollisionChange(previous_area);
+    object_supervisor->NotifyStaticCollisionChange(GetGridCollisionRectangle());
+}
+
 bool MapObject::IsColliding(float x, float y)
 {
     ObjectSupervisor* obj_sup = MapMode::CurrentInstance()->GetObjectSupervisor();
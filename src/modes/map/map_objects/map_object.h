@@ -113,6 +113,24 @@ public:
     **/
     virtual void Draw() = 0;
 
+    /** \brief Tells whether the object may stop being updated when far from the camera.
+    *** Objects with ongoing work that must progress off-screen, such as an emote
+    *** or an event controlling them, must stay awake.
+    **/
+    virtual bool CanSleep() const {
+        return _emote_animation == nullptr;
+    }
+
+    //! \brief The frame time the object missed while updated at a reduced rate, in milliseconds.
+    //! Managed by the object supervisor, which adds it to the next update time.
+    uint32_t GetSkippedUpdateTime() const {
+        return _skipped_update_time;
+    }
+
+    void SetSkippedUpdateTime(uint32_t time) {
+        _skipped_update_time = time;
+    }
+
     /** \brief Determines if an object should be drawn to the screen.
     *** \return True if the object should be drawn.
     *** \note This function also moves the draw cursor to the proper position if the object should be drawn
@@ -183,16 +201,36 @@ public:
     **/
     //@{
     void SetPosition(float x, float y) {
+        // Sprites move every frame: only static obstacles track their previous area.
+        if(!_IsStaticObstacle()) {
+            _tile_position.x = x;
+            _tile_position.y = y;
+            return;
+        }
+        const vt_common::Rectangle2D previous_area = GetGridCollisionRectangle();
         _tile_position.x = x;
         _tile_position.y = y;
+        _NotifyStaticCollisionChange(previous_area);
     }
 
     void SetXPosition(float x) {
+        if(!_IsStaticObstacle()) {
+            _tile_position.x = x;
+            return;
+        }
+        const vt_common::Rectangle2D previous_area = GetGridCollisionRectangle();
         _tile_position.x = x;
+        _NotifyStaticCollisionChange(previous_area);
     }
 
     void SetYPosition(float y) {
+        if(!_IsStaticObstacle()) {
+            _tile_position.y = y;
+            return;
+        }
+        const vt_common::Rectangle2D previous_area = GetGridCollisionRectangle();
         _tile_position.y = y;
+        _NotifyStaticCollisionChange(previous_area);
     }
 
     //! \brief Set the object image half width (in pixels).
@@ -212,15 +250,23 @@ public:
     }
 
     void SetCollPixelHalfWidth(float collision) {
+        const bool static_obstacle = _IsStaticObstacle();
+        const vt_common::Rectangle2D previous_area = static_obstacle ? GetGridCollisionRectangle() : vt_common::Rectangle2D();
         _coll_pixel_half_width = collision;
         _coll_screen_half_width = collision * MAP_ZOOM_RATIO;
         _coll_grid_half_width = collision / GRID_LENGTH * MAP_ZOOM_RATIO;
+        if(static_obstacle)
+            _NotifyStaticCollisionChange(previous_area);
     }
 
     void SetCollPixelHeight(float collision) {
+        const bool static_obstacle = _IsStaticObstacle();
+        const vt_common::Rectangle2D previous_area = static_obstacle ? GetGridCollisionRectangle() : vt_common::Rectangle2D();
         _coll_pixel_height = collision;
         _coll_screen_height = collision * MAP_ZOOM_RATIO;
         _coll_grid_height = collision / GRID_LENGTH * MAP_ZOOM_RATIO;
+        if(static_obstacle)
+            _NotifyStaticCollisionChange(previous_area);
     }
 
     void SetUpdatable(bool update) {
@@ -233,7 +279,13 @@ public:
 
     // Use a set of COLLISION_TYPE bitmask values
     void SetCollisionMask(uint32_t collision_types) {
+        if(!_IsStaticObstacle()) {
+            _collision_mask = collision_types;
+            return;
+        }
+        const vt_common::Rectangle2D previous_area = GetGridCollisionRectangle();
         _collision_mask = collision_types;
+        _NotifyStaticCollisionChange(previous_area);
     }
 
     void SetDrawOnSecondPass(bool pass) {
@@ -378,6 +430,9 @@ protected:
     //! \brief When false, the Update() function will do nothing (default == true).
     bool _updatable;
 
+    //! \brief The frame time missed while updated at a reduced rate, see GetSkippedUpdateTime().
+    uint32_t _skipped_update_time;
+
     //! \brief When false, the Draw() function will do nothing (default == true).
     bool _visible;
 
@@ -422,6 +477,15 @@ protected:
 
     //! \brief Takes care of drawing the emote animation.
     void _DrawEmote();
+
+    //! \brief Tells whether the object blocks the paths, see _NotifyStaticCollisionChange().
+    bool _IsStaticObstacle() const {
+        return _object_type == PHYSICAL_TYPE || _object_type == TREASURE_TYPE;
+    }
+
+    //! \brief Invalidates the cached paths when a static obstacle collision area changed.
+    //! \param previous_area The object collision rectangle before the change.
+    void _NotifyStaticCollisionChange(const vt_common::Rectangle2D& previous_area);
 }; // class MapObject
 
 
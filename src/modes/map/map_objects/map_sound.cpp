@@ -28,7 +28,6 @@ SoundObject::SoundObject(const std::string& sound_filename, float x, float y, fl
     _strength(strength),
     _sound_volume(0.0f),
     _max_sound_volume(1.0f),
-    _time_remaining(0.0f),
     _activated(true),
     _playing(false)
 {
@@ -37,7 +36,7 @@ SoundObject::SoundObject(const std::string& sound_filename, float x, float y, fl
     // We use the AudioManager to mutualize the sound descriptors instances.
     bool loaded = true;
     loaded = vt_audio::AudioManager->LoadSound(sound_filename, MapMode::CurrentInstance());
-    _sound = vt_audio::AudioManager->RetrieveSound(sound_filename);
+    _sound = vt_audio::AudioManager->RetrieveSound(sound_filename, MapMode::CurrentInstance());
     if (!loaded || _sound == nullptr) {
         PRINT_WARNING << "Couldn't load environmental sound file: "
             << sound_filename << std::endl;
@@ -53,6 +52,7 @@ SoundObject::SoundObject(const std::string& sound_filename, float x, float y, fl
     _collision_mask = NO_COLLISION;
 
     if (_sound) {
+        _sound->SetPriority(vt_audio::AUDIO_PRIORITY_AMBIENT);
         _sound->SetLooping(true);
         _sound->SetVolume(0.0f);
         _sound->Stop();
@@ -78,9 +78,11 @@ void SoundObject::SetMaxVolume(float max_volume)
         _max_sound_volume = 0.0f;
     else if (_max_sound_volume > 1.0f)
         _max_sound_volume = 1.0f;
+
+    MapMode::CurrentInstance()->GetObjectSupervisor()->RefreshAmbientSounds();
 }
 
-void SoundObject::UpdateVolume()
+void SoundObject::UpdateVolume(const Position2D& listener)
 {
     // Don't activate a sound which is too weak to be heard anyway.
     if (_strength < 1.0f || _max_sound_volume <= 0.0f) {
@@ -93,25 +95,9 @@ void SoundObject::UpdateVolume()
         return;
     }
 
-    // Update the volume only every 100ms
-    _time_remaining -= static_cast<int32_t>(vt_system::SystemManager->GetUpdateTime());
-    if (_time_remaining > 0)
-        return;
-    _time_remaining = 100;
-
     // N.B.: The distance between two point formula is:
     // squareroot((x2 - x1)^2+(y2 - y1)^2)
-    MapMode *mm = MapMode::CurrentInstance();
-    if(!mm)
-        return;
-
-    const MapFrame& frame = mm->GetMapFrame();
-
-    Position2D center;
-    center.x = frame.screen_edges.left + (frame.screen_edges.right - frame.screen_edges.left) / 2.0f;
-    center.y = frame.screen_edges.top + (frame.screen_edges.bottom - frame.screen_edges.top) / 2.0f;
-
-    float distance = _tile_position.GetDistance2(center);
+    float distance = _tile_position.GetDistance2(listener);
     //distance = sqrtf(_distance); <-- We don't actually need it as it is slow.
 
     float strength2 = _strength * _strength;
@@ -134,27 +120,6 @@ void SoundObject::UpdateVolume()
     _playing = true;
 }
 
-void SoundObject::ApplyVolume()
-{
-    if (!_sound)
-        return;
-
-    // Stop sound if needed.
-    if (_sound_volume <= 0.1f) {
-        if (_sound->GetState() == vt_audio::AUDIO_STATE_PLAYING
-               || _sound->GetState() == vt_audio::AUDIO_STATE_FADE_IN) {
-           _sound->FadeOut(1000.0f);
-        }
-        return;
-    }
-
-    if (_sound->GetState() != vt_audio::AUDIO_STATE_PLAYING
-            && _sound->GetState() != vt_audio::AUDIO_STATE_FADE_IN) {
-        _sound->FadeIn(1000.0f);
-    }
-    _sound->SetVolume(_sound_volume);
-}
-
 void SoundObject::Stop()
 {
     if (!_activated)
@@ -163,6 +128,8 @@ void SoundObject::Stop()
     if (_sound)
         _sound->FadeOut(1000.0f);
     _activated = false;
+
+    MapMode::CurrentInstance()->GetObjectSupervisor()->RefreshAmbientSounds();
 }
 
 void SoundObject::Start()
@@ -173,7 +140,7 @@ void SoundObject::Start()
     _activated = true;
 
     // Restores the sound state
-    UpdateVolume();
+    MapMode::CurrentInstance()->GetObjectSupervisor()->RefreshAmbientSounds();
 }
 
 } // namespace private_map
@@ -48,10 +48,8 @@ public:
                                float x, float y, float strength);
 
     //! \brief Updates the object's currently desired volume.
-    void UpdateVolume();
-
-    //! \brief Applies the object's currently desired volume.
-    void ApplyVolume();
+    //! \param listener The position the sound is heard from, in map grid units.
+    void UpdateVolume(const vt_common::Position2D& listener);
 
     //! \brief Does nothing
     void Draw() override
@@ -78,6 +76,11 @@ public:
         return _sound;
     }
 
+    //! \brief Gets the maximal distance the sound can be heard within.
+    float GetStrength() const {
+        return _strength;
+    }
+
     //! \brief Gets the current desired sound volume.
     //! Used by the object manager to determine the best volume to play the sound object at.
     float GetSoundVolume() const {
@@ -97,9 +100,6 @@ private:
     //! \brief The maximal strength of the sound object. (0.0f - 1.0f)
     float _max_sound_volume;
 
-    //! \brief The time remaining before next update
-    int32_t _time_remaining;
-
     //! \brief Tells whether the sound is activated.
     bool _activated;
 
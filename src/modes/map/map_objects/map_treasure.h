@@ -85,6 +85,11 @@ public:
     //! \brief Changes the current animation if it has finished looping
     void Update();
 
+    //! \brief Treasures stay awake while opening.
+    bool CanSleep() const override {
+        return !_is_opening && PhysicalObject::CanSleep();
+    }
+
     //! \brief Retrieves a pointer to the MapTreasure object holding the treasure.
     MapTreasureContent* GetTreasure() {
         return _treasure;
@@ -0,0 +1,532 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2012-2016 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See https://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    map_path_graph.cpp
+*** \author  Yohann Ferreira, yohann ferreira orange fr
+*** \brief   Source file for the map hierarchical path finding graph.
+*** ***************************************************************************/
+
+#include "modes/map/map_path_graph.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+
+using namespace vt_common;
+
+namespace vt_map
+{
+
+namespace private_map
+{
+
+//! \brief The cost of a lateral and a diagonal move, as used by the regular path finding.
+const uint32_t PATH_GRAPH_LATERAL_COST = 10;
+const uint32_t PATH_GRAPH_DIAGONAL_COST = 14;
+
+//! \brief Walkable border parts longer than this get an entrance at each end, instead of one in the middle.
+const int32_t PATH_GRAPH_MAX_ENTRANCE_WIDTH = 6;
+
+//! \brief The cost of unreachable cells.
+const uint32_t PATH_GRAPH_UNREACHABLE = 0xFFFFFFFF;
+
+//! \brief The cost of the shortest move between two cells, without obstacles.
+static uint32_t GetOctileDistance(int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    uint32_t dx = static_cast<uint32_t>(std::abs(x1 - x2));
+    uint32_t dy = static_cast<uint32_t>(std::abs(y1 - y2));
+    return PATH_GRAPH_LATERAL_COST * std::max(dx, dy)
+           + (PATH_GRAPH_DIAGONAL_COST - PATH_GRAPH_LATERAL_COST) * std::min(dx, dy);
+}
+
+PathGraph::PathGraph() :
+    _built(false),
+    _width(0),
+    _height(0),
+    _clusters_x(0),
+    _clusters_y(0)
+{
+}
+
+void PathGraph::Clear()
+{
+    _built = false;
+    _walkable.clear();
+    _nodes.clear();
+    _cluster_nodes.clear();
+}
+
+void PathGraph::Build(const std::vector<std::vector<uint32_t> >& collision_grid,
+                      const std::vector<Rectangle2D>& obstacles)
+{
+    Clear();
+
+    if (collision_grid.empty() || collision_grid[0].empty())
+        return;
+
+    _height = static_cast<int32_t>(collision_grid.size());
+    _width = static_cast<int32_t>(collision_grid[0].size());
+    _clusters_x = (_width + PATH_GRAPH_CLUSTER_SIZE - 1) / PATH_GRAPH_CLUSTER_SIZE;
+    _clusters_y = (_height + PATH_GRAPH_CLUSTER_SIZE - 1) / PATH_GRAPH_CLUSTER_SIZE;
+
+    _walkable.assign(_width * _height, 0);
+    _ComputeWalkableCells(collision_grid, obstacles, 0, 0, _width - 1, _height - 1);
+
+    // Add the entrances between each cluster and its right and bottom neighbours.
+    _cluster_nodes.resize(_clusters_x * _clusters_y);
+    for (int32_t cy = 0; cy < _clusters_y; ++cy) {
+        for (int32_t cx = 0; cx < _clusters_x; ++cx) {
+            if (cx + 1 < _clusters_x)
+                _AddBorderEntrances(cx, cy, true);
+            if (cy + 1 < _clusters_y)
+                _AddBorderEntrances(cx, cy, false);
+        }
+    }
+
+    // Link the nodes of each cluster.
+    for (uint32_t c = 0; c < _cluster_nodes.size(); ++c)
+        _LinkClusterNodes(c);
+
+    _built = true;
+}
+
+void PathGraph::Update(const std::vector<std::vector<uint32_t> >& collision_grid,
+                       const std::vector<Rectangle2D>& obstacles,
+                       const std::vector<Rectangle2D>& areas)
+{
+    if (!_built) {
+        Build(collision_grid, obstacles);
+        return;
+    }
+
+    // Recompute the walkable cells of the areas, and find the clusters they touch.
+    std::vector<uint8_t> touched(_cluster_nodes.size(), 0);
+    uint32_t touched_count = 0;
+    for (uint32_t i = 0; i < areas.size(); ++i) {
+        // A free cell also changes whether the cells on its right and below are walkable.
+        int32_t left = std::max(static_cast<int32_t>(areas[i].left), 0);
+        int32_t top = std::max(static_cast<int32_t>(areas[i].top), 0);
+        int32_t right = std::min(static_cast<int32_t>(areas[i].right) + 1, _width - 1);
+        int32_t bottom = std::min(static_cast<int32_t>(areas[i].bottom) + 1, _height - 1);
+        if (left > right || top > bottom)
+            continue;
+
+        _ComputeWalkableCells(collision_grid, obstacles, left, top, right, bottom);
+
+        for (int32_t cy = top / PATH_GRAPH_CLUSTER_SIZE; cy <= bottom / PATH_GRAPH_CLUSTER_SIZE; ++cy) {
+            for (int32_t cx = left / PATH_GRAPH_CLUSTER_SIZE; cx <= right / PATH_GRAPH_CLUSTER_SIZE; ++cx) {
+                uint32_t cluster = cy * _clusters_x + cx;
+                if (!touched[cluster]) {
+                    touched[cluster] = 1;
+                    ++touched_count;
+                }
+            }
+        }
+    }
+
+    if (touched_count == 0)
+        return;
+
+    // The entrances on the borders of the touched clusters are recreated, so the
+    // touched clusters and their neighbours need to be linked again.
+    std::vector<uint8_t> relinked(touched);
+    for (int32_t cy = 0; cy < _clusters_y; ++cy) {
+        for (int32_t cx = 0; cx < _clusters_x; ++cx) {
+            if (!touched[cy * _clusters_x + cx])
+                continue;
+            if (cx > 0)
+                relinked[cy * _clusters_x + cx - 1] = 1;
+            if (cx + 1 < _clusters_x)
+                relinked[cy * _clusters_x + cx + 1] = 1;
+            if (cy > 0)
+                relinked[(cy - 1) * _clusters_x + cx] = 1;
+            if (cy + 1 < _clusters_y)
+                relinked[(cy + 1) * _clusters_x + cx] = 1;
+        }
+    }
+
+    // Remove the entrances on the touched borders, and renumber the other nodes.
+    std::vector<uint32_t> new_ids(_nodes.size(), PATH_GRAPH_UNREACHABLE);
+    std::vector<Node> nodes;
+    nodes.reserve(_nodes.size());
+    for (uint32_t i = 0; i < _nodes.size(); ++i) {
+        const Node& node = _nodes[i];
+        if (touched[node.cluster] || touched[_nodes[node.edges[0].target].cluster])
+            continue;
+        new_ids[i] = nodes.size();
+        nodes.push_back(node);
+    }
+
+    for (uint32_t c = 0; c < _cluster_nodes.size(); ++c)
+        _cluster_nodes[c].clear();
+
+    for (uint32_t i = 0; i < nodes.size(); ++i) {
+        Node& node = nodes[i];
+        // The links within the relinked clusters are computed again below.
+        if (relinked[node.cluster])
+            node.edges.resize(1);
+        for (uint32_t j = 0; j < node.edges.size(); ++j)
+            node.edges[j].target = new_ids[node.edges[j].target];
+        _cluster_nodes[node.cluster].push_back(i);
+    }
+    _nodes.swap(nodes);
+
+    // Recreate the entrances on the borders of the touched clusters.
+    for (int32_t cy = 0; cy < _clusters_y; ++cy) {
+        for (int32_t cx = 0; cx < _clusters_x; ++cx) {
+            uint32_t cluster = cy * _clusters_x + cx;
+            if (cx + 1 < _clusters_x && (touched[cluster] || touched[cluster + 1]))
+                _AddBorderEntrances(cx, cy, true);
+            if (cy + 1 < _clusters_y && (touched[cluster] || touched[cluster + _clusters_x]))
+                _AddBorderEntrances(cx, cy, false);
+        }
+    }
+
+    for (uint32_t c = 0; c < _cluster_nodes.size(); ++c) {
+        if (relinked[c])
+            _LinkClusterNodes(c);
+    }
+}
+
+bool PathGraph::AreClustersNeighbours(int32_t x1, int32_t y1, int32_t x2, int32_t y2) const
+{
+    return std::abs(x1 / PATH_GRAPH_CLUSTER_SIZE - x2 / PATH_GRAPH_CLUSTER_SIZE) <= 1
+           && std::abs(y1 / PATH_GRAPH_CLUSTER_SIZE - y2 / PATH_GRAPH_CLUSTER_SIZE) <= 1;
+}
+
+bool PathGraph::FindWaypoints(int32_t start_x, int32_t start_y, int32_t goal_x, int32_t goal_y,
+                              std::vector<int32_t>& waypoints, std::vector<uint32_t>& costs) const
+{
+    waypoints.clear();
+    costs.clear();
+
+    if (!_built)
+        return false;
+
+    if (start_x < 0 || start_y < 0 || start_x >= _width || start_y >= _height
+            || goal_x < 0 || goal_y < 0 || goal_x >= _width || goal_y >= _height)
+        return false;
+
+    if (!_IsWalkable(start_x, start_y) || !_IsWalkable(goal_x, goal_y))
+        return false;
+
+    const uint32_t start_cluster = _GetCluster(start_x, start_y);
+    const uint32_t goal_cluster = _GetCluster(goal_x, goal_y);
+
+    // The start and goal cells are temporarily added after the entrance nodes.
+    const uint32_t start_id = _nodes.size();
+    const uint32_t goal_id = start_id + 1;
+
+    std::vector<uint32_t> start_costs;
+    std::vector<uint32_t> goal_costs;
+    _ComputeClusterCosts(start_x, start_y, start_costs);
+    _ComputeClusterCosts(goal_x, goal_y, goal_costs);
+
+    std::vector<uint32_t> g_scores(goal_id + 1, PATH_GRAPH_UNREACHABLE);
+    std::vector<uint32_t> parents(goal_id + 1, PATH_GRAPH_UNREACHABLE);
+    std::vector<uint8_t> closed(goal_id + 1, 0);
+
+    typedef std::pair<uint32_t, uint32_t> ScoredNode; // f score, node id
+    std::priority_queue<ScoredNode, std::vector<ScoredNode>, std::greater<ScoredNode> > open_list;
+
+    g_scores[start_id] = 0;
+    open_list.push(ScoredNode(GetOctileDistance(start_x, start_y, goal_x, goal_y), start_id));
+
+    // The goal can be reached straight from the start when they share a cluster.
+    if (start_cluster == goal_cluster) {
+        uint32_t cost = start_costs[_GetIndexInCluster(goal_x, goal_y)];
+        if (cost != PATH_GRAPH_UNREACHABLE) {
+            g_scores[goal_id] = cost;
+            parents[goal_id] = start_id;
+            open_list.push(ScoredNode(cost, goal_id));
+        }
+    }
+
+    while (!open_list.empty()) {
+        uint32_t current = open_list.top().second;
+        open_list.pop();
+
+        if (closed[current])
+            continue;
+        closed[current] = 1;
+
+        if (current == goal_id)
+            break;
+
+        // Gather the neighbours of the current node.
+        std::vector<Edge> edges;
+        uint32_t current_cluster = start_cluster;
+        if (current == start_id) {
+            const std::vector<uint32_t>& cluster_nodes = _cluster_nodes[start_cluster];
+            for (uint32_t i = 0; i < cluster_nodes.size(); ++i) {
+                const Node& node = _nodes[cluster_nodes[i]];
+                Edge edge;
+                edge.target = cluster_nodes[i];
+                edge.cost = start_costs[_GetIndexInCluster(node.x, node.y)];
+                if (edge.cost != PATH_GRAPH_UNREACHABLE)
+                    edges.push_back(edge);
+            }
+        }
+        else {
+            const Node& node = _nodes[current];
+            current_cluster = node.cluster;
+            edges = node.edges;
+
+            if (current_cluster == goal_cluster) {
+                Edge edge;
+                edge.target = goal_id;
+                edge.cost = goal_costs[_GetIndexInCluster(node.x, node.y)];
+                if (edge.cost != PATH_GRAPH_UNREACHABLE)
+                    edges.push_back(edge);
+            }
+        }
+
+        for (uint32_t i = 0; i < edges.size(); ++i) {
+            uint32_t target = edges[i].target;
+            if (closed[target])
+                continue;
+
+            uint32_t g_score = g_scores[current] + edges[i].cost;
+            if (g_score >= g_scores[target])
+                continue;
+
+            g_scores[target] = g_score;
+            parents[target] = current;
+
+            uint32_t h_score = 0;
+            if (target != goal_id)
+                h_score = GetOctileDistance(_nodes[target].x, _nodes[target].y, goal_x, goal_y);
+            open_list.push(ScoredNode(g_score + h_score, target));
+        }
+    }
+
+    if (!closed[goal_id])
+        return false;
+
+    // Go back from the goal to the start.
+    std::vector<uint32_t> path;
+    for (uint32_t node = goal_id; node != start_id; node = parents[node])
+        path.push_back(node);
+    std::reverse(path.begin(), path.end());
+
+    // Only keep the nodes where the path enters a new cluster, and the goal.
+    uint32_t previous_cluster = start_cluster;
+    for (uint32_t i = 0; i < path.size(); ++i) {
+        if (path[i] == goal_id) {
+            waypoints.push_back(goal_x);
+            waypoints.push_back(goal_y);
+            costs.push_back(g_scores[goal_id]);
+            break;
+        }
+
+        const Node& node = _nodes[path[i]];
+        if (node.cluster != previous_cluster) {
+            waypoints.push_back(node.x);
+            waypoints.push_back(node.y);
+            costs.push_back(g_scores[path[i]]);
+        }
+        previous_cluster = node.cluster;
+    }
+
+    return true;
+}
+
+void PathGraph::_ComputeWalkableCells(const std::vector<std::vector<uint32_t> >& collision_grid,
+                                      const std::vector<Rectangle2D>& obstacles,
+                                      int32_t left, int32_t top, int32_t right, int32_t bottom)
+{
+    // Mark the free cells first, including the ones on the left and above the area.
+    const int32_t free_left = std::max(left - 1, 0);
+    const int32_t free_top = std::max(top - 1, 0);
+    const int32_t free_width = right - free_left + 1;
+    const int32_t free_height = bottom - free_top + 1;
+
+    std::vector<uint8_t> free_cells(free_width * free_height, 0);
+    for (int32_t y = 0; y < free_height; ++y) {
+        for (int32_t x = 0; x < free_width; ++x)
+            free_cells[y * free_width + x] = (collision_grid[free_top + y][free_left + x] == 0) ? 1 : 0;
+    }
+    for (uint32_t i = 0; i < obstacles.size(); ++i) {
+        const Rectangle2D& rect = obstacles[i];
+        int32_t obstacle_left = std::max(static_cast<int32_t>(rect.left), free_left);
+        int32_t obstacle_right = std::min(static_cast<int32_t>(rect.right), right);
+        int32_t obstacle_top = std::max(static_cast<int32_t>(rect.top), free_top);
+        int32_t obstacle_bottom = std::min(static_cast<int32_t>(rect.bottom), bottom);
+        for (int32_t y = obstacle_top; y <= obstacle_bottom; ++y) {
+            for (int32_t x = obstacle_left; x <= obstacle_right; ++x)
+                free_cells[(y - free_top) * free_width + x - free_left] = 0;
+        }
+    }
+
+    // A sprite standing in a cell covers the cells on its left and above as well.
+    for (int32_t y = std::max(top, 1); y <= bottom; ++y) {
+        for (int32_t x = std::max(left, 1); x <= right; ++x) {
+            int32_t fx = x - free_left;
+            int32_t fy = y - free_top;
+            _walkable[y * _width + x] = free_cells[fy * free_width + fx]
+                                        & free_cells[fy * free_width + fx - 1]
+                                        & free_cells[(fy - 1) * free_width + fx]
+                                        & free_cells[(fy - 1) * free_width + fx - 1];
+        }
+    }
+}
+
+void PathGraph::_LinkClusterNodes(uint32_t cluster)
+{
+    std::vector<uint32_t> costs;
+    const std::vector<uint32_t>& cluster_nodes = _cluster_nodes[cluster];
+    for (uint32_t i = 0; i < cluster_nodes.size(); ++i) {
+        Node& node = _nodes[cluster_nodes[i]];
+        _ComputeClusterCosts(node.x, node.y, costs);
+
+        for (uint32_t j = 0; j < cluster_nodes.size(); ++j) {
+            if (i == j)
+                continue;
+            const Node& other = _nodes[cluster_nodes[j]];
+            uint32_t cost = costs[_GetIndexInCluster(other.x, other.y)];
+            if (cost == PATH_GRAPH_UNREACHABLE)
+                continue;
+
+            Edge edge;
+            edge.target = cluster_nodes[j];
+            edge.cost = cost;
+            node.edges.push_back(edge);
+        }
+    }
+}
+
+void PathGraph::_AddEntrance(int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    uint32_t first_id = _nodes.size();
+
+    Node first;
+    first.x = x1;
+    first.y = y1;
+    first.cluster = _GetCluster(x1, y1);
+
+    Node second;
+    second.x = x2;
+    second.y = y2;
+    second.cluster = _GetCluster(x2, y2);
+
+    Edge edge;
+    edge.cost = PATH_GRAPH_LATERAL_COST;
+    edge.target = first_id + 1;
+    first.edges.push_back(edge);
+    edge.target = first_id;
+    second.edges.push_back(edge);
+
+    _nodes.push_back(first);
+    _nodes.push_back(second);
+    _cluster_nodes[first.cluster].push_back(first_id);
+    _cluster_nodes[second.cluster].push_back(first_id + 1);
+}
+
+void PathGraph::_AddBorderEntrances(int32_t cluster_x, int32_t cluster_y, bool vertical)
+{
+    // The cells along the border, on the first cluster side.
+    int32_t x = vertical ? (cluster_x + 1) * PATH_GRAPH_CLUSTER_SIZE - 1 : cluster_x * PATH_GRAPH_CLUSTER_SIZE;
+    int32_t y = vertical ? cluster_y * PATH_GRAPH_CLUSTER_SIZE : (cluster_y + 1) * PATH_GRAPH_CLUSTER_SIZE - 1;
+    const int32_t step_x = vertical ? 0 : 1;
+    const int32_t step_y = vertical ? 1 : 0;
+    const int32_t across_x = vertical ? 1 : 0;
+    const int32_t across_y = vertical ? 0 : 1;
+
+    int32_t length = vertical ? std::min(PATH_GRAPH_CLUSTER_SIZE, _height - y)
+                              : std::min(PATH_GRAPH_CLUSTER_SIZE, _width - x);
+
+    int32_t run_start = -1;
+    for (int32_t i = 0; i <= length; ++i) {
+        int32_t cx = x + i * step_x;
+        int32_t cy = y + i * step_y;
+        bool open = (i < length) && _IsWalkable(cx, cy) && _IsWalkable(cx + across_x, cy + across_y);
+
+        if (open) {
+            if (run_start < 0)
+                run_start = i;
+            continue;
+        }
+
+        if (run_start < 0)
+            continue;
+
+        // Close the current walkable part of the border.
+        int32_t run_end = i - 1;
+        if (run_end - run_start + 1 <= PATH_GRAPH_MAX_ENTRANCE_WIDTH) {
+            int32_t middle = (run_start + run_end) / 2;
+            _AddEntrance(x + middle * step_x, y + middle * step_y,
+                         x + middle * step_x + across_x, y + middle * step_y + across_y);
+        }
+        else {
+            _AddEntrance(x + run_start * step_x, y + run_start * step_y,
+                         x + run_start * step_x + across_x, y + run_start * step_y + across_y);
+            _AddEntrance(x + run_end * step_x, y + run_end * step_y,
+                         x + run_end * step_x + across_x, y + run_end * step_y + across_y);
+        }
+        run_start = -1;
+    }
+}
+
+void PathGraph::_ComputeClusterCosts(int32_t x, int32_t y, std::vector<uint32_t>& costs) const
+{
+    costs.assign(PATH_GRAPH_CLUSTER_SIZE * PATH_GRAPH_CLUSTER_SIZE, PATH_GRAPH_UNREACHABLE);
+
+    const int32_t min_x = (x / PATH_GRAPH_CLUSTER_SIZE) * PATH_GRAPH_CLUSTER_SIZE;
+    const int32_t min_y = (y / PATH_GRAPH_CLUSTER_SIZE) * PATH_GRAPH_CLUSTER_SIZE;
+    const int32_t max_x = std::min(min_x + PATH_GRAPH_CLUSTER_SIZE, _width) - 1;
+    const int32_t max_y = std::min(min_y + PATH_GRAPH_CLUSTER_SIZE, _height) - 1;
+
+    const int32_t neighbour_x[8] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+    const int32_t neighbour_y[8] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+
+    typedef std::pair<uint32_t, uint32_t> ScoredCell; // cost, index in cluster
+    std::priority_queue<ScoredCell, std::vector<ScoredCell>, std::greater<ScoredCell> > open_list;
+
+    costs[_GetIndexInCluster(x, y)] = 0;
+    open_list.push(ScoredCell(0, _GetIndexInCluster(x, y)));
+
+    while (!open_list.empty()) {
+        uint32_t cost = open_list.top().first;
+        uint32_t index = open_list.top().second;
+        open_list.pop();
+
+        if (cost > costs[index])
+            continue;
+
+        int32_t cell_x = min_x + static_cast<int32_t>(index % PATH_GRAPH_CLUSTER_SIZE);
+        int32_t cell_y = min_y + static_cast<int32_t>(index / PATH_GRAPH_CLUSTER_SIZE);
+
+        for (uint32_t i = 0; i < 8; ++i) {
+            int32_t nx = cell_x + neighbour_x[i];
+            int32_t ny = cell_y + neighbour_y[i];
+            if (nx < min_x || nx > max_x || ny < min_y || ny > max_y)
+                continue;
+            if (!_IsWalkable(nx, ny))
+                continue;
+
+            // Don't cut corners.
+            if (i >= 4 && (!_IsWalkable(nx, cell_y) || !_IsWalkable(cell_x, ny)))
+                continue;
+
+            uint32_t new_cost = cost + (i < 4 ? PATH_GRAPH_LATERAL_COST : PATH_GRAPH_DIAGONAL_COST);
+            uint32_t new_index = _GetIndexInCluster(nx, ny);
+            if (new_cost >= costs[new_index])
+                continue;
+
+            costs[new_index] = new_cost;
+            open_list.push(ScoredCell(new_cost, new_index));
+        }
+    }
+}
+
+} // namespace private_map
+
+} // namespace vt_map
@@ -0,0 +1,166 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2012-2016 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See https://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    map_path_graph.h
+*** \author  Yohann Ferreira, yohann ferreira orange fr
+*** \brief   Header file for the map hierarchical path finding graph.
+***
+*** The collision grid is split into square clusters. The walkable cells on both
+*** sides of the clusters borders are connected by entrance nodes, and the nodes
+*** of a same cluster are linked by the cost of the shortest path between them
+*** within the cluster. Long paths are first found on this small graph, and then
+*** refined cluster by cluster using the regular path finding.
+*** ***************************************************************************/
+
+#ifndef __MAP_PATH_GRAPH_HEADER__
+#define __MAP_PATH_GRAPH_HEADER__
+
+#include "common/rectangle_2d.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace vt_map
+{
+
+namespace private_map
+{
+
+//! \brief The side length of the path graph clusters, in map grid units.
+const int32_t PATH_GRAPH_CLUSTER_SIZE = 16;
+
+//! \brief The number of static collision changes after which the path graph is rebuilt as a whole.
+const uint32_t PATH_GRAPH_MAX_DIRTY_AREAS = 64;
+
+/** ****************************************************************************
+*** \brief An abstraction of the collision grid used to find long paths.
+***
+*** A cell is considered walkable when the 2x2 cells area ending at it is free,
+*** which approximates the collision area of the usual map sprites. The graph
+*** is thus only a guide: the waypoints it gives must be refined using the
+*** actual sprite collision area.
+*** ***************************************************************************/
+class PathGraph
+{
+public:
+    PathGraph();
+
+    /** \brief Builds the clusters entrances and their costs.
+    *** \param collision_grid The map collision grid, stored as [y][x].
+    *** \param obstacles The collision rectangles of the static objects.
+    **/
+    void Build(const std::vector<std::vector<uint32_t> >& collision_grid,
+               const std::vector<vt_common::Rectangle2D>& obstacles);
+
+    /** \brief Rebuilds the clusters touched by static collision changes.
+    *** \param collision_grid The map collision grid, stored as [y][x].
+    *** \param obstacles The collision rectangles of the static objects, after the changes.
+    *** \param areas The areas where the static collisions changed, in map grid units.
+    ***
+    *** Only the entrances on the borders of the touched clusters are recreated, and only
+    *** the nodes of these clusters and of their neighbours are linked again.
+    **/
+    void Update(const std::vector<std::vector<uint32_t> >& collision_grid,
+                const std::vector<vt_common::Rectangle2D>& obstacles,
+                const std::vector<vt_common::Rectangle2D>& areas);
+
+    //! \brief Frees the graph.
+    void Clear();
+
+    //! \brief Tells whether the graph was built.
+    bool IsBuilt() const {
+        return _built;
+    }
+
+    //! \brief Tells whether both cells are in the same or neighbour clusters.
+    bool AreClustersNeighbours(int32_t x1, int32_t y1, int32_t x2, int32_t y2) const;
+
+    /** \brief Finds the cells a path from start to goal should go through.
+    *** \param waypoints Filled with the cells where the path enters a new cluster,
+    *** ending with the goal cell, as x, y pairs.
+    *** \param costs Filled with the path cost to reach each waypoint from the start,
+    *** using 10 for a lateral move and 14 for a diagonal one.
+    *** \return false if no path exists on the graph.
+    **/
+    bool FindWaypoints(int32_t start_x, int32_t start_y, int32_t goal_x, int32_t goal_y,
+                       std::vector<int32_t>& waypoints, std::vector<uint32_t>& costs) const;
+
+private:
+    //! \brief A link from a node to another.
+    struct Edge {
+        uint32_t target;
+        uint32_t cost;
+    };
+
+    //! \brief An entrance node, on the border of its cluster.
+    //! Its first edge always leads to the node on the other side of the border.
+    struct Node {
+        int32_t x;
+        int32_t y;
+        uint32_t cluster;
+        std::vector<Edge> edges;
+    };
+
+    bool _built;
+
+    //! \brief The collision grid size, and the number of clusters on each axis.
+    int32_t _width, _height;
+    int32_t _clusters_x, _clusters_y;
+
+    //! \brief Whether each cell is walkable, stored as [y * width + x].
+    std::vector<uint8_t> _walkable;
+
+    std::vector<Node> _nodes;
+
+    //! \brief The indices of the nodes of each cluster.
+    std::vector<std::vector<uint32_t> > _cluster_nodes;
+
+    //! \brief Returns the cluster index of a cell.
+    uint32_t _GetCluster(int32_t x, int32_t y) const {
+        return (y / PATH_GRAPH_CLUSTER_SIZE) * _clusters_x + (x / PATH_GRAPH_CLUSTER_SIZE);
+    }
+
+    bool _IsWalkable(int32_t x, int32_t y) const {
+        return _walkable[y * _width + x] != 0;
+    }
+
+    /** \brief Computes whether the cells of an area are walkable.
+    *** \param left, top, right, bottom The area, inclusive, within the collision grid.
+    **/
+    void _ComputeWalkableCells(const std::vector<std::vector<uint32_t> >& collision_grid,
+                               const std::vector<vt_common::Rectangle2D>& obstacles,
+                               int32_t left, int32_t top, int32_t right, int32_t bottom);
+
+    //! \brief Links each node of a cluster to the other nodes of the cluster it can reach.
+    void _LinkClusterNodes(uint32_t cluster);
+
+    //! \brief Adds an entrance between two neighbour cells of different clusters.
+    void _AddEntrance(int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+
+    //! \brief Scans the border between two clusters and adds entrances on its walkable parts.
+    //! \param vertical Whether the border is vertical, i.e. between a cluster and its right neighbour.
+    void _AddBorderEntrances(int32_t cluster_x, int32_t cluster_y, bool vertical);
+
+    /** \brief Computes the cost from a cell to every cell of its cluster.
+    *** \param costs Filled with the costs, indexed in the cluster, or 0xFFFFFFFF when unreachable.
+    **/
+    void _ComputeClusterCosts(int32_t x, int32_t y, std::vector<uint32_t>& costs) const;
+
+    //! \brief Returns the index in the cluster of a cell, as used by _ComputeClusterCosts().
+    uint32_t _GetIndexInCluster(int32_t x, int32_t y) const {
+        return (y % PATH_GRAPH_CLUSTER_SIZE) * PATH_GRAPH_CLUSTER_SIZE + (x % PATH_GRAPH_CLUSTER_SIZE);
+    }
+};
+
+} // namespace private_map
+
+} // namespace vt_map
+
+#endif // __MAP_PATH_GRAPH_HEADER__
@@ -11,6 +11,7 @@
 #include "modes/map/map_sprites/map_enemy_sprite.h"
 
 #include "modes/map/map_mode.h"
+#include "modes/map/map_object_supervisor.h"
 #include "modes/map/map_zones.h"
 
 using namespace vt_common;
@@ -173,8 +174,12 @@ void EnemySprite::_HandleHostileUpdate()
         if (this->IsCollidingWith(camera))
             map_mode->StartEnemyEncounter(this);
 
-        // Make the monster go toward the character
-        if(xdelta > -0.5 && xdelta < 0.5 && ydelta < 0)
+        // Follow the flow field around the obstacles, and go straight
+        // toward the character once close enough.
+        uint16_t direction = map_mode->GetObjectSupervisor()->GetFlowFieldDirection(GetXPosition(), GetYPosition());
+        if(direction != 0)
+            SetDirection(direction);
+        else if(xdelta > -0.5 && xdelta < 0.5 && ydelta < 0)
             SetDirection(SOUTH);
         else if(xdelta > -0.5 && xdelta < 0.5 && ydelta > 0)
             SetDirection(NORTH);
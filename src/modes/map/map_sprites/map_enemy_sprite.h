@@ -76,6 +76,11 @@ public:
     //! \brief Updates the sprite's position and state.
     virtual void Update() override;
 
+    //! \brief Enemies stay awake while fading in.
+    virtual bool CanSleep() const override {
+        return _state != SPAWNING && MapSprite::CanSleep();
+    }
+
     //! \brief Draws the sprite frame in the appropriate position on the screen, if it is visible.
     virtual void Draw() override;
 
@@ -46,6 +46,11 @@ public:
     //! \brief Updates the virtual object's position if it is moving, otherwise does nothing.
     virtual void Update() override;
 
+    //! \brief Sprites stay awake while moving or controlled by an event.
+    virtual bool CanSleep() const override {
+        return !_moving && _control_event == nullptr && MapObject::CanSleep();
+    }
+
     //! \brief Does nothing since virtual sprites have no image to draw
     virtual void Draw() override
     {
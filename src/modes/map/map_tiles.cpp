@@ -72,6 +72,9 @@ bool TileSupervisor::Load(ReadScriptDescriptor &map_file)
     // Temporarily retains all tile images loaded for each tileset. Each inner vector contains 256 StillImage objects
     std::vector<std::vector<StillImage> > tileset_images;
 
+    // The tileset image files used
+    std::vector<std::string> image_filenames;
+
     map_file.ReadStringVector("tileset_filenames", tileset_filenames);
 
     for(uint32_t i = 0; i < tileset_filenames.size(); i++) {
@@ -89,8 +92,15 @@ bool TileSupervisor::Load(ReadScriptDescriptor &map_file)
             return false;
         }
 
-        std::string image_filename = tileset_script.ReadString("image");
+        image_filenames.push_back(tileset_script.ReadString("image"));
         tileset_script.CloseFile();
+    }
+
+    // Decode the tileset images in parallel while they are loaded one by one.
+    VideoManager->PreloadImages(image_filenames);
+
+    for(uint32_t i = 0; i < image_filenames.size(); i++) {
+        const std::string& image_filename = image_filenames[i];
 
         tileset_images.push_back(std::vector<StillImage>(TILES_PER_TILESET));
 
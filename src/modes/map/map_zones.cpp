@@ -21,6 +21,9 @@
 
 #include "utils/utils_random.h"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace vt_utils;
 using namespace vt_common;
 
@@ -35,7 +38,10 @@ namespace private_map
 // -----------------------------------------------------------------------------
 
 MapZone::MapZone(uint16_t left_col, uint16_t right_col, uint16_t top_row, uint16_t bottom_row) :
-    _interaction_icon(nullptr)
+    _interaction_icon(nullptr),
+    _walkable_cells_half_width(0.0f),
+    _walkable_cells_height(0.0f),
+    _walkable_cells_computed(false)
 {
     AddSection(left_col, right_col, top_row, bottom_row);
     // Register to the object supervisor
@@ -70,6 +76,16 @@ void MapZone::AddSection(uint16_t left_col, uint16_t right_col, uint16_t top_row
     }
 
     _sections.push_back(Rectangle2D(left_col, right_col, top_row, bottom_row));
+    _walkable_cells_computed = false;
+}
+
+bool MapZone::IntersectsWith(const vt_common::Rectangle2D& rect) const
+{
+    for(uint32_t i = 0; i < _sections.size(); ++i) {
+        if(_sections[i].IntersectsWith(rect))
+            return true;
+    }
+    return false;
 }
 
 bool MapZone::IsInsideZone(float pos_x, float pos_y) const
@@ -112,6 +128,137 @@ void MapZone::RandomPosition(float& x, float& y)
     y = (float)RandomBoundedInteger(_sections[i].top, _sections[i].bottom);
 }
 
+bool MapZone::RandomWalkablePosition(float coll_half_width, float coll_height, float& x, float& y)
+{
+    // Zones changed or enemies added once the map is loaded get their cells here.
+    if (!_walkable_cells_computed
+            || _walkable_cells_half_width != coll_half_width
+            || _walkable_cells_height != coll_height) {
+        ComputeWalkableCells(coll_half_width, coll_height);
+    }
+
+    if (_walkable_cells.empty())
+        return false;
+
+    uint32_t cell = _walkable_cells[RandomBoundedInteger(0, _walkable_cells.size() - 1)];
+    x = static_cast<float>(cell & 0xFFFF);
+    y = static_cast<float>(cell >> 16);
+    return true;
+}
+
+void MapZone::ComputeWalkableCells(float coll_half_width, float coll_height)
+{
+    _walkable_cells.clear();
+    _walkable_cells_half_width = coll_half_width;
+    _walkable_cells_height = coll_height;
+    _walkable_cells_computed = true;
+
+    if (_sections.empty())
+        return;
+
+    Rectangle2D bounds = _sections[0];
+    for (uint32_t i = 1; i < _sections.size(); ++i) {
+        bounds.left = std::min(bounds.left, _sections[i].left);
+        bounds.right = std::max(bounds.right, _sections[i].right);
+        bounds.top = std::min(bounds.top, _sections[i].top);
+        bounds.bottom = std::max(bounds.bottom, _sections[i].bottom);
+    }
+    _AddWalkableCells(bounds);
+}
+
+void MapZone::UpdateWalkableCells(const Rectangle2D& area)
+{
+    if (!_walkable_cells_computed)
+        return;
+
+    // The cells where an object standing would overlap the changed area.
+    Rectangle2D bounds(std::ceil(area.left - _walkable_cells_half_width),
+                       std::floor(area.right + _walkable_cells_half_width),
+                       std::ceil(area.top), std::floor(area.bottom + _walkable_cells_height));
+    if (bounds.left > bounds.right || bounds.top > bounds.bottom || !IntersectsWith(bounds))
+        return;
+
+    // Remove the cells around the area, which are then checked again.
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < _walkable_cells.size(); ++i) {
+        float x = static_cast<float>(_walkable_cells[i] & 0xFFFF);
+        float y = static_cast<float>(_walkable_cells[i] >> 16);
+        if (x < bounds.left || x > bounds.right || y < bounds.top || y > bounds.bottom)
+            _walkable_cells[kept++] = _walkable_cells[i];
+    }
+    _walkable_cells.resize(kept);
+    _AddWalkableCells(bounds);
+}
+
+void MapZone::_AddWalkableCells(const Rectangle2D& bounds)
+{
+    ObjectSupervisor* object_supervisor = MapMode::CurrentInstance()->GetObjectSupervisor();
+    const float coll_half_width = _walkable_cells_half_width;
+    const float coll_height = _walkable_cells_height;
+
+    // Only check the static objects around the bounds once.
+    Rectangle2D area(bounds.left - coll_half_width, bounds.right + coll_half_width,
+                     bounds.top - coll_height, bounds.bottom);
+    std::vector<Rectangle2D> obstacles;
+    const std::vector<MapObject*>& objects = object_supervisor->GetGroundObjects();
+    for (uint32_t i = 0; i < objects.size(); ++i) {
+        if (object_supervisor->GetCollisionFromObjectType(objects[i]) != WALL_COLLISION
+                || objects[i]->GetCollisionMask() == NO_COLLISION)
+            continue;
+        Rectangle2D rect = objects[i]->GetGridCollisionRectangle();
+        if (rect.IntersectsWith(area))
+            obstacles.push_back(rect);
+    }
+
+    // Sections may overlap, so the cells already checked are marked.
+    int32_t bounds_left = static_cast<int32_t>(bounds.left);
+    int32_t bounds_top = static_cast<int32_t>(bounds.top);
+    uint32_t bounds_width = static_cast<uint32_t>(bounds.right - bounds.left) + 1;
+    uint32_t bounds_height = static_cast<uint32_t>(bounds.bottom - bounds.top) + 1;
+    std::vector<uint8_t> checked(bounds_width * bounds_height, 0);
+
+    uint32_t grid_width = 0;
+    uint32_t grid_height = 0;
+    object_supervisor->GetGridAxis(grid_width, grid_height);
+
+    for (uint32_t i = 0; i < _sections.size(); ++i) {
+        const Rectangle2D& section = _sections[i];
+        int32_t left = std::max(static_cast<int32_t>(section.left), bounds_left);
+        int32_t right = std::min(static_cast<int32_t>(section.right), static_cast<int32_t>(bounds.right));
+        int32_t top = std::max(static_cast<int32_t>(section.top), bounds_top);
+        int32_t bottom = std::min(static_cast<int32_t>(section.bottom), static_cast<int32_t>(bounds.bottom));
+        for (int32_t y = top; y <= bottom; ++y) {
+            for (int32_t x = left; x <= right; ++x) {
+                uint8_t& cell_checked = checked[(y - bounds_top) * bounds_width + (x - bounds_left)];
+                if (cell_checked)
+                    continue;
+                cell_checked = 1;
+
+                // The collision rectangle of an object standing at this position.
+                Rectangle2D rect(x - coll_half_width, x + coll_half_width, y - coll_height, y);
+                if (rect.left < 0.0f || rect.right >= static_cast<float>(grid_width)
+                        || rect.top < 0.0f || rect.bottom >= static_cast<float>(grid_height))
+                    continue;
+
+                bool collision = false;
+                for (uint32_t ry = static_cast<uint32_t>(rect.top); !collision && ry <= static_cast<uint32_t>(rect.bottom); ++ry) {
+                    for (uint32_t rx = static_cast<uint32_t>(rect.left); rx <= static_cast<uint32_t>(rect.right); ++rx) {
+                        if (object_supervisor->IsMapCollision(rx, ry)) {
+                            collision = true;
+                            break;
+                        }
+                    }
+                }
+                for (uint32_t j = 0; !collision && j < obstacles.size(); ++j)
+                    collision = rect.IntersectsWith(obstacles[j]);
+
+                if (!collision)
+                    _walkable_cells.push_back((static_cast<uint32_t>(y) << 16) | static_cast<uint32_t>(x));
+            }
+        }
+    }
+}
+
 void MapZone::SetInteractionIcon(const std::string& animation_filename)
 {
     if (_interaction_icon)
@@ -243,7 +390,9 @@ EnemyZone::EnemyZone(uint16_t left_col, uint16_t right_col,
     _spawns_left(-1), // Infinite spawns permitted.
     _spawn_timer(STANDARD_ENEMY_FIRST_SPAWN_TIME),
     _dead_timer(STANDARD_ENEMY_DEAD_TIME),
-    _spawn_zone(nullptr)
+    _spawn_zone(nullptr),
+    _spawn_coll_half_width(0.0f),
+    _spawn_coll_height(0.0f)
 {
     // Done so that when the zone updates for the first time, an inactive enemy will immediately be selected and begin spawning
     _dead_timer.Finish();
@@ -283,6 +432,10 @@ void EnemyZone::AddEnemy(EnemySprite* enemy, uint8_t enemy_number)
     enemy->SetZone(this);
     _enemies.push_back(enemy);
 
+    // Spawn positions are computed for the largest enemy.
+    _spawn_coll_half_width = std::max(_spawn_coll_half_width, enemy->GetCollGridHalfWidth());
+    _spawn_coll_height = std::max(_spawn_coll_height, enemy->GetCollGridHeight());
+
     // Create any additional copies of the enemy and add them as well
     for (uint8_t i = 1; i < enemy_number; ++i) {
         EnemySprite* copy = new EnemySprite(*enemy);
@@ -329,6 +482,17 @@ void EnemyZone::AddSpawnSection(uint16_t left_col, uint16_t right_col, uint16_t
     }
 }
 
+void EnemyZone::ComputeSpawnCells()
+{
+    if (_enemies.empty())
+        return;
+
+    if (HasSeparateSpawnZone())
+        _spawn_zone->ComputeWalkableCells(_spawn_coll_half_width, _spawn_coll_height);
+    else
+        ComputeWalkableCells(_spawn_coll_half_width, _spawn_coll_height);
+}
+
 void EnemyZone::EnemyDead()
 {
     if(_active_enemies == 0) {
@@ -340,11 +504,10 @@ void EnemyZone::EnemyDead()
 
 void EnemyZone::Update()
 {
-    // When spawning an enemy in a random zone location, sometimes it is occupied by another
-    // object or that section is unwalkable. We try only a few different spawn locations before
-    // giving up and waiting for the next call to Update(). Otherwise this function could
-    // potentially take a noticable amount of time to complete
-    const int8_t SPAWN_RETRIES = 50;
+    // Spawn locations are picked among the zone walkable cells, but they may still be
+    // occupied by another sprite. We try only a few different spawn locations before
+    // giving up and waiting for the next call to Update().
+    const int8_t SPAWN_RETRIES = 8;
 
     // Don't update when the zone is disabled.
     if (!_enabled)
@@ -410,13 +573,14 @@ void EnemyZone::Update()
         spawning_zone = _spawn_zone;
     }
     // If there is a collision, retry a different location
+    ObjectSupervisor* object_supervisor = MapMode::CurrentInstance()->GetObjectSupervisor();
     do {
-        spawning_zone->RandomPosition(x, y);
+        if (!spawning_zone->RandomWalkablePosition(_spawn_coll_half_width, _spawn_coll_height, x, y)) {
+            collision = WALL_COLLISION;
+            break;
+        }
         _enemies[index]->SetPosition(x, y);
-        collision = MapMode::CurrentInstance()->GetObjectSupervisor()->DetectCollision(_enemies[index],
-                    _enemies[index]->GetXPosition(),
-                    _enemies[index]->GetYPosition(),
-                    nullptr);
+        collision = object_supervisor->DetectSpriteCollision(_enemies[index], x, y);
     } while (collision != NO_COLLISION && --retries > 0);
 
     // Otherwise, spawn the enemy and reset the spawn timer
@@ -89,6 +89,14 @@ public:
     **/
     bool IsInsideZone(float pos_x, float pos_y) const;
 
+    //! \brief Returns true if one of the zone sections intersects with the rectangle.
+    bool IntersectsWith(const vt_common::Rectangle2D& rect) const;
+
+    //! \brief Tells whether the zone may stop being updated when far from the camera.
+    virtual bool CanSleep() const {
+        return true;
+    }
+
     //! \brief Draws the map zone on screen for debugging purpose
     virtual void Draw();
 
@@ -98,6 +106,28 @@ public:
     **/
     void RandomPosition(float &x, float &y);
 
+    /** \brief Returns a random cell position within the zone where an object of the given
+    *** collision size doesn't collide with the collision grid or the static objects.
+    *** \param coll_half_width, coll_height The object collision size, in map grid units.
+    *** \param x A reference where to store the value of the x position
+    *** \param y A reference where to store the value of the y position
+    *** \return false if there is no such position in the zone.
+    ***
+    *** The walkable cells are computed when the map is loaded, see ComputeSpawnCells(),
+    *** or on the first call for this collision size.
+    **/
+    bool RandomWalkablePosition(float coll_half_width, float coll_height, float &x, float &y);
+
+    //! \brief Computes the cells of the zone where an object of the given collision size can stand.
+    void ComputeWalkableCells(float coll_half_width, float coll_height);
+
+    //! \brief Checks again the walkable cells around an area whose static collisions changed.
+    void UpdateWalkableCells(const vt_common::Rectangle2D& area);
+
+    //! \brief Computes the cells where the zone enemies can spawn. Called once the map is loaded.
+    virtual void ComputeSpawnCells()
+    {}
+
     //! \brief Loads the current animation file as the new interaction icon of the object.
     void SetInteractionIcon(const std::string& animation_filename);
 
@@ -111,9 +141,20 @@ protected:
     //! \brief Interaction icon
     vt_video::AnimatedImage* _interaction_icon;
 
+    //! \brief The walkable cells of the zone, stored as (y << 16 | x).
+    std::vector<uint32_t> _walkable_cells;
+
+    //! \brief The collision size the walkable cells were computed with.
+    float _walkable_cells_half_width;
+    float _walkable_cells_height;
+    bool _walkable_cells_computed;
+
     //! \brief Tells whether a section is on screen and place the drawing cursor in that case.
     bool _ShouldDraw(const vt_common::Rectangle2D& section);
 
+    //! \brief Adds the walkable cells of the zone found within the bounds.
+    void _AddWalkableCells(const vt_common::Rectangle2D& bounds);
+
 private:
     //
     // The copy constructor and assignment operator are hidden by design
@@ -180,6 +221,12 @@ public:
         return ((_camera_inside == false) && (_was_camera_inside));
     }
 
+    //! \brief The zone stays awake until it saw the camera out of it for two updates,
+    //! so that the entering and exiting states aren't left set while asleep.
+    virtual bool CanSleep() const override {
+        return !_camera_inside && !_was_camera_inside;
+    }
+
 protected:
     //! \brief Set to true when the sprite pointed to by the camera is inside this zone
     bool _camera_inside;
@@ -229,6 +276,11 @@ public:
 
     virtual ~EnemyZone() override;
 
+    //! \brief Enemy zones always run, so that their respawn timers keep going.
+    virtual bool CanSleep() const override {
+        return false;
+    }
+
     //! \brief A C++ wrapper made to create a new object from scripting,
     //! without letting Lua handling the object life-cycle.
     //! \note We don't permit luabind to use constructors here as it can't currently
@@ -266,6 +318,9 @@ public:
     **/
     void AddSpawnSection(uint16_t left_col, uint16_t right_col, uint16_t top_row, uint16_t bottom_row);
 
+    //! \brief Computes the walkable cells of the spawning zone, for the zone largest enemy.
+    virtual void ComputeSpawnCells() override;
+
     //! \brief Decrements the number of active enemies by one
     void EnemyDead();
 
@@ -348,6 +403,10 @@ private:
     //! \brief An optional zone which specifies where enemies may spawn
     MapZone *_spawn_zone;
 
+    //! \brief The largest collision size of the zone enemies, used to find where they can spawn.
+    float _spawn_coll_half_width;
+    float _spawn_coll_height;
+
     /** \brief Contains all of the enemies that may exist in this zone.
     *** \note These sprites will be deleted by the map object manager, not the destructor of this class.
     **/
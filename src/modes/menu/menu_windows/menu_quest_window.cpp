@@ -33,8 +33,12 @@ namespace private_menu
 
 QuestWindow::QuestWindow():
     _location_image(nullptr),
-    _location_subimage(nullptr)
+    _location_subimage(nullptr),
+    _descriptions_shown(false)
 {
+    // The descriptions only change along with the viewed quest.
+    EnableRetainedDrawing(true);
+
     _quest_description.SetPosition(445, 130);
     _quest_description.SetDimensions(455, 200);
     _quest_description.SetDisplayMode(VIDEO_TEXT_INSTANT);
@@ -66,9 +70,20 @@ QuestWindow::QuestWindow():
 
 void QuestWindow::Draw()
 {
-    MenuWindow::Draw();
     Update();
-    if(MenuMode::CurrentInstance()->_quest_list_window.IsActive()) {
+
+    bool descriptions_shown = MenuMode::CurrentInstance()->_quest_list_window.IsActive();
+    if(descriptions_shown != _descriptions_shown) {
+        _descriptions_shown = descriptions_shown;
+        MarkDirty();
+    }
+
+    MenuWindow::Draw();
+}
+
+void QuestWindow::_DrawContents()
+{
+    if(_descriptions_shown) {
         _quest_description.Draw();
         _quest_completion_description.Draw();
     }
@@ -64,9 +64,15 @@ public:
     //! We use this to query the text description
     void SetViewingQuestId(const std::string &quest_id)
     {
+        if(_viewing_quest_id != quest_id)
+            MarkDirty();
         _viewing_quest_id = quest_id;
     }
 
+protected:
+    //! \brief Draws the quest descriptions in the retained window texture.
+    void _DrawContents() override;
+
 private:
     //! \brief the currently viewing quest id. this is set by the Quest List Window through the
     //! SetViewingQuestId() function
@@ -84,6 +90,9 @@ private:
     //! \brief the currently viewing location image and location subimage
     const vt_video::StillImage* _location_image;
     const vt_video::StillImage* _location_subimage;
+
+    //! \brief Whether the quest descriptions were drawn in the retained window texture.
+    bool _descriptions_shown;
 };
 
 } // namespace private_menu